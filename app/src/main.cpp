@@ -1,17 +1,68 @@
 #include <print>
+#include <string>
+#include <string_view>
 
 #include <SDL3/SDL.h>
 
 #include "mirror.h"
 
-int main() {
+// --headless [frames] [--vulkan] [--threaded]: no window, fixed 60 Hz steps as fast as possible, then a frame time
+// summary. With --vulkan frames are also submitted offscreen, on a software driver if there is no GPU; --threaded
+// renders on a separate thread while the next frame is simulated.
+static i32 runHeadless(const u64 frames, const bool vulkan, const bool threaded) {
+	Mirror::Mirror engine{ Mirror::Mirror::Headless{ .vulkan = vulkan } };
+	engine.renderer().setThreaded(threaded);
+
+	Mirror::FrameScheduler scheduler{ .step_sec = 1.0 / 60.0, .fixed_delta_sec = 1.0 / 60.0 };
+	scheduler.clock.stats = &engine.stats();
+
+	for (u64 frame = 0; frame < frames; ++frame) {
+		const u32 steps = scheduler.beginFrame();
+		for (u32 step = 0; step < steps; ++step) engine.update();
+		scheduler.endFrame();
+	}
+	engine.renderer().flush();
+
+	const Mirror::FrameStats::Snapshot snapshot = engine.stats().snapshot();
+	std::println("{} frames, {} steps: mean {:.3f} ms, p50 {:.3f} ms, p99 {:.3f} ms, max {:.3f} ms",
+		engine.frame(), scheduler.steps, snapshot.total.mean_ms, snapshot.total.p50_ms, snapshot.total.p99_ms, snapshot.total.max_ms);
+	const Mirror::Reflect::Renderer::Latency& latency = engine.renderer().latency();
+	std::println("render latency: mean {:.3f} ms, max {:.3f} ms; {} of {} snapshots dropped",
+		latency.meanMs(), latency.max_ms, latency.dropped, latency.published);
+	if (const Mirror::Reflect::Vk::FramesInFlight::Timings* timings = engine.renderer().gpuTimings()) {
+		std::println("{}: CPU submit mean {:.3f} ms, last {:.3f} ms; fence wait mean {:.3f} ms",
+			engine.renderer().context()->deviceName(), timings->meanSubmitMs(), timings->submit_ms, timings->meanWaitMs());
+		const Mirror::Reflect::Vk::MemoryAllocator::Stats memory = engine.renderer().context()->memory().stats();
+		std::println("GPU memory: {:.1f} MB used of {:.1f} MB reserved in {} device allocations, {:.1f}% fragmented",
+			(f64)memory.used / (1 << 20), (f64)memory.reserved / (1 << 20), memory.device_allocations, memory.fragmentation * 100);
+	}
+	return 0;
+}
+
+int main(const int argc, char** argv) {
+	if (argc > 1 && std::string_view{ argv[1] } == "--headless") {
+		u64 frames = 600;
+		bool vulkan = false;
+		bool threaded = false;
+		for (i32 n = 2; n < argc; ++n) {
+			if (std::string_view{ argv[n] } == "--vulkan") vulkan = true;
+			else if (std::string_view{ argv[n] } == "--threaded") threaded = true;
+			else frames = std::stoull(argv[n]);
+		}
+		return runHeadless(frames, vulkan, threaded);
+	}
+
 	if (!SDL_SetAppMetadata("Mirror App", "1.0.0", nullptr)) std::terminate();
 	if (!SDL_Init(SDL_INIT_VIDEO)) std::terminate();
 
 	Mirror::Mirror engine{ { 1920, 1080 }, "Mirror App" };
 
+	Mirror::FrameScheduler scheduler{ .step_sec = 1.0 / 60.0, .target_frame_sec = 1.0 / 144.0 };
+	scheduler.clock.stats = &engine.stats();
+
 	bool running = true;
 	while (running) {
+		const u32 steps = scheduler.beginFrame();
 
 		// Handle input
 		SDL_Event event;
@@ -23,9 +74,9 @@ int main() {
 			}
 		}
 
-		// Update game state
+		// Update engine in fixed steps of scheduler.step_sec
+		for (u32 step = 0; step < steps; ++step) engine.update();
 
-		// Update engine
-		engine.update();
+		scheduler.endFrame();
 	}
 }
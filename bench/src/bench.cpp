@@ -0,0 +1,163 @@
+#include "bench.h"
+
+#include <format>
+#include <fstream>
+#include <sstream>
+#include <map>
+
+namespace Bench {
+
+namespace {
+
+[[nodiscard]] const char* simdBackend() {
+#if defined(MIRROR_SIMD_AVX2)
+	return "avx2";
+#elif defined(MIRROR_SIMD_SSE)
+	return "sse";
+#elif defined(MIRROR_SIMD_NEON)
+	return "neon";
+#else
+	return "scalar";
+#endif
+}
+
+// Nearest-rank percentile of sorted samples
+[[nodiscard]] f64 percentile(const std::vector<f64>& sorted, const f64 p) {
+	const usize rank = (usize)std::ceil(p * (f64)sorted.size());
+	return sorted[std::clamp<usize>(rank, 1, sorted.size()) - 1];
+}
+
+// JSON keys for the per-item counters
+[[nodiscard]] const char* counterKey(const PerfCounters::Counter counter) {
+	constexpr std::array<const char*, PerfCounters::COUNTER_COUNT> KEYS{
+		"cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses", "task_clock_ns"
+	};
+	return KEYS[counter];
+}
+
+// Reads the name -> p50 pairs back out of a file written by finish()
+[[nodiscard]] std::map<std::string, f64> readBaseline(const std::string& path) {
+	std::map<std::string, f64> baseline;
+	std::ifstream file{ path };
+	std::stringstream buffer;
+	buffer << file.rdbuf();
+	const std::string text = buffer.str();
+	for (usize at = text.find("\"name\": \""); at != std::string::npos; at = text.find("\"name\": \"", at)) {
+		at += 9;
+		const usize end = text.find('"', at);
+		const usize value = text.find("\"p50_ns\": ", end);
+		if (end == std::string::npos || value == std::string::npos) break;
+		baseline[text.substr(at, end - at)] = std::stod(text.substr(value + 10));
+	}
+	return baseline;
+}
+
+}
+
+bool Runner::selected(const std::string_view name) const noexcept {
+	if (options_.filters.empty()) return true;
+	return std::ranges::any_of(options_.filters, [&](const std::string& filter) {
+		return name.find(filter) != std::string_view::npos;
+	});
+}
+
+void Runner::record(const std::string_view name, const usize items, const u64 iterations, std::vector<f64>& samples) {
+	std::ranges::sort(samples);
+	Result result{
+		std::string{ name }, items, iterations,
+		samples.front(), percentile(samples, 0.5), percentile(samples, 0.9), percentile(samples, 0.99), samples.back(),
+	};
+	std::println("{:<44} {:>10.3f} ns  p90 {:>10.3f}  p99 {:>10.3f}  min {:>10.3f}", result.name, result.p50, result.p90, result.p99, result.min);
+	results_.push_back(std::move(result));
+}
+
+void Runner::printCounters(const Result& result) const {
+	std::string line = std::format("{:<44}", "");
+	if (counters_->available(PerfCounters::CYCLES) && counters_->available(PerfCounters::INSTRUCTIONS)) {
+		line += std::format(" IPC {:.2f}", result.counters[PerfCounters::INSTRUCTIONS] / std::max(result.counters[PerfCounters::CYCLES], 1e-9));
+	}
+	for (const PerfCounters::Counter counter : { PerfCounters::CYCLES, PerfCounters::L1D_MISSES, PerfCounters::LLC_MISSES, PerfCounters::BRANCH_MISSES }) {
+		if (counters_->available(counter)) line += std::format("  {} {:.3f}", PerfCounters::NAMES[counter], result.counters[counter]);
+	}
+	if (line.size() > 44) std::println("{}", line);
+}
+
+bool Runner::finish() {
+	bool ok = true;
+	if (options_.counters && (!counters_ || !counters_->valid())) std::println("no hardware counters available");
+	if (!options_.baseline.empty()) {
+		const std::map<std::string, f64> baseline = readBaseline(options_.baseline);
+		if (baseline.empty()) {
+			std::println("could not read baseline {}", options_.baseline);
+			ok = false;
+		}
+		std::println("\n{:<44} {:>10} {:>10} {:>8}", "vs baseline (p50 ns/item)", "baseline", "now", "speedup");
+		for (const Result& result : results_) {
+			const auto it = baseline.find(result.name);
+			if (it == baseline.end()) continue;
+			std::println("{:<44} {:>10.3f} {:>10.3f} {:>7.2f}x", result.name, it->second, result.p50, it->second / result.p50);
+		}
+	}
+
+	if (!options_.json.empty()) {
+		std::ofstream file{ options_.json };
+		file << "{\n\t\"simd\": \"" << simdBackend() << "\",\n\t\"results\": [\n";
+		for (usize n = 0; n < results_.size(); ++n) {
+			const Result& r = results_[n];
+			file << "\t\t{ \"name\": \"" << r.name << "\", \"items\": " << r.items << ", \"iterations\": " << r.iterations
+				<< ", \"min_ns\": " << r.min << ", \"p50_ns\": " << r.p50 << ", \"p90_ns\": " << r.p90
+				<< ", \"p99_ns\": " << r.p99 << ", \"max_ns\": " << r.max;
+			for (u32 c = 0; r.has_counters && c < PerfCounters::COUNTER_COUNT; ++c) {
+				if (counters_->available((PerfCounters::Counter)c)) file << ", \"" << counterKey((PerfCounters::Counter)c) << "\": " << r.counters[c];
+			}
+			file << " }" << (n + 1 < results_.size() ? ",\n" : "\n");
+		}
+		file << "\t]\n}\n";
+		if (!file) {
+			std::println("could not write {}", options_.json);
+			ok = false;
+		}
+	}
+	return ok;
+}
+
+}
+
+int main(const int argc, const char** argv) {
+	Bench::Options options;
+	for (i32 n = 1; n < argc; ++n) {
+		const std::string_view arg = argv[n];
+		const bool has_value = n + 1 < argc;
+		if (arg == "--json" && has_value) options.json = argv[++n];
+		else if (arg == "--baseline" && has_value) options.baseline = argv[++n];
+		else if (arg == "--samples" && has_value) options.samples = std::stoi(argv[++n]);
+		else if (arg == "--warmup" && has_value) options.warmup = std::stoi(argv[++n]);
+		else if (arg == "--sample-ms" && has_value) options.sample_ms = std::stod(argv[++n]);
+		else if (arg == "--counters") options.counters = true;
+		else if (arg.starts_with("--")) {
+			std::println("usage: bench [--json out.json] [--baseline old.json] [--samples n] [--warmup n] [--sample-ms ms] [--counters] [filter...]");
+			return 1;
+		} else {
+			options.filters.emplace_back(arg);
+		}
+	}
+
+	Bench::Runner runner{ std::move(options) };
+	std::println("{:<44} {:>13}", "benchmark (ns per item)", "p50");
+	Bench::vectorBenchmarks(runner);
+	Bench::matrixBenchmarks(runner);
+	Bench::rotationBenchmarks(runner);
+	Bench::transformBenchmarks(runner);
+	Bench::frustumBenchmarks(runner);
+	Bench::profilerBenchmarks(runner);
+	Bench::schedulerBenchmarks(runner);
+	Bench::statsBenchmarks(runner);
+	Bench::perfBenchmarks(runner);
+	Bench::jobsBenchmarks(runner);
+	Bench::systemsBenchmarks(runner);
+	Bench::ecsBenchmarks(runner);
+	Bench::memoryBenchmarks(runner);
+	Bench::renderQueueBenchmarks(runner);
+	Bench::vkBenchmarks(runner);
+	return runner.finish() ? 0 : 1;
+}
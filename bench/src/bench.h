@@ -0,0 +1,162 @@
+#pragma once
+
+#include <print>
+#include <string>
+#include <string_view>
+#include <chrono>
+#include <random>
+
+#include "frame/frame.h"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace Bench {
+
+using namespace Mirror;
+
+// Forces value to be materialized, so the work producing it can't be optimized away
+template<typename T>
+inline void doNotOptimize(const T& value) noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+	static const volatile void* sink;
+	sink = &value;
+	_ReadWriteBarrier();
+#else
+	asm volatile("" : : "g"(&value) : "memory");
+#endif
+}
+// Makes all pending writes observable, so stores into output arrays aren't dropped
+inline void clobberMemory() noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+	_ReadWriteBarrier();
+#else
+	asm volatile("" : : : "memory");
+#endif
+}
+
+// Element count for the array variants, large enough to stream from L2/L3 rather than sit in registers
+inline constexpr usize ARRAY_SIZE = 16384;
+
+// Deterministic inputs so runs are comparable against a baseline
+struct Random {
+	std::mt19937 rng{ 1234 };
+	std::uniform_real_distribution<f32> dist{ -1.0f, 1.0f };
+
+	[[nodiscard]] f32 operator()() { return dist(rng); }
+	[[nodiscard]] Vec2f vec2() { return { dist(rng), dist(rng) }; }
+	[[nodiscard]] Vec3f vec3() { return { dist(rng), dist(rng), dist(rng) }; }
+	[[nodiscard]] Vec4f vec4() { return { dist(rng), dist(rng), dist(rng), dist(rng) }; }
+	[[nodiscard]] Quatf rotation() { return Quatf{ dist(rng), dist(rng), dist(rng), dist(rng) }.normalized(); }
+	[[nodiscard]] Complexf rotor() { return Complexf::fromAngle(dist(rng) * 3.14159265f); }
+	[[nodiscard]] Mat4f matrix() {
+		// Diagonally dominant, so always invertible
+		Mat4f m;
+		m.x = vec4() + Vec4f{ 4, 0, 0, 0 };
+		m.y = vec4() + Vec4f{ 0, 4, 0, 0 };
+		m.z = vec4() + Vec4f{ 0, 0, 4, 0 };
+		m.w = vec4() + Vec4f{ 0, 0, 0, 4 };
+		return m;
+	}
+	template<typename Fn>
+	[[nodiscard]] auto array(Fn&& fn) {
+		std::vector<decltype(fn())> values(ARRAY_SIZE);
+		for (auto& value : values) value = fn();
+		return values;
+	}
+};
+
+struct Options {
+	i32 warmup = 3;
+	i32 samples = 31;
+	f64 sample_ms = 2; // each sample repeats the body until it runs at least this long
+	std::vector<std::string> filters;
+	std::string json;
+	std::string baseline;
+	bool counters = false; // hardware counters per item, where perf_event_open allows
+};
+
+// Timings are nanoseconds per item over all samples
+struct Result {
+	std::string name;
+	usize items;
+	u64 iterations;
+	f64 min, p50, p90, p99, max;
+	bool has_counters = false;
+	std::array<f64, PerfCounters::COUNTER_COUNT> counters{}; // per item, over one extra sample
+};
+
+class Runner {
+public:
+	explicit Runner(Options options) : options_(std::move(options)) {
+		if (options_.counters) counters_ = std::make_unique<PerfCounters>();
+	}
+
+	// Times fn, which processes items elements per call
+	template<typename Fn>
+	void run(const std::string_view name, const usize items, Fn&& fn) {
+		if (!selected(name)) return;
+
+		auto sample = [&](const u64 iterations) {
+			const auto begin = std::chrono::steady_clock::now();
+			for (u64 n = 0; n < iterations; ++n) {
+				fn();
+				clobberMemory();
+			}
+			return (f64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+		};
+
+		u64 iterations = 1;
+		for (f64 elapsed = sample(iterations); elapsed < options_.sample_ms * 1e6 && iterations < (1ull << 40);) {
+			const f64 target = options_.sample_ms * 1e6 * 1.2;
+			iterations = std::max(iterations * 2, (u64)((f64)iterations * target / std::max(elapsed, 1.0)));
+			elapsed = sample(iterations);
+		}
+		for (i32 n = 0; n < options_.warmup; ++n) sample(iterations);
+
+		std::vector<f64> samples((usize)std::max(options_.samples, 1));
+		for (f64& time : samples) time = sample(iterations) / (f64)(iterations * std::max<usize>(items, 1));
+		record(name, items, iterations, samples);
+
+		if (counters_ && counters_->valid()) {
+			const PerfCounters::Values begin = counters_->read();
+			sample(iterations);
+			const PerfCounters::Values values = counters_->read() - begin;
+			Result& result = results_.back();
+			result.has_counters = true;
+			for (u32 n = 0; n < PerfCounters::COUNTER_COUNT; ++n) result.counters[n] = (f64)values.counts[n] / (f64)(iterations * std::max<usize>(items, 1));
+			printCounters(result);
+		}
+	}
+
+	// Prints the summary, writes JSON and compares against the baseline if requested; false on I/O errors
+	bool finish();
+
+private:
+	[[nodiscard]] bool selected(std::string_view name) const noexcept;
+	void record(std::string_view name, usize items, u64 iterations, std::vector<f64>& samples);
+	void printCounters(const Result& result) const;
+
+	Options options_;
+	std::unique_ptr<PerfCounters> counters_;
+	std::vector<Result> results_;
+};
+
+void vectorBenchmarks(Runner& runner);
+void matrixBenchmarks(Runner& runner);
+void rotationBenchmarks(Runner& runner);
+void transformBenchmarks(Runner& runner);
+void frustumBenchmarks(Runner& runner);
+void profilerBenchmarks(Runner& runner);
+void schedulerBenchmarks(Runner& runner);
+void statsBenchmarks(Runner& runner);
+void perfBenchmarks(Runner& runner);
+void jobsBenchmarks(Runner& runner);
+void systemsBenchmarks(Runner& runner);
+void ecsBenchmarks(Runner& runner);
+void memoryBenchmarks(Runner& runner);
+void renderQueueBenchmarks(Runner& runner);
+void vkBenchmarks(Runner& runner);
+
+}
@@ -0,0 +1,75 @@
+#include "bench.h"
+
+#include <algorithm>
+
+namespace Bench {
+
+namespace {
+
+struct Velocity {
+	Vec3f value;
+};
+
+// Baseline: one heap allocation per object, visited in allocation-shuffled order
+struct Object {
+	Transform3Df transform;
+	Velocity velocity;
+	Mat4f matrix;
+};
+
+}
+
+void ecsBenchmarks(Runner& runner) {
+	Random random;
+	constexpr usize COUNT = 1'000'000;
+
+	World world;
+	std::vector<std::unique_ptr<Object>> objects;
+	objects.reserve(COUNT);
+	for (usize n = 0; n < COUNT; ++n) {
+		const Transform3Df transform{ random.vec3(), random.vec3(), random.rotation() };
+		const Velocity velocity{ random.vec3() };
+		world.create(transform, velocity, Mat4f{});
+		objects.push_back(std::make_unique<Object>(Object{ transform, velocity, {} }));
+	}
+	std::shuffle(objects.begin(), objects.end(), random.rng);
+
+	// Reads one 40-byte column: should run at memory bandwidth
+	auto transforms = world.query<const Transform3Df>();
+	runner.run("ECS read Transform3Df 1M", COUNT, [&] {
+		f32 sum = 0;
+		transforms.eachChunk([&](std::span<const Entity>, const std::span<const Transform3Df> column) {
+			for (const Transform3Df& transform : column) sum += transform.position.x;
+		});
+		doNotOptimize(sum);
+	});
+	runner.run("heap objects read Transform3Df 1M", COUNT, [&] {
+		f32 sum = 0;
+		for (const std::unique_ptr<Object>& object : objects) sum += object->transform.position.x;
+		doNotOptimize(sum);
+	});
+
+	auto moving = world.query<Transform3Df, const Velocity>();
+	runner.run("ECS integrate Transform3Df 1M", COUNT, [&] {
+		moving.eachChunk([&](std::span<const Entity>, const std::span<Transform3Df> transforms, const std::span<const Velocity> velocities) {
+			for (usize n = 0; n < transforms.size(); ++n) transforms[n].position += velocities[n].value * (1.0f / 60.0f);
+		});
+	});
+	runner.run("ECS integrate Transform3Df 1M parallel", COUNT, [&] {
+		moving.parallelEachChunk([&](std::span<const Entity>, const std::span<Transform3Df> transforms, const std::span<const Velocity> velocities) {
+			for (usize n = 0; n < transforms.size(); ++n) transforms[n].position += velocities[n].value * (1.0f / 60.0f);
+		});
+	});
+	runner.run("heap objects integrate Transform3Df 1M", COUNT, [&] {
+		for (const std::unique_ptr<Object>& object : objects) object->transform.position += object->velocity.value * (1.0f / 60.0f);
+	});
+
+	auto matrices = world.query<const Transform3Df, Mat4f>();
+	runner.run("ECS Transform3Df matrices 1M parallel", COUNT, [&] {
+		matrices.parallelEachChunk([&](std::span<const Entity>, const std::span<const Transform3Df> transforms, const std::span<Mat4f> out) {
+			for (usize n = 0; n < transforms.size(); ++n) out[n] = transforms[n].matrix();
+		});
+	});
+}
+
+}
@@ -0,0 +1,49 @@
+#include "bench.h"
+
+#include <format>
+
+namespace Bench {
+
+void frustumBenchmarks(Runner& runner) {
+	// A million objects scattered around a camera, most of them outside its frustum. Items are the objects culled,
+	// the metric the culling is for, so 1e6 / ns is objects culled per ms.
+	constexpr usize COUNT = 1 << 20;
+	const Cameraf camera{ { 0, 0, -20 }, Quatf::fromAxisAngle({ 0, 1, 0 }, 0.2f) };
+	const Frustumf frustum = camera.matrices(Cameraf::perspective(0.1f, 100.0f, 16.0f / 9.0f, 0.8f)).frustum();
+	Random random;
+	std::vector<f32> x(COUNT), y(COUNT), z(COUNT), radius(COUNT);
+	std::vector<f32> min_x(COUNT), min_y(COUNT), min_z(COUNT), max_x(COUNT), max_y(COUNT), max_z(COUNT);
+	for (usize n = 0; n < COUNT; ++n) {
+		x[n] = random() * 150;
+		y[n] = random() * 150;
+		z[n] = random() * 150;
+		radius[n] = 2.55f + random() * 2.45f;
+		min_x[n] = x[n] - radius[n];
+		min_y[n] = y[n] - radius[n];
+		min_z[n] = z[n] - radius[n];
+		max_x[n] = x[n] + radius[n];
+		max_y[n] = y[n] + radius[n];
+		max_z[n] = z[n] + radius[n];
+	}
+	const BoundingSpheres spheres{ x, y, z, radius };
+	const BoundingBoxes boxes{ min_x, min_y, min_z, max_x, max_y, max_z };
+	std::vector<u32> visible(COUNT);
+
+	// Powers of two up to every core the JobSystem has
+	const usize cores = JobSystem::instance().threadCount();
+	for (usize threads = 1;; threads = std::min(threads * 2, cores)) {
+		const usize culled_spheres = COUNT - frustum.cullSpheres(spheres, visible, threads);
+		runner.run(std::format("Frustumf cullSpheres 1M, {} threads", threads), culled_spheres, [&] {
+			doNotOptimize(frustum.cullSpheres(spheres, visible, threads));
+			clobberMemory();
+		});
+		const usize culled_boxes = COUNT - frustum.cullBoxes(boxes, visible, threads);
+		runner.run(std::format("Frustumf cullBoxes 1M, {} threads", threads), culled_boxes, [&] {
+			doNotOptimize(frustum.cullBoxes(boxes, visible, threads));
+			clobberMemory();
+		});
+		if (threads == cores) break;
+	}
+}
+
+}
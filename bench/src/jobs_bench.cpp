@@ -0,0 +1,47 @@
+#include "bench.h"
+
+#include <format>
+
+namespace Bench {
+
+void jobsBenchmarks(Runner& runner) {
+	Random random;
+	constexpr usize COUNT = ARRAY_SIZE * 16;
+	std::vector<Vec3f> positions(COUNT);
+	std::vector<Vec3f> scales(COUNT);
+	std::vector<Quatf> rotations(COUNT);
+	for (usize n = 0; n < COUNT; ++n) {
+		positions[n] = random.vec3();
+		scales[n] = random.vec3();
+		rotations[n] = random.rotation();
+	}
+	std::vector<Mat4f> out(COUNT);
+
+	// Same batched kernel split over pools of growing size, for speedup against core count
+	const usize cores = std::max<usize>(std::thread::hardware_concurrency(), 1);
+	for (usize threads = 1;; threads = std::min(threads * 2, cores)) {
+		JobSystem jobs{ threads - 1 };
+		runner.run(std::format("JobSystem parallelFor matrices x{}", threads), COUNT, [&] {
+			jobs.parallelFor(COUNT, 1024, [&](const usize begin, const usize end) {
+				Transform3Df::matrices(
+					{ positions.data() + begin, end - begin },
+					{ scales.data() + begin, end - begin },
+					{ rotations.data() + begin, end - begin },
+					{ out.data() + begin, end - begin }
+				);
+			});
+			doNotOptimize(out);
+		});
+		if (threads == cores) break;
+	}
+
+	JobSystem& jobs = JobSystem::instance();
+	auto empty = [] {};
+	runner.run("JobSystem run+wait empty", 256, [&] {
+		JobSystem::Counter counter;
+		for (i32 n = 0; n < 256; ++n) jobs.run(counter, empty);
+		jobs.wait(counter);
+	});
+}
+
+}
@@ -0,0 +1,68 @@
+#include "bench.h"
+
+namespace Bench {
+
+void matrixBenchmarks(Runner& runner) {
+	Random random;
+	Mat4f a = random.matrix(), b = random.matrix();
+	Vec4f v = random.vec4();
+	// Rigid transform for the specialized inverses
+	Mat4f rigid{ random.rotation().matrix() };
+	rigid.w = { random.vec3(), 1 };
+
+	runner.run("Mat4f * Mat4f", 1, [&] {
+		doNotOptimize(a);
+		doNotOptimize(b);
+		doNotOptimize(a * b);
+	});
+	runner.run("Mat4f * Vec4f", 1, [&] {
+		doNotOptimize(a);
+		doNotOptimize(v);
+		doNotOptimize(a * v);
+	});
+	runner.run("Mat4f transposed", 1, [&] {
+		doNotOptimize(a);
+		doNotOptimize(a.transposed());
+	});
+	runner.run("Mat4f determinant", 1, [&] {
+		doNotOptimize(a);
+		doNotOptimize(a.determinant());
+	});
+	runner.run("Mat4f inverted", 1, [&] {
+		doNotOptimize(a);
+		doNotOptimize(a.inverted());
+	});
+	runner.run("Mat4f affineInverted", 1, [&] {
+		doNotOptimize(rigid);
+		doNotOptimize(rigid.affineInverted());
+	});
+	runner.run("Mat4f rigidInverted", 1, [&] {
+		doNotOptimize(rigid);
+		doNotOptimize(rigid.rigidInverted());
+	});
+
+	const std::vector<Mat4f> as = random.array([&] { return random.matrix(); });
+	const std::vector<Mat4f> bs = random.array([&] { return random.matrix(); });
+	const std::vector<Vec4f> vs = random.array([&] { return random.vec4(); });
+	std::vector<Mat4f> out(ARRAY_SIZE);
+	std::vector<Vec4f> out4(ARRAY_SIZE);
+
+	runner.run("Mat4f * Mat4f [array]", ARRAY_SIZE, [&] {
+		for (usize n = 0; n < ARRAY_SIZE; ++n) out[n] = as[n] * bs[n];
+		doNotOptimize(out);
+	});
+	runner.run("Mat4f * Vec4f [array]", ARRAY_SIZE, [&] {
+		for (usize n = 0; n < ARRAY_SIZE; ++n) out4[n] = as[n] * vs[n];
+		doNotOptimize(out4);
+	});
+	runner.run("Mat4f transposed [array]", ARRAY_SIZE, [&] {
+		for (usize n = 0; n < ARRAY_SIZE; ++n) out[n] = as[n].transposed();
+		doNotOptimize(out);
+	});
+	runner.run("Mat4f inverted [array]", ARRAY_SIZE, [&] {
+		for (usize n = 0; n < ARRAY_SIZE; ++n) out[n] = as[n].inverted();
+		doNotOptimize(out);
+	});
+}
+
+}
@@ -0,0 +1,36 @@
+#include "bench.h"
+
+namespace Bench {
+
+void memoryBenchmarks(Runner& runner) {
+	constexpr usize COUNT = 1024;
+	std::vector<void*> blocks(COUNT);
+
+	runner.run("new/delete 64 B", COUNT, [&] {
+		for (void*& block : blocks) block = ::operator new(64);
+		doNotOptimize(blocks);
+		for (void* block : blocks) ::operator delete(block);
+	});
+
+	LinearArena arena{ 64 * COUNT };
+	runner.run("LinearArena allocate 64 B", COUNT, [&] {
+		for (void*& block : blocks) block = arena.allocate(64);
+		doNotOptimize(blocks);
+		arena.reset();
+	});
+
+	BlockPool pool{ 64, COUNT };
+	runner.run("BlockPool allocate+free 64 B", COUNT, [&] {
+		for (void*& block : blocks) block = pool.allocate();
+		doNotOptimize(blocks);
+		for (void* block : blocks) pool.free(block);
+	});
+
+	runner.run("ScratchScope vector of 256 f32", 1, [&] {
+		ScratchScope scope;
+		f32* values = scope.allocate<f32>(256);
+		doNotOptimize(values);
+	});
+}
+
+}
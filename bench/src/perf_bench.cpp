@@ -0,0 +1,23 @@
+#include "bench.h"
+
+namespace Bench {
+
+void perfBenchmarks(Runner& runner) {
+#if !defined(MIRROR_NO_PERF_COUNTERS)
+	// An empty zone with the monitor enabled: two counter reads plus the profiler zone it wraps. Both are drained
+	// every iteration, so the profiler buffer never fills and drops.
+	constexpr usize ZONES = 256;
+	PerfMonitor& monitor = PerfMonitor::instance();
+	monitor.setEnabled(true);
+	runner.run("PerfMonitor empty zone", ZONES, [&] {
+		for (usize n = 0; n < ZONES; ++n) {
+			MIRROR_PERF_ZONE("empty");
+		}
+		doNotOptimize(monitor.frame().zones.size());
+		doNotOptimize(Profiler::instance().frame().zones.size());
+	});
+	monitor.setEnabled(false);
+#endif
+}
+
+}
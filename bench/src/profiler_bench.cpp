@@ -0,0 +1,21 @@
+#include "bench.h"
+
+namespace Bench {
+
+void profilerBenchmarks(Runner& runner) {
+#if !defined(MIRROR_NO_PROFILER)
+	// Recording cost of an empty zone: both timestamps and the buffer push, plus its share of the frame() that
+	// drains it, so the buffer never fills and drops
+	constexpr usize ZONES = 4096;
+	Profiler& profiler = Profiler::instance();
+	profiler.frame();
+	runner.run("Profiler empty zone", ZONES, [&] {
+		for (usize n = 0; n < ZONES; ++n) {
+			MIRROR_PROFILE_ZONE("empty");
+		}
+		doNotOptimize(profiler.frame().zones.size());
+	});
+#endif
+}
+
+}
@@ -0,0 +1,40 @@
+#include "bench.h"
+
+#include "reflect/render_queue.h"
+
+namespace Bench {
+
+using namespace Mirror::Reflect;
+
+void renderQueueBenchmarks(Runner& runner) {
+	// A busy 2D frame: 2 layers, 2 pipelines and 8 atlas pages, so 32 batches at most
+	constexpr usize SPRITES = 100'000;
+	Random random;
+	std::vector<DrawKey> keys(SPRITES);
+	std::vector<SpriteInstance> sprites(SPRITES);
+	for (usize n = 0; n < SPRITES; ++n) {
+		const u32 state = (u32)(random.rng() % 32);
+		keys[n] = DrawKey::make(state >> 4, (state >> 3) & 1, state & 7, 1 + 100 * std::abs(random()));
+		sprites[n] = { { 16, 0 }, { 0, 16 }, { random() * 1000, random() * 1000, 0 }, ~0u };
+	}
+
+	RenderQueue queue{ sizeof(SpriteInstance), SPRITES };
+	std::vector<SpriteInstance> destination(SPRITES);
+	runner.run("RenderQueue submit+sort+batch 100k sprites", SPRITES, [&] {
+		queue.clear();
+		for (usize n = 0; n < SPRITES; ++n) queue.submit(keys[n], sprites[n]);
+		queue.sort();
+		doNotOptimize(queue.batch(reinterpret_cast<std::byte*>(destination.data())).size());
+		clobberMemory();
+	});
+
+	// The comparison sort the radix sort replaces, on the keys alone
+	std::vector<DrawKey> sorted(SPRITES);
+	runner.run("std::sort 100k draw keys", SPRITES, [&] {
+		std::ranges::copy(keys, sorted.begin());
+		std::ranges::sort(sorted);
+		doNotOptimize(sorted.data());
+	});
+}
+
+}
@@ -0,0 +1,69 @@
+#include "bench.h"
+
+namespace Bench {
+
+void rotationBenchmarks(Runner& runner) {
+	Random random;
+	Quatf q = random.rotation(), p = random.rotation();
+	Complexf c = random.rotor(), d = random.rotor();
+	Vec3f v3 = random.vec3();
+	Vec2f v2 = random.vec2();
+
+	runner.run("Quatf * Quatf", 1, [&] {
+		doNotOptimize(q);
+		doNotOptimize(p);
+		doNotOptimize(q * p);
+	});
+	runner.run("Quatf * Vec3f", 1, [&] {
+		doNotOptimize(q);
+		doNotOptimize(v3);
+		doNotOptimize(q * v3);
+	});
+	runner.run("Quatf matrix", 1, [&] {
+		doNotOptimize(q);
+		doNotOptimize(q.matrix());
+	});
+	runner.run("Complexf * Complexf", 1, [&] {
+		doNotOptimize(c);
+		doNotOptimize(d);
+		doNotOptimize(c * d);
+	});
+	runner.run("Complexf * Vec2f", 1, [&] {
+		doNotOptimize(c);
+		doNotOptimize(v2);
+		doNotOptimize(c * v2);
+	});
+	runner.run("Complexf matrix", 1, [&] {
+		doNotOptimize(c);
+		doNotOptimize(c.matrix());
+	});
+
+	const std::vector<Quatf> qs = random.array([&] { return random.rotation(); });
+	const std::vector<Quatf> ps = random.array([&] { return random.rotation(); });
+	const std::vector<Complexf> cs = random.array([&] { return random.rotor(); });
+	const std::vector<Vec3f> vs3 = random.array([&] { return random.vec3(); });
+	const std::vector<Vec2f> vs2 = random.array([&] { return random.vec2(); });
+	std::vector<Quatf> out_q(ARRAY_SIZE);
+	std::vector<Vec3f> out3(ARRAY_SIZE);
+	std::vector<Mat3f> out_m(ARRAY_SIZE);
+	std::vector<Vec2f> out2(ARRAY_SIZE);
+
+	runner.run("Quatf * Quatf [array]", ARRAY_SIZE, [&] {
+		for (usize n = 0; n < ARRAY_SIZE; ++n) out_q[n] = qs[n] * ps[n];
+		doNotOptimize(out_q);
+	});
+	runner.run("Quatf * Vec3f [array]", ARRAY_SIZE, [&] {
+		for (usize n = 0; n < ARRAY_SIZE; ++n) out3[n] = qs[n] * vs3[n];
+		doNotOptimize(out3);
+	});
+	runner.run("Quatf matrix [array]", ARRAY_SIZE, [&] {
+		for (usize n = 0; n < ARRAY_SIZE; ++n) out_m[n] = qs[n].matrix();
+		doNotOptimize(out_m);
+	});
+	runner.run("Complexf * Vec2f [array]", ARRAY_SIZE, [&] {
+		for (usize n = 0; n < ARRAY_SIZE; ++n) out2[n] = cs[n] * vs2[n];
+		doNotOptimize(out2);
+	});
+}
+
+}
@@ -0,0 +1,20 @@
+#include "bench.h"
+
+namespace Bench {
+
+void statsBenchmarks(Runner& runner) {
+	// Frame times from 1 to 40 ms, spread over most of the histogram's buckets
+	Random random;
+	const std::vector<std::chrono::nanoseconds> times = random.array([&] {
+		return std::chrono::nanoseconds{ (i64)(20.5e6 + 19.5e6 * random()) };
+	});
+	FrameStats stats;
+	runner.run("FrameStats record", ARRAY_SIZE, [&] {
+		for (const std::chrono::nanoseconds time : times) stats.record(time);
+	});
+	runner.run("FrameStats snapshot", 1, [&] {
+		doNotOptimize(stats.snapshot());
+	});
+}
+
+}
@@ -0,0 +1,34 @@
+#include "bench.h"
+
+#include <functional>
+
+namespace Bench {
+
+namespace {
+
+template<u32 N>
+struct Resource {};
+
+}
+
+void systemsBenchmarks(Runner& runner) {
+	// Scheduling overhead per system: 64 empty systems over 4 resources, a mix of chains and independent ones, so
+	// the time is dependency release and dispatch rather than work
+	constexpr usize SYSTEMS = 64;
+	SystemScheduler systems;
+	for (usize n = 0; n < SYSTEMS; ++n) {
+		auto builder = systems.add("empty", []() {});
+		switch (n % 4) {
+		case 0: builder.writes<Resource<0>>(); break;
+		case 1: builder.reads<Resource<0>>().writes<Resource<1>>(); break;
+		case 2: builder.reads<Resource<1>>(); break;
+		default: builder.writes<Resource<2>>(); break;
+		}
+	}
+	JobSystem& jobs = JobSystem::instance();
+	runner.run("SystemScheduler run 64 empty systems", SYSTEMS, [&] {
+		systems.run(jobs);
+	});
+}
+
+}
@@ -0,0 +1,61 @@
+#include "bench.h"
+
+namespace Bench {
+
+void transformBenchmarks(Runner& runner) {
+	Random random;
+	Transform3Df transform{ random.vec3(), random.vec3(), random.rotation() };
+	Transform2Df sprite{ random.vec3(), random.vec2(), random.rotor() };
+	Cameraf camera{ random.vec3(), random.rotation() };
+	const Mat4f projection = Cameraf::perspective(0.1f, 100.0f, 16.0f / 9.0f, 1.0f);
+
+	runner.run("Transform3Df matrix", 1, [&] {
+		doNotOptimize(transform);
+		doNotOptimize(transform.matrix());
+	});
+	runner.run("Transform2Df matrix", 1, [&] {
+		doNotOptimize(sprite);
+		doNotOptimize(sprite.matrix());
+	});
+	runner.run("Cameraf view", 1, [&] {
+		doNotOptimize(camera);
+		doNotOptimize(camera.view());
+	});
+	runner.run("Cameraf matrices", 1, [&] {
+		doNotOptimize(camera);
+		doNotOptimize(camera.matrices(projection));
+	});
+
+	const std::vector<Vec3f> positions = random.array([&] { return random.vec3(); });
+	const std::vector<Vec3f> scales = random.array([&] { return random.vec3(); });
+	const std::vector<Quatf> rotations = random.array([&] { return random.rotation(); });
+	const std::vector<Vec2f> sprite_scales = random.array([&] { return random.vec2(); });
+	const std::vector<Complexf> rotors = random.array([&] { return random.rotor(); });
+	const std::vector<Cameraf> cameras = random.array([&] { return Cameraf{ random.vec3(), random.rotation() }; });
+	std::vector<Mat4f> out(ARRAY_SIZE);
+	std::vector<SpriteInstance> sprites(ARRAY_SIZE);
+
+	// Per-object calls against the batched kernel over the same data
+	runner.run("Transform3Df matrix [array]", ARRAY_SIZE, [&] {
+		for (usize n = 0; n < ARRAY_SIZE; ++n) out[n] = Transform3Df{ positions[n], scales[n], rotations[n] }.matrix();
+		doNotOptimize(out);
+	});
+	runner.run("Transform3Df matrices [array]", ARRAY_SIZE, [&] {
+		Transform3Df::matrices(positions, scales, rotations, out);
+		doNotOptimize(out);
+	});
+	runner.run("Transform2Df matrix [array]", ARRAY_SIZE, [&] {
+		for (usize n = 0; n < ARRAY_SIZE; ++n) out[n] = Transform2Df{ positions[n], sprite_scales[n], rotors[n] }.matrix();
+		doNotOptimize(out);
+	});
+	runner.run("Transform2Df instances [array]", ARRAY_SIZE, [&] {
+		Transform2Df::instances(positions, sprite_scales, rotors, {}, sprites);
+		doNotOptimize(sprites);
+	});
+	runner.run("Cameraf view [array]", ARRAY_SIZE, [&] {
+		for (usize n = 0; n < ARRAY_SIZE; ++n) out[n] = cameras[n].view();
+		doNotOptimize(out);
+	});
+}
+
+}
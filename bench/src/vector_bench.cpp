@@ -0,0 +1,56 @@
+#include "bench.h"
+
+namespace Bench {
+
+void vectorBenchmarks(Runner& runner) {
+	Random random;
+	Vec4f a4 = random.vec4(), b4 = random.vec4();
+	Vec3f a3 = random.vec3(), b3 = random.vec3();
+
+	runner.run("Vec4f + Vec4f", 1, [&] {
+		doNotOptimize(a4);
+		doNotOptimize(b4);
+		doNotOptimize(a4 + b4);
+	});
+	runner.run("Vec4f dot", 1, [&] {
+		doNotOptimize(a4);
+		doNotOptimize(b4);
+		doNotOptimize(a4.dot(b4));
+	});
+	runner.run("Vec3f cross", 1, [&] {
+		doNotOptimize(a3);
+		doNotOptimize(b3);
+		doNotOptimize(a3.cross(b3));
+	});
+	runner.run("Vec3f normalized", 1, [&] {
+		doNotOptimize(a3);
+		doNotOptimize(a3.normalized());
+	});
+
+	const std::vector<Vec4f> as4 = random.array([&] { return random.vec4(); });
+	const std::vector<Vec4f> bs4 = random.array([&] { return random.vec4(); });
+	const std::vector<Vec3f> as3 = random.array([&] { return random.vec3(); });
+	const std::vector<Vec3f> bs3 = random.array([&] { return random.vec3(); });
+	std::vector<Vec4f> out4(ARRAY_SIZE);
+	std::vector<Vec3f> out3(ARRAY_SIZE);
+	std::vector<f32> out1(ARRAY_SIZE);
+
+	runner.run("Vec4f + Vec4f [array]", ARRAY_SIZE, [&] {
+		for (usize n = 0; n < ARRAY_SIZE; ++n) out4[n] = as4[n] + bs4[n];
+		doNotOptimize(out4);
+	});
+	runner.run("Vec4f dot [array]", ARRAY_SIZE, [&] {
+		for (usize n = 0; n < ARRAY_SIZE; ++n) out1[n] = as4[n].dot(bs4[n]);
+		doNotOptimize(out1);
+	});
+	runner.run("Vec3f cross [array]", ARRAY_SIZE, [&] {
+		for (usize n = 0; n < ARRAY_SIZE; ++n) out3[n] = as3[n].cross(bs3[n]);
+		doNotOptimize(out3);
+	});
+	runner.run("Vec3f normalized [array]", ARRAY_SIZE, [&] {
+		for (usize n = 0; n < ARRAY_SIZE; ++n) out3[n] = as3[n].normalized();
+		doNotOptimize(out3);
+	});
+}
+
+}
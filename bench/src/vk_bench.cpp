@@ -0,0 +1,66 @@
+#include "bench.h"
+
+#include "reflect/vk/vk_resources.h"
+
+#include <format>
+
+namespace Bench {
+
+using namespace Mirror::Reflect;
+
+void vkBenchmarks(Runner& runner) {
+	std::optional<Vk::Context> context;
+	try {
+		context.emplace();
+	} catch (const Error) {
+		std::println("no Vulkan driver, Vk benchmarks skipped");
+		return;
+	}
+
+	// Recording only, nothing is submitted: one copy per item, as one per draw batch, so the time is all driver
+	// command encoding. The primary buffer is re-recorded every iteration.
+	constexpr usize COMMANDS = 16384;
+	Vk::Buffer source{ *context, 4096, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, Vk::MemoryUsage::UPLOAD };
+	Vk::Buffer destination{ *context, 4096, VK_BUFFER_USAGE_TRANSFER_DST_BIT, Vk::MemoryUsage::DEVICE };
+	const VkCommandPoolCreateInfo pool_info{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+		.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+		.queueFamilyIndex = context->queueFamily(),
+	};
+	VkCommandPool pool;
+	Vk::check(vkCreateCommandPool(context->device(), &pool_info, nullptr, &pool));
+	const VkCommandBufferAllocateInfo commands_info{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+		.commandPool = pool,
+		.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+		.commandBufferCount = 1,
+	};
+	VkCommandBuffer primary;
+	Vk::check(vkAllocateCommandBuffers(context->device(), &commands_info, &primary));
+	const VkCommandBufferBeginInfo begin_info{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+	};
+
+	// Powers of two up to every core the JobSystem has
+	const u32 cores = (u32)JobSystem::instance().threadCount();
+	for (u32 threads = 1;; threads = std::min(threads * 2, cores)) {
+		Vk::ParallelRecorder recorder{ *context, threads, 1 };
+		runner.run(std::format("ParallelRecorder {} copies, {} threads", COMMANDS, threads), COMMANDS, [&] {
+			Vk::check(vkResetCommandPool(context->device(), pool, 0));
+			Vk::check(vkBeginCommandBuffer(primary, &begin_info));
+			recorder.record(primary, 0, COMMANDS, 256, [&](const VkCommandBuffer commands, const usize begin, const usize end) {
+				for (usize n = begin; n < end; ++n) {
+					const VkBufferCopy copy{ (n % 1024) * 4, (n % 1024) * 4, 4 };
+					vkCmdCopyBuffer(commands, source.buffer(), destination.buffer(), 1, &copy);
+				}
+			});
+			Vk::check(vkEndCommandBuffer(primary));
+		});
+		if (threads == cores) break;
+	}
+
+	vkDestroyCommandPool(context->device(), pool, nullptr);
+}
+
+}
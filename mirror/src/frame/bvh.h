@@ -0,0 +1,365 @@
+#pragma once
+
+#include "types.h"
+#include "parallel.h"
+#include "vector.h"
+#include "camera.h"
+
+#include <limits>
+#include <numeric>
+#include <queue>
+
+namespace Mirror {
+
+template<typename T>
+struct Aabb {
+	Vec3<T> min{ std::numeric_limits<T>::max() };
+	Vec3<T> max{ std::numeric_limits<T>::lowest() };
+
+	[[nodiscard]] constexpr Vec3<T> center() const noexcept {
+		return (min + max) / 2;
+	}
+	[[nodiscard]] constexpr T surfaceArea() const noexcept {
+		const Vec3<T> d = max - min;
+		return 2 * (d.x * d.y + d.y * d.z + d.z * d.x);
+	}
+
+	[[nodiscard]] constexpr Aabb merged(const Aabb& other) const noexcept {
+		return {
+			{ std::min(min.x, other.min.x), std::min(min.y, other.min.y), std::min(min.z, other.min.z) },
+			{ std::max(max.x, other.max.x), std::max(max.y, other.max.y), std::max(max.z, other.max.z) },
+		};
+	}
+	constexpr Aabb& merge(const Aabb& other) noexcept {
+		*this = merged(other);
+		return *this;
+	}
+	constexpr Aabb& merge(const Vec3<T>& point) noexcept {
+		*this = merged({ point, point });
+		return *this;
+	}
+
+	[[nodiscard]] constexpr bool overlaps(const Aabb& other) const noexcept {
+		return min.x <= other.max.x && max.x >= other.min.x
+			&& min.y <= other.max.y && max.y >= other.min.y
+			&& min.z <= other.max.z && max.z >= other.min.z;
+	}
+	[[nodiscard]] constexpr T distanceSquared(const Vec3<T>& point) const noexcept {
+		const Vec3<T> d{
+			std::max({ min.x - point.x, T{ 0 }, point.x - max.x }),
+			std::max({ min.y - point.y, T{ 0 }, point.y - max.y }),
+			std::max({ min.z - point.z, T{ 0 }, point.z - max.z }),
+		};
+		return d.lengthSquared();
+	}
+	// Slab test, returns the entry distance when the ray hits within [0, max_distance]
+	[[nodiscard]] constexpr std::optional<T> intersect(const Vec3<T>& origin, const Vec3<T>& inv_direction, const T max_distance) const noexcept {
+		const Vec3<T> t0 = (min - origin) * inv_direction;
+		const Vec3<T> t1 = (max - origin) * inv_direction;
+		const T enter = std::max({ std::min(t0.x, t1.x), std::min(t0.y, t1.y), std::min(t0.z, t1.z), T{ 0 } });
+		const T exit = std::min({ std::max(t0.x, t1.x), std::max(t0.y, t1.y), std::max(t0.z, t1.z), max_distance });
+		if (enter > exit) return std::nullopt;
+		return enter;
+	}
+};
+
+using Aabbf = Aabb<f32>;
+
+// Bounding volume hierarchy over object bounds, built with binned SAH and kept current by refitting.
+// Nodes are stored depth first: a node's left child directly follows it, so refits run as one reverse sweep.
+template<typename T>
+class Bvh {
+public:
+	struct Node {
+		Aabb<T> bounds;
+		u32 offset; // interior: index of the right child, leaf: first entry in the leaf arrays
+		u32 count;  // objects in a leaf, 0 for interior nodes
+	};
+	struct Hit {
+		u32 index;
+		T distance;
+	};
+
+	static constexpr u32 MAX_LEAF_SIZE = 4;
+	static constexpr u32 BIN_COUNT = 12;
+	// Deepest a node can be, which bounds the traversal stacks. SAH splits stop at SAH_DEPTH and median splits take
+	// over; those halve the range, so even 2^32 objects reach leaves within the remaining levels.
+	static constexpr u32 MAX_DEPTH = 64;
+	static constexpr u32 SAH_DEPTH = MAX_DEPTH - 32;
+
+	// update() rebuilds when refits have made the tree this much more expensive than when it was built,
+	// or after rebuild_interval refits if that is non-zero
+	T rebuild_threshold = T{ 1.5 };
+	u32 rebuild_interval = 0;
+
+	void build(const std::span<const Aabb<T>> bounds) {
+		nodes_.clear();
+		indices_.resize(bounds.size());
+		std::iota(indices_.begin(), indices_.end(), 0);
+		leaf_bounds_.resize(bounds.size());
+		refits_ = 0;
+		if (bounds.empty()) {
+			build_cost_ = 0;
+			return;
+		}
+
+		std::vector<Vec3<T>> centers(bounds.size());
+		for (usize n = 0; n < bounds.size(); ++n) centers[n] = bounds[n].center();
+		nodes_.reserve(2 * bounds.size() / MAX_LEAF_SIZE + 1);
+		buildNode(bounds, centers, 0, (u32)bounds.size(), 0);
+		for (usize n = 0; n < indices_.size(); ++n) leaf_bounds_[n] = bounds[indices_[n]];
+		build_cost_ = cost();
+	}
+
+	// Recomputes node bounds for moved objects without changing the topology
+	void refit(const std::span<const Aabb<T>> bounds) noexcept {
+		assert(bounds.size() == indices_.size());
+		for (usize n = nodes_.size(); n-- > 0;) {
+			Node& node = nodes_[n];
+			if (node.count > 0) {
+				Aabb<T> box;
+				for (u32 i = node.offset; i < node.offset + node.count; ++i) {
+					leaf_bounds_[i] = bounds[indices_[i]];
+					box.merge(leaf_bounds_[i]);
+				}
+				node.bounds = box;
+			} else {
+				node.bounds = nodes_[n + 1].bounds.merged(nodes_[node.offset].bounds);
+			}
+		}
+		++refits_;
+	}
+
+	// Refit, or rebuild when the tree has degraded; returns true if it was rebuilt
+	bool update(const std::span<const Aabb<T>> bounds) {
+		if (bounds.size() != indices_.size() || (rebuild_interval != 0 && refits_ >= rebuild_interval)) {
+			build(bounds);
+			return true;
+		}
+		refit(bounds);
+		if (cost() > build_cost_ * rebuild_threshold) {
+			build(bounds);
+			return true;
+		}
+		return false;
+	}
+
+	// SAH cost relative to the root: expected node visits plus object tests for a random ray
+	[[nodiscard]] T cost() const noexcept {
+		if (nodes_.empty()) return 0;
+		const T root_area = std::max(nodes_[0].bounds.surfaceArea(), std::numeric_limits<T>::min());
+		T total = 0;
+		for (const Node& node : nodes_) total += node.bounds.surfaceArea() * (node.count > 0 ? (T)node.count : 1);
+		return total / root_area;
+	}
+	[[nodiscard]] std::span<const Node> nodes() const noexcept { return nodes_; }
+	[[nodiscard]] usize size() const noexcept { return indices_.size(); }
+
+	[[nodiscard]] std::optional<Hit> raycast(const Ray<T>& ray, const T max_distance = std::numeric_limits<T>::max()) const noexcept {
+		if (nodes_.empty()) return std::nullopt;
+		const Vec3<T> inv_direction{ 1 / ray.direction.x, 1 / ray.direction.y, 1 / ray.direction.z };
+		const std::optional<T> root = nodes_[0].bounds.intersect(ray.origin, inv_direction, max_distance);
+		if (!root) return std::nullopt;
+
+		std::optional<Hit> hit;
+		T closest = max_distance;
+		struct Entry { u32 node; T distance; };
+		Entry stack[MAX_DEPTH];
+		usize top = 0;
+		stack[top++] = { 0, *root };
+		while (top > 0) {
+			const Entry entry = stack[--top];
+			if (entry.distance > closest) continue;
+			const Node& node = nodes_[entry.node];
+			if (node.count > 0) {
+				for (u32 i = node.offset; i < node.offset + node.count; ++i) {
+					const std::optional<T> t = leaf_bounds_[i].intersect(ray.origin, inv_direction, closest);
+					if (t && (!hit || *t < closest)) {
+						closest = *t;
+						hit = Hit{ indices_[i], *t };
+					}
+				}
+				continue;
+			}
+
+			// Push the farther child first so the nearer one is visited next
+			const u32 left = entry.node + 1;
+			const u32 right = node.offset;
+			const std::optional<T> t_left = nodes_[left].bounds.intersect(ray.origin, inv_direction, closest);
+			const std::optional<T> t_right = nodes_[right].bounds.intersect(ray.origin, inv_direction, closest);
+			if (t_left && t_right) {
+				const bool left_first = *t_left <= *t_right;
+				stack[top++] = left_first ? Entry{ right, *t_right } : Entry{ left, *t_left };
+				stack[top++] = left_first ? Entry{ left, *t_left } : Entry{ right, *t_right };
+			} else if (t_left) {
+				stack[top++] = { left, *t_left };
+			} else if (t_right) {
+				stack[top++] = { right, *t_right };
+			}
+			assert(top <= MAX_DEPTH);
+		}
+		return hit;
+	}
+	void raycast(
+		const std::span<const Ray<T>> rays,
+		const std::span<std::optional<Hit>> hits,
+		const T max_distance = std::numeric_limits<T>::max(),
+		const usize thread_count = 1
+	) const noexcept {
+		assert(hits.size() == rays.size());
+		parallelChunks(rays.size(), thread_count, 1024, [&](usize, const usize begin, const usize end) {
+			for (usize n = begin; n < end; ++n) hits[n] = raycast(rays[n], max_distance);
+		});
+	}
+
+	// Appends every object whose bounds overlap box
+	void overlaps(const Aabb<T>& box, std::vector<u32>& out) const {
+		if (nodes_.empty()) return;
+		u32 stack[MAX_DEPTH];
+		usize top = 0;
+		stack[top++] = 0;
+		while (top > 0) {
+			const u32 index = stack[--top];
+			const Node& node = nodes_[index];
+			if (!node.bounds.overlaps(box)) continue;
+			if (node.count > 0) {
+				for (u32 i = node.offset; i < node.offset + node.count; ++i) {
+					if (leaf_bounds_[i].overlaps(box)) out.push_back(indices_[i]);
+				}
+			} else {
+				stack[top++] = node.offset;
+				stack[top++] = index + 1;
+				assert(top <= MAX_DEPTH);
+			}
+		}
+	}
+
+	// Replaces out with the k objects whose bounds are closest to point, nearest first
+	void nearest(const Vec3<T>& point, const usize k, std::vector<u32>& out) const {
+		out.clear();
+		if (nodes_.empty() || k == 0) return;
+
+		using Entry = std::pair<T, u32>;
+		std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+		std::vector<Entry> best;
+		best.reserve(k);
+		queue.push({ nodes_[0].bounds.distanceSquared(point), 0 });
+		while (!queue.empty()) {
+			const auto [distance, index] = queue.top();
+			queue.pop();
+			if (best.size() == k && distance > best.front().first) break;
+
+			const Node& node = nodes_[index];
+			if (node.count == 0) {
+				queue.push({ nodes_[index + 1].bounds.distanceSquared(point), index + 1 });
+				queue.push({ nodes_[node.offset].bounds.distanceSquared(point), node.offset });
+				continue;
+			}
+			for (u32 i = node.offset; i < node.offset + node.count; ++i) {
+				const T d = leaf_bounds_[i].distanceSquared(point);
+				if (best.size() < k) {
+					best.push_back({ d, indices_[i] });
+					std::push_heap(best.begin(), best.end());
+				} else if (d < best.front().first) {
+					std::pop_heap(best.begin(), best.end());
+					best.back() = { d, indices_[i] };
+					std::push_heap(best.begin(), best.end());
+				}
+			}
+		}
+		std::sort_heap(best.begin(), best.end());
+		for (const Entry& entry : best) out.push_back(entry.second);
+	}
+
+private:
+	std::vector<Node> nodes_;
+	std::vector<u32> indices_;
+	std::vector<Aabb<T>> leaf_bounds_;
+	T build_cost_ = 0;
+	u32 refits_ = 0;
+
+	u32 buildNode(const std::span<const Aabb<T>> bounds, const std::vector<Vec3<T>>& centers, const u32 begin, const u32 end, const u32 depth) {
+		const u32 index = (u32)nodes_.size();
+		nodes_.push_back({});
+
+		Aabb<T> box;
+		Aabb<T> center_box;
+		for (u32 i = begin; i < end; ++i) {
+			box.merge(bounds[indices_[i]]);
+			center_box.merge(centers[indices_[i]]);
+		}
+		nodes_[index] = { box, begin, end - begin };
+		if (end - begin <= MAX_LEAF_SIZE) return index;
+
+		const Vec3<T> extent = center_box.max - center_box.min;
+		const i32 axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : extent.y >= extent.z ? 1 : 2;
+		const T axis_min = center_box.min[axis];
+		const T axis_extent = extent[axis];
+		u32 mid = begin;
+		if (axis_extent > 0 && depth < SAH_DEPTH) {
+			struct Bin {
+				Aabb<T> bounds;
+				u32 count = 0;
+			};
+			Bin bins[BIN_COUNT]{};
+			const T scale = (T)BIN_COUNT / axis_extent;
+			auto binOf = [&](const u32 object) {
+				return std::min((u32)((centers[object][axis] - axis_min) * scale), BIN_COUNT - 1);
+			};
+			for (u32 i = begin; i < end; ++i) {
+				Bin& bin = bins[binOf(indices_[i])];
+				bin.bounds.merge(bounds[indices_[i]]);
+				++bin.count;
+			}
+
+			// Sweep from the right to get suffix costs, then from the left to pick the cheapest split
+			T right_cost[BIN_COUNT]{};
+			Aabb<T> right_box;
+			u32 right_count = 0;
+			for (u32 b = BIN_COUNT - 1; b > 0; --b) {
+				right_box.merge(bins[b].bounds);
+				right_count += bins[b].count;
+				right_cost[b] = right_count > 0 ? right_box.surfaceArea() * (T)right_count : 0;
+			}
+			T best_cost = std::numeric_limits<T>::max();
+			u32 best_split = 0;
+			Aabb<T> left_box;
+			u32 left_count = 0;
+			for (u32 b = 0; b + 1 < BIN_COUNT; ++b) {
+				left_box.merge(bins[b].bounds);
+				left_count += bins[b].count;
+				if (left_count == 0 || left_count == end - begin) continue;
+				const T split_cost = left_box.surfaceArea() * (T)left_count + right_cost[b + 1];
+				if (split_cost < best_cost) {
+					best_cost = split_cost;
+					best_split = b;
+				}
+			}
+
+			const T leaf_cost = box.surfaceArea() * (T)(end - begin);
+			if (best_cost >= leaf_cost && end - begin <= 4 * MAX_LEAF_SIZE) return index;
+			if (best_cost < std::numeric_limits<T>::max()) {
+				mid = (u32)(std::partition(indices_.begin() + begin, indices_.begin() + end, [&](const u32 object) {
+					return binOf(object) <= best_split;
+				}) - indices_.begin());
+			}
+		}
+		if (mid == begin || mid == end) {
+			// Coincident centers, a degenerate binning or too deep for SAH: fall back to a median split
+			mid = begin + (end - begin) / 2;
+			std::nth_element(indices_.begin() + begin, indices_.begin() + mid, indices_.begin() + end, [&](const u32 a, const u32 b) {
+				return centers[a][axis] < centers[b][axis];
+			});
+		}
+
+		nodes_[index].count = 0;
+		assert(depth + 1 < MAX_DEPTH);
+		buildNode(bounds, centers, begin, mid, depth + 1);
+		nodes_[index].offset = buildNode(bounds, centers, mid, end, depth + 1);
+		return index;
+	}
+};
+
+using Bvhf = Bvh<f32>;
+
+}
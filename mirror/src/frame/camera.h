@@ -5,16 +5,57 @@
 #include "vector.h"
 #include "complex.h"
 #include "quaternion.h"
+#include "frustum.h"
 
 namespace Mirror {
 
+template<typename T>
+struct Ray {
+	Vec3<T> origin{ 0 };
+	Vec3<T> direction{ 0, 0, 1 };
+};
+
+using Rayf = Ray<f32>;
+
+// Per-frame snapshot of a camera's matrices and their inverses, so repeated queries don't re-invert
+template<typename T>
+struct CameraMatrices {
+	Mat4<T> view{ 1 };
+	Mat4<T> projection{ 1 };
+	Mat4<T> view_projection{ 1 };
+	Mat4<T> inverse_view{ 1 };
+	Mat4<T> inverse_projection{ 1 };
+	Mat4<T> inverse_view_projection{ 1 };
+
+	[[nodiscard]] constexpr Frustum<T> frustum() const noexcept {
+		return Frustum<T>::fromMatrix(view_projection);
+	}
+
+	// Normalized device coordinates (Vulkan: x, y in [-1, 1], depth in [0, 1]) back to world space
+	[[nodiscard]] constexpr Vec3<T> unproject(const Vec3<T>& ndc) const noexcept {
+		const Vec4<T> p = inverse_view_projection * Vec4<T>{ ndc, 1 };
+		assert(p.w != 0);
+		return Vec3<T>{ p.x, p.y, p.z } / p.w;
+	}
+	// Pixel coordinates, origin top left, to world space at the given depth
+	[[nodiscard]] constexpr Vec3<T> screenToWorld(const Vec2<T>& screen, const Vec2<T>& screen_size, const T depth) const noexcept {
+		assert(screen_size.x > 0 && screen_size.y > 0);
+		return unproject({ 2 * screen.x / screen_size.x - 1, 2 * screen.y / screen_size.y - 1, depth });
+	}
+	[[nodiscard]] constexpr Ray<T> screenRay(const Vec2<T>& screen, const Vec2<T>& screen_size) const noexcept {
+		const Vec3<T> near_point = screenToWorld(screen, screen_size, 0);
+		const Vec3<T> far_point = screenToWorld(screen, screen_size, 1);
+		return { near_point, (far_point - near_point).normalized() };
+	}
+};
+
 template<typename T>
 struct Camera {
 	Vec3<T> position{ 0 };
 	Quaternion<T> rotation{ 1 };
 
 	[[nodiscard]] constexpr Mat4<T> view() const noexcept {
-		Mat4<T> rot{ rotation.conjugate() * Mat3<T>{ 1 } };
+		Mat4<T> rot{ rotation.conjugate().matrix() };
 		Mat4<T> pos{ 1 };
 		pos.w.x = -position.x;
 		pos.w.y = -position.y;
@@ -22,6 +63,23 @@ struct Camera {
 		return rot * pos;
 	}
 
+	// Camera to world, the inverse of view() built directly from position and rotation
+	[[nodiscard]] constexpr Mat4<T> world() const noexcept {
+		Mat4<T> m{ rotation.matrix() };
+		m.w = { position, 1 };
+		return m;
+	}
+	[[nodiscard]] constexpr CameraMatrices<T> matrices(const Mat4<T>& projection) const noexcept {
+		CameraMatrices<T> m;
+		m.view = view();
+		m.projection = projection;
+		m.view_projection = projection * m.view;
+		m.inverse_view = world();
+		m.inverse_projection = projection.inverted();
+		m.inverse_view_projection = m.inverse_view * m.inverse_projection;
+		return m;
+	}
+
 	constexpr void translate(const Vec3<T> delta) noexcept { position += delta; }
 	constexpr void move(const Vec3<T> dir, T distance) noexcept { 
 		Vec3<T> d = rotation * Vec3<T>{ dir.x, 0, dir.z };
@@ -54,5 +112,6 @@ struct Camera {
 };
 
 using Cameraf = Camera<f32>;
+using CameraMatricesf = CameraMatrices<f32>;
 
 }
@@ -1,19 +1,22 @@
 #pragma once
 
 #include "types.h"
+#include "stats.h"
 
 #include <chrono>
 
 namespace Mirror {
 
 struct Clock {
-	std::chrono::high_resolution_clock::time_point previous = std::chrono::high_resolution_clock::now();
+	std::chrono::steady_clock::time_point previous = std::chrono::steady_clock::now();
 	std::chrono::nanoseconds delta{ 0 };
+	FrameStats* stats = nullptr; // receives every delta when set
 
 	void update() noexcept {
-		auto now = std::chrono::high_resolution_clock::now();
+		auto now = std::chrono::steady_clock::now();
 		delta = now - previous;
 		previous = now;	
+		if (stats) stats->record(delta);
 	}
 
 	[[nodiscard]] constexpr f64 deltaSec() const noexcept {
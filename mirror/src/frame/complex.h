@@ -3,6 +3,7 @@
 #include "types.h"
 
 #include "vector.h"
+#include "matrix.h"
 
 namespace Mirror {
 
@@ -25,29 +26,31 @@ struct Complex {
 			std::sin(radians)
 		};
 	}
+	// Rotor as a 2x2 rotation (and uniform scale by abs()) matrix
+	[[nodiscard]] constexpr Mat2<T> matrix() const noexcept {
+		return { { r, i }, { -i, r } };
+	}
 	[[nodiscard]] constexpr Vec2<T> operator*(const Vec2<T>& v) const noexcept {
-		Complex vec{ v.x, v.y };
-		Complex result = *this * vec;
-		return { vec.r, vec.i };
+		return { r * v.x - i * v.y, i * v.x + r * v.y };
 	}
 	[[nodiscard]] constexpr Mat2<T> operator*(const Mat2<T>& v) const noexcept {
 		return { *this * v.x, *this * v.y };
 	}
 
 	[[nodiscard]] constexpr Complex operator+(const Complex& other) const noexcept {
-		return (r + other.r, i + other.i);
+		return { r + other.r, i + other.i };
 	}
 	[[nodiscard]] constexpr Complex operator-(const Complex& other) const noexcept {
-		return (r - other.r, i - other.i);
+		return { r - other.r, i - other.i };
 	}
 	[[nodiscard]] constexpr Complex operator*(const Complex& other) const noexcept {
-		return (r * other.r - i * other.i, r * other.i + i * other.r);
+		return { r * other.r - i * other.i, r * other.i + i * other.r };
 	}
 	[[nodiscard]] constexpr Complex operator/(const Complex& other) const noexcept {
 		assert(other.absSquared() != 0);
 		return {
 			(r * other.r + i * other.i) / (other.r * other.r + other.i * other.i),
-			(r * other.i - i * other.r) / (other.r * other.r + other.i * other.i)
+			(i * other.r - r * other.i) / (other.r * other.r + other.i * other.i)
 		};
 	}
 	[[nodiscard]] constexpr Complex operator-() const noexcept {
@@ -65,29 +68,26 @@ struct Complex {
 		return *this;
 	}
 	constexpr Complex& operator*=(const Complex& other) noexcept {
-		r = r * other.r - i * other.i;
-		i = r * other.i + i * other.r;
+		*this = *this * other;
 		return *this;
 	}
 	constexpr Complex& operator/=(const Complex& other) noexcept {
-		assert(other.absSquared() != 0);
-		r = (r * other.r + i * other.i) / (other.r * other.r + other.i * other.i);
-		i = (r * other.i - i * other.r) / (other.r * other.r + other.i * other.i);
+		*this = *this / other;
 		return *this;
 	}
 
 	[[nodiscard]] constexpr Complex operator+(const T scalar) const noexcept {
-		return (r + scalar, i);
+		return { r + scalar, i };
 	}
 	[[nodiscard]] constexpr Complex operator-(const T scalar) const noexcept {
-		return (r - scalar, i);
+		return { r - scalar, i };
 	}
 	[[nodiscard]] constexpr Complex operator*(const T scalar) const noexcept {
-		return (r * scalar, i * scalar);
+		return { r * scalar, i * scalar };
 	}
 	[[nodiscard]] constexpr Complex operator/(const T scalar) const noexcept {
 		assert(scalar != 0);
-		return (r / scalar, i / scalar);
+		return { r / scalar, i / scalar };
 	}
 
 	constexpr Complex& operator+=(const T scalar) noexcept {
@@ -143,7 +143,7 @@ struct Complex {
 		return *this;
 	}
 	[[nodiscard]] constexpr Complex conjugate() const noexcept {
-		return (r, -i);
+		return { r, -i };
 	}
 };
 
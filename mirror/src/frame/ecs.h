@@ -0,0 +1,608 @@
+#pragma once
+
+#include "types.h"
+#include "jobs.h"
+
+#include <array>
+#include <atomic>
+#include <limits>
+#include <map>
+#include <new>
+
+namespace Mirror {
+
+// Generational handle: index into the world's entity records, generation bumped whenever the index is reused
+struct Entity {
+	static constexpr u32 NONE = std::numeric_limits<u32>::max();
+
+	u32 index = NONE;
+	u32 generation = 0;
+
+	[[nodiscard]] constexpr bool valid() const noexcept { return index != NONE; }
+	[[nodiscard]] constexpr bool operator==(const Entity&) const noexcept = default;
+};
+
+// Type-erased operations on a component type, one static instance per type
+struct ComponentInfo {
+	static constexpr u32 MAX_COMPONENTS = 128;
+
+	u32 id;
+	u32 size;
+	u32 align;
+	void (*relocate)(void* destination, void* source) noexcept; // move-constructs destination, destroys source
+	void (*destroy)(void* component) noexcept;
+
+	template<typename T>
+	[[nodiscard]] static const ComponentInfo& of() noexcept {
+		static_assert(std::is_same_v<T, std::remove_cvref_t<T>>, "components are plain value types");
+		static_assert(std::is_nothrow_move_constructible_v<T> && alignof(T) <= 64);
+		static const ComponentInfo info{
+			nextId(), sizeof(T), alignof(T),
+			[](void* destination, void* source) noexcept {
+				T& from = *static_cast<T*>(source);
+				new (destination) T(std::move(from));
+				from.~T();
+			},
+			[](void* component) noexcept { static_cast<T*>(component)->~T(); },
+		};
+		return info;
+	}
+
+private:
+	[[nodiscard]] static u32 nextId() noexcept {
+		static std::atomic<u32> next{ 0 };
+		const u32 id = next.fetch_add(1, std::memory_order_relaxed);
+		assert(id < MAX_COMPONENTS && "raise ComponentInfo::MAX_COMPONENTS");
+		return id;
+	}
+};
+
+struct ComponentMask {
+	std::array<u64, ComponentInfo::MAX_COMPONENTS / 64> bits{};
+
+	void set(const u32 id) noexcept { bits[id / 64] |= u64{ 1 } << (id % 64); }
+	void reset(const u32 id) noexcept { bits[id / 64] &= ~(u64{ 1 } << (id % 64)); }
+	[[nodiscard]] bool test(const u32 id) const noexcept { return (bits[id / 64] >> (id % 64)) & 1; }
+	[[nodiscard]] bool contains(const ComponentMask& other) const noexcept {
+		for (usize n = 0; n < bits.size(); ++n) {
+			if ((bits[n] & other.bits[n]) != other.bits[n]) return false;
+		}
+		return true;
+	}
+	[[nodiscard]] auto operator<=>(const ComponentMask&) const noexcept = default;
+};
+
+class World;
+class CommandBuffer;
+
+// Entities with the same set of components share an archetype, stored in 16 KB chunks that hold an entity column and
+// one contiguous column per component (SoA), each column 64-byte aligned. Chunks stay dense: removing an entity moves
+// the archetype's last entity into the hole, so only the last chunk is partly filled.
+class Archetype {
+public:
+	static constexpr usize CHUNK_SIZE = 16 * 1024;
+	static constexpr u8 ABSENT = 0xFF;
+
+	[[nodiscard]] const ComponentMask& mask() const noexcept { return mask_; }
+	[[nodiscard]] u32 capacity() const noexcept { return capacity_; }
+	[[nodiscard]] usize size() const noexcept { return size_; }
+	[[nodiscard]] usize chunkCount() const noexcept { return chunks_.size(); }
+	[[nodiscard]] u32 chunkSize(const usize chunk) const noexcept { return chunks_[chunk].count; }
+
+	[[nodiscard]] Entity* entities(const usize chunk) const noexcept {
+		return reinterpret_cast<Entity*>(chunks_[chunk].data.get());
+	}
+	// Column of component id in the chunk, nullptr if the archetype doesn't have it
+	[[nodiscard]] void* column(const usize chunk, const u32 id) const noexcept {
+		const u8 column = columns_[id];
+		return column == ABSENT ? nullptr : chunks_[chunk].data.get() + offsets_[column];
+	}
+	template<typename T>
+	[[nodiscard]] T* column(const usize chunk) const noexcept {
+		return static_cast<T*>(column(chunk, ComponentInfo::of<std::remove_const_t<T>>().id));
+	}
+
+private:
+	friend class World;
+
+	struct ChunkDeleter {
+		void operator()(std::byte* data) const noexcept { ::operator delete[](data, std::align_val_t{ 64 }); }
+	};
+	struct Chunk {
+		std::unique_ptr<std::byte, ChunkDeleter> data;
+		u32 count = 0;
+	};
+	struct Location {
+		u32 chunk, row;
+	};
+
+	Archetype(const ComponentMask& mask, std::vector<const ComponentInfo*> components) : mask_(mask), components_(std::move(components)) {
+		columns_.fill(ABSENT);
+		usize per_entity = sizeof(Entity);
+		for (const ComponentInfo* info : components_) per_entity += info->size;
+		// Column starts are rounded up to 64 bytes, reserve the worst case
+		capacity_ = (u32)((CHUNK_SIZE - 64 * (components_.size() + 1)) / per_entity);
+		assert(capacity_ > 0 && "components too large for a chunk");
+		usize offset = sizeof(Entity) * capacity_;
+		for (usize n = 0; n < components_.size(); ++n) {
+			offset = (offset + 63) & ~usize{ 63 };
+			columns_[components_[n]->id] = (u8)n;
+			offsets_.push_back((u32)offset);
+			offset += components_[n]->size * capacity_;
+		}
+		assert(offset <= CHUNK_SIZE);
+	}
+
+	[[nodiscard]] void* at(const Location location, const usize column) const noexcept {
+		return chunks_[location.chunk].data.get() + offsets_[column] + (usize)components_[column]->size * location.row;
+	}
+	// Reserves a row at the end, components are left for the caller to construct
+	[[nodiscard]] Location push(const Entity entity) {
+		if (chunks_.empty() || chunks_.back().count == capacity_) {
+			chunks_.push_back({ std::unique_ptr<std::byte, ChunkDeleter>{ static_cast<std::byte*>(::operator new[](CHUNK_SIZE, std::align_val_t{ 64 })) }, 0 });
+		}
+		const Location location{ (u32)chunks_.size() - 1, chunks_.back().count++ };
+		entities(location.chunk)[location.row] = entity;
+		++size_;
+		return location;
+	}
+	// Fills a row whose components were already moved out or destroyed with the last row; returns the entity that
+	// moved into it, or an invalid one if the row was the last
+	Entity erase(const Location location) noexcept {
+		const Location last{ (u32)chunks_.size() - 1, chunks_.back().count - 1 };
+		Entity moved{};
+		if (last.chunk != location.chunk || last.row != location.row) {
+			for (usize column = 0; column < components_.size(); ++column) components_[column]->relocate(at(location, column), at(last, column));
+			moved = entities(last.chunk)[last.row];
+			entities(location.chunk)[location.row] = moved;
+		}
+		--size_;
+		if (--chunks_.back().count == 0) chunks_.pop_back();
+		return moved;
+	}
+
+	ComponentMask mask_;
+	std::vector<const ComponentInfo*> components_; // by id
+	std::array<u8, ComponentInfo::MAX_COMPONENTS> columns_{};
+	std::vector<u32> offsets_;
+	u32 capacity_ = 0;
+	std::vector<Chunk> chunks_;
+	usize size_ = 0;
+	// Archetype reached by adding or removing one component, filled in as they're used
+	std::vector<std::pair<u32, u32>> add_edges_;
+	std::vector<std::pair<u32, u32>> remove_edges_;
+};
+
+// Records structural changes (create, destroy, add, remove) for World::apply() to play back in order, so systems can
+// request them while iterating, one buffer per thread. Operations on entities that are dead by then are skipped.
+class CommandBuffer {
+public:
+	CommandBuffer() = default;
+	~CommandBuffer() { clear(); }
+
+	CommandBuffer(const CommandBuffer&) = delete;
+	CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+	template<typename... Ts>
+	void create(Ts&&... components) {
+		commands_.push_back({ Op::CREATE, {}, nullptr, nullptr, (u32)sizeof...(Ts) });
+		(commands_.push_back({ Op::ADD, {}, &ComponentInfo::of<std::remove_cvref_t<Ts>>(), store(std::forward<Ts>(components)), 0 }), ...);
+	}
+	void destroy(const Entity entity) {
+		commands_.push_back({ Op::DESTROY, entity, nullptr, nullptr, 0 });
+	}
+	template<typename T>
+	void add(const Entity entity, T&& component) {
+		commands_.push_back({ Op::ADD, entity, &ComponentInfo::of<std::remove_cvref_t<T>>(), store(std::forward<T>(component)), 0 });
+	}
+	template<typename T>
+	void remove(const Entity entity) {
+		commands_.push_back({ Op::REMOVE, entity, &ComponentInfo::of<T>(), nullptr, 0 });
+	}
+
+	[[nodiscard]] bool empty() const noexcept { return commands_.empty(); }
+	[[nodiscard]] usize size() const noexcept { return commands_.size(); }
+
+	// Drops everything not yet applied; keeps the memory
+	void clear() noexcept {
+		for (Command& command : commands_) {
+			if (command.payload != nullptr) command.info->destroy(command.payload);
+		}
+		commands_.clear();
+		block_ = 0;
+		used_ = 0;
+	}
+
+private:
+	friend class World;
+
+	static constexpr usize BLOCK_SIZE = 16 * 1024;
+
+	enum class Op : u8 { CREATE, DESTROY, ADD, REMOVE };
+	struct Command {
+		Op op;
+		Entity entity; // invalid for the components following a CREATE
+		const ComponentInfo* info;
+		void* payload; // moved-in component, owned until applied
+		u32 count; // components following a CREATE
+	};
+
+	// Payloads live in fixed blocks that never move, so components don't have to be trivially relocatable
+	template<typename T>
+	[[nodiscard]] void* store(T&& component) {
+		using V = std::remove_cvref_t<T>;
+		static_assert(sizeof(V) <= BLOCK_SIZE);
+		used_ = (used_ + alignof(V) - 1) & ~(alignof(V) - 1);
+		if (blocks_.empty() || used_ + sizeof(V) > BLOCK_SIZE) {
+			if (!blocks_.empty()) ++block_;
+			if (block_ == blocks_.size()) {
+				blocks_.push_back(std::unique_ptr<std::byte, BlockDeleter>{ static_cast<std::byte*>(::operator new[](BLOCK_SIZE, std::align_val_t{ 64 })) });
+			}
+			used_ = 0;
+		}
+		void* payload = blocks_[block_].get() + used_;
+		new (payload) V(std::forward<T>(component));
+		used_ += sizeof(V);
+		return payload;
+	}
+
+	struct BlockDeleter {
+		void operator()(std::byte* data) const noexcept { ::operator delete[](data, std::align_val_t{ 64 }); }
+	};
+
+	std::vector<Command> commands_;
+	std::vector<std::unique_ptr<std::byte, BlockDeleter>> blocks_;
+	usize block_ = 0;
+	usize used_ = 0;
+};
+
+// Cached view of the archetypes holding every component in Ts. Archetypes created after the query are picked up
+// on the next iteration. Iterate with each() per entity, eachChunk() per chunk with one span per column, or
+// parallelEach() to spread chunks over a JobSystem. Components may be const to document read-only access.
+// Structural changes during iteration are not allowed; record them in a CommandBuffer.
+template<typename... Ts>
+class Query {
+public:
+	explicit Query(World& world) noexcept : world_(world) {
+		(mask_.set(ComponentInfo::of<std::remove_const_t<Ts>>().id), ...);
+	}
+
+	// fn(Entity, Ts&...) or fn(Ts&...) for every matching entity
+	template<typename Fn>
+	void each(Fn&& fn) {
+		eachChunk([&](const std::span<const Entity> entities, const std::span<Ts>... columns) {
+			for (usize n = 0; n < entities.size(); ++n) call(fn, entities[n], columns[n]...);
+		});
+	}
+	// fn(std::span<const Entity>, std::span<Ts>...) for every matching chunk
+	template<typename Fn>
+	void eachChunk(Fn&& fn) {
+		refresh();
+		for (const Archetype* archetype : archetypes_) {
+			for (usize chunk = 0; chunk < archetype->chunkCount(); ++chunk) callChunk(fn, *archetype, chunk);
+		}
+	}
+	// each() with chunks spread over jobs; fn runs concurrently and must only touch its own entities
+	template<typename Fn>
+	void parallelEach(Fn&& fn, JobSystem& jobs = JobSystem::instance()) {
+		parallelEachChunk([&](const std::span<const Entity> entities, const std::span<Ts>... columns) {
+			for (usize n = 0; n < entities.size(); ++n) call(fn, entities[n], columns[n]...);
+		}, jobs);
+	}
+	template<typename Fn>
+	void parallelEachChunk(Fn&& fn, JobSystem& jobs = JobSystem::instance()) {
+		refresh();
+		chunks_.clear();
+		for (const Archetype* archetype : archetypes_) {
+			for (usize chunk = 0; chunk < archetype->chunkCount(); ++chunk) chunks_.push_back({ archetype, (u32)chunk });
+		}
+		jobs.parallelFor(chunks_.size(), 1, [&](const usize begin, const usize end) {
+			for (usize n = begin; n < end; ++n) callChunk(fn, *chunks_[n].first, chunks_[n].second);
+		});
+	}
+
+	// Matching entities
+	[[nodiscard]] usize size() {
+		refresh();
+		usize size = 0;
+		for (const Archetype* archetype : archetypes_) size += archetype->size();
+		return size;
+	}
+
+private:
+	void refresh();
+
+	template<typename Fn>
+	static void call(Fn& fn, const Entity entity, Ts&... components) {
+		if constexpr (std::is_invocable_v<Fn&, Entity, Ts&...>) fn(entity, components...);
+		else fn(components...);
+	}
+	template<typename Fn>
+	void callChunk(Fn& fn, const Archetype& archetype, const usize chunk);
+
+	World& world_;
+	ComponentMask mask_;
+	std::vector<const Archetype*> archetypes_;
+	usize seen_ = 0;
+	std::vector<std::pair<const Archetype*, u32>> chunks_;
+};
+
+// Owns entities and their components in archetype chunks. Iterating a component touches only its column, so a
+// linear pass over a million transforms streams contiguous memory instead of chasing one heap object per entity.
+class World {
+public:
+	World() {
+		archetypes_.push_back(std::unique_ptr<Archetype>{ new Archetype({}, {}) });
+		masks_[{}] = 0;
+	}
+	~World() {
+		for (const std::unique_ptr<Archetype>& archetype : archetypes_) {
+			for (usize chunk = 0; chunk < archetype->chunkCount(); ++chunk) {
+				for (usize column = 0; column < archetype->components_.size(); ++column) {
+					for (u32 row = 0; row < archetype->chunkSize(chunk); ++row) archetype->components_[column]->destroy(archetype->at({ (u32)chunk, row }, column));
+				}
+			}
+		}
+	}
+
+	World(const World&) = delete;
+	World& operator=(const World&) = delete;
+
+	template<typename... Ts>
+	Entity create(Ts&&... components) {
+		assertNotIterating();
+		std::array<const ComponentInfo*, sizeof...(Ts)> infos{ &info<std::remove_cvref_t<Ts>>()... };
+		ComponentMask mask;
+		for (const ComponentInfo* component : infos) {
+			assert(!mask.test(component->id) && "duplicate component");
+			mask.set(component->id);
+		}
+		const u32 index = archetypeFor(mask);
+		Archetype& archetype = *archetypes_[index];
+		const Entity entity = allocateEntity();
+		const Archetype::Location location = archetype.push(entity);
+		(new (archetype.at(location, archetype.columns_[ComponentInfo::of<std::remove_cvref_t<Ts>>().id])) std::remove_cvref_t<Ts>(std::forward<Ts>(components)), ...);
+		records_[entity.index] = { index, location };
+		return entity;
+	}
+
+	void destroy(const Entity entity) {
+		assertNotIterating();
+		if (!alive(entity)) return;
+		Record& record = records_[entity.index];
+		Archetype& archetype = *archetypes_[record.archetype];
+		for (usize column = 0; column < archetype.components_.size(); ++column) archetype.components_[column]->destroy(archetype.at(record.location, column));
+		fixMoved(archetype.erase(record.location), record);
+		record.archetype = Entity::NONE;
+		++generations_[entity.index];
+		free_.push_back(entity.index);
+		--size_;
+	}
+
+	[[nodiscard]] bool alive(const Entity entity) const noexcept {
+		return entity.index < records_.size() && generations_[entity.index] == entity.generation && records_[entity.index].archetype != Entity::NONE;
+	}
+
+	template<typename T>
+	[[nodiscard]] bool has(const Entity entity) const noexcept {
+		return alive(entity) && archetypes_[records_[entity.index].archetype]->mask_.test(ComponentInfo::of<T>().id);
+	}
+	// nullptr when the entity is dead or lacks the component; invalidated by structural changes
+	template<typename T>
+	[[nodiscard]] T* get(const Entity entity) noexcept {
+		if (!alive(entity)) return nullptr;
+		const Record& record = records_[entity.index];
+		const Archetype& archetype = *archetypes_[record.archetype];
+		const u8 column = archetype.columns_[ComponentInfo::of<T>().id];
+		return column == Archetype::ABSENT ? nullptr : static_cast<T*>(archetype.at(record.location, column));
+	}
+
+	// Adds the component, or assigns it when the entity already has one
+	template<typename T>
+	T& add(const Entity entity, T&& component) {
+		using V = std::remove_cvref_t<T>;
+		assert(alive(entity));
+		if (V* existing = get<V>(entity)) return *existing = std::forward<T>(component);
+		// Built in raw storage: addErased() relocates it, which also destroys it
+		alignas(V) std::byte storage[sizeof(V)];
+		V* const value = ::new (storage) V{ std::forward<T>(component) };
+		return *static_cast<V*>(addErased(entity, info<V>(), value));
+	}
+	template<typename T>
+	void remove(const Entity entity) {
+		assertNotIterating();
+		if (!has<T>(entity)) return;
+		move(entity, removeEdge(records_[entity.index].archetype, ComponentInfo::of<T>()), nullptr);
+	}
+
+	template<typename... Ts>
+	[[nodiscard]] Query<Ts...> query() {
+		return Query<Ts...>{ *this };
+	}
+
+	// Plays back and clears the buffer
+	void apply(CommandBuffer& commands) {
+		std::vector<CommandBuffer::Command>& list = commands.commands_;
+		for (usize n = 0; n < list.size(); ++n) {
+			CommandBuffer::Command& command = list[n];
+			switch (command.op) {
+				case CommandBuffer::Op::CREATE:
+					createErased({ list.data() + n + 1, command.count });
+					n += command.count;
+					break;
+				case CommandBuffer::Op::DESTROY:
+					destroy(command.entity);
+					break;
+				case CommandBuffer::Op::ADD:
+					if (alive(command.entity)) {
+						addErased(command.entity, registered(*command.info), command.payload);
+					} else {
+						command.info->destroy(command.payload);
+					}
+					command.payload = nullptr;
+					break;
+				case CommandBuffer::Op::REMOVE:
+					if (alive(command.entity) && archetypes_[records_[command.entity.index].archetype]->mask_.test(command.info->id)) {
+						move(command.entity, removeEdge(records_[command.entity.index].archetype, *command.info), nullptr);
+					}
+					break;
+			}
+		}
+		commands.clear();
+	}
+
+	[[nodiscard]] usize size() const noexcept { return size_; }
+	[[nodiscard]] usize archetypeCount() const noexcept { return archetypes_.size(); }
+	[[nodiscard]] const Archetype& archetype(const usize index) const noexcept { return *archetypes_[index]; }
+
+private:
+	template<typename...>
+	friend class Query;
+
+	struct Record {
+		u32 archetype = Entity::NONE;
+		Archetype::Location location{};
+	};
+
+	template<typename T>
+	[[nodiscard]] const ComponentInfo& info() noexcept {
+		return registered(ComponentInfo::of<T>());
+	}
+	[[nodiscard]] const ComponentInfo& registered(const ComponentInfo& component) noexcept {
+		infos_[component.id] = &component;
+		return component;
+	}
+
+	void assertNotIterating() const noexcept {
+		assert(iterating_.load(std::memory_order_relaxed) == 0 && "structural change during iteration, use a CommandBuffer");
+	}
+
+	[[nodiscard]] Entity allocateEntity() {
+		++size_;
+		if (!free_.empty()) {
+			const u32 index = free_.back();
+			free_.pop_back();
+			return { index, generations_[index] };
+		}
+		records_.emplace_back();
+		generations_.push_back(0);
+		return { (u32)records_.size() - 1, 0 };
+	}
+
+	[[nodiscard]] u32 archetypeFor(const ComponentMask& mask) {
+		if (const auto it = masks_.find(mask); it != masks_.end()) return it->second;
+		std::vector<const ComponentInfo*> components;
+		for (u32 id = 0; id < ComponentInfo::MAX_COMPONENTS; ++id) {
+			if (mask.test(id)) components.push_back(infos_[id]);
+		}
+		archetypes_.push_back(std::unique_ptr<Archetype>{ new Archetype(mask, std::move(components)) });
+		masks_[mask] = (u32)archetypes_.size() - 1;
+		return (u32)archetypes_.size() - 1;
+	}
+	[[nodiscard]] u32 addEdge(const u32 from, const ComponentInfo& component) {
+		for (const auto& [id, to] : archetypes_[from]->add_edges_) {
+			if (id == component.id) return to;
+		}
+		ComponentMask mask = archetypes_[from]->mask_;
+		mask.set(component.id);
+		const u32 to = archetypeFor(mask);
+		archetypes_[from]->add_edges_.push_back({ component.id, to });
+		return to;
+	}
+	[[nodiscard]] u32 removeEdge(const u32 from, const ComponentInfo& component) {
+		for (const auto& [id, to] : archetypes_[from]->remove_edges_) {
+			if (id == component.id) return to;
+		}
+		ComponentMask mask = archetypes_[from]->mask_;
+		mask.reset(component.id);
+		const u32 to = archetypeFor(mask);
+		archetypes_[from]->remove_edges_.push_back({ component.id, to });
+		return to;
+	}
+
+	// Moves the entity to another archetype, relocating shared components and added from the payload; components the
+	// target lacks are destroyed. Returns the added component.
+	void* move(const Entity entity, const u32 to, void* added) {
+		Record& record = records_[entity.index];
+		Archetype& source = *archetypes_[record.archetype];
+		Archetype& target = *archetypes_[to];
+		const Archetype::Location location = target.push(entity);
+		void* result = nullptr;
+		for (usize column = 0; column < target.components_.size(); ++column) {
+			const ComponentInfo& component = *target.components_[column];
+			const u8 from = source.columns_[component.id];
+			if (from != Archetype::ABSENT) {
+				component.relocate(target.at(location, column), source.at(record.location, from));
+			} else {
+				component.relocate(target.at(location, column), added);
+				result = target.at(location, column);
+			}
+		}
+		for (usize column = 0; column < source.components_.size(); ++column) {
+			if (!target.mask_.test(source.components_[column]->id)) source.components_[column]->destroy(source.at(record.location, column));
+		}
+		fixMoved(source.erase(record.location), record);
+		record = { to, location };
+		return result;
+	}
+	void* addErased(const Entity entity, const ComponentInfo& component, void* payload) {
+		assertNotIterating();
+		const u32 from = records_[entity.index].archetype;
+		if (archetypes_[from]->mask_.test(component.id)) {
+			// Already present: replace in place
+			const Archetype& archetype = *archetypes_[from];
+			void* existing = archetype.at(records_[entity.index].location, archetype.columns_[component.id]);
+			component.destroy(existing);
+			component.relocate(existing, payload);
+			return existing;
+		}
+		return move(entity, addEdge(from, component), payload);
+	}
+	void createErased(const std::span<CommandBuffer::Command> components) {
+		ComponentMask mask;
+		for (const CommandBuffer::Command& command : components) mask.set(registered(*command.info).id);
+		const u32 index = archetypeFor(mask);
+		Archetype& archetype = *archetypes_[index];
+		const Entity entity = allocateEntity();
+		const Archetype::Location location = archetype.push(entity);
+		for (CommandBuffer::Command& command : components) {
+			command.info->relocate(archetype.at(location, archetype.columns_[command.info->id]), command.payload);
+			command.payload = nullptr;
+		}
+		records_[entity.index] = { index, location };
+	}
+
+	// The entity that filled an erased row now lives at the erased location
+	void fixMoved(const Entity moved, const Record& erased) noexcept {
+		if (moved.valid()) records_[moved.index].location = erased.location;
+	}
+
+	std::vector<std::unique_ptr<Archetype>> archetypes_; // append-only, queries remember how many they've seen
+	std::map<ComponentMask, u32> masks_;
+	std::array<const ComponentInfo*, ComponentInfo::MAX_COMPONENTS> infos_{};
+
+	std::vector<Record> records_; // by entity index
+	std::vector<u32> generations_;
+	std::vector<u32> free_;
+	usize size_ = 0;
+	std::atomic<u32> iterating_{ 0 };
+};
+
+template<typename... Ts>
+void Query<Ts...>::refresh() {
+	for (; seen_ < world_.archetypes_.size(); ++seen_) {
+		const Archetype* archetype = world_.archetypes_[seen_].get();
+		if (archetype->mask().contains(mask_)) archetypes_.push_back(archetype);
+	}
+}
+
+template<typename... Ts>
+template<typename Fn>
+void Query<Ts...>::callChunk(Fn& fn, const Archetype& archetype, const usize chunk) {
+	const usize count = archetype.chunkSize(chunk);
+	world_.iterating_.fetch_add(1, std::memory_order_relaxed);
+	fn(std::span<const Entity>{ archetype.entities(chunk), count }, std::span<Ts>{ archetype.template column<Ts>(chunk), count }...);
+	world_.iterating_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+}
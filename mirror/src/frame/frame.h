@@ -9,13 +9,35 @@
 #include <expected>
 #include <memory>
 #include <cstdint>
+#include <cmath>
+#include <type_traits>
+#include <thread>
+#include <bit>
+#include <cstring>
+#include <functional>
+#include <exception>
 
 #include "types.h"
+#include "simd.h"
+#include "memory.h"
+#include "jobs.h"
+#include "parallel.h"
+#include "triple_buffer.h"
+#include "systems.h"
+#include "ecs.h"
 #include "timer.h"
+#include "profiler.h"
+#include "perf.h"
+#include "stats.h"
 #include "clock.h"
+#include "scheduler.h"
 #include "vector.h"
 #include "matrix.h"
 #include "complex.h"
 #include "quaternion.h"
 #include "transform.h"
+#include "hierarchy.h"
+#include "packing.h"
+#include "frustum.h"
 #include "camera.h"
+#include "bvh.h"
@@ -0,0 +1,177 @@
+#pragma once
+
+#include "types.h"
+#include "simd.h"
+#include "parallel.h"
+#include "memory.h"
+#include "matrix.h"
+#include "vector.h"
+
+namespace Mirror {
+
+// Structure-of-arrays bounds, all spans of one object count
+struct BoundingSpheres {
+	std::span<const f32> x, y, z;
+	std::span<const f32> radius;
+
+	[[nodiscard]] usize size() const noexcept { return x.size(); }
+};
+
+struct BoundingBoxes {
+	std::span<const f32> min_x, min_y, min_z;
+	std::span<const f32> max_x, max_y, max_z;
+
+	[[nodiscard]] usize size() const noexcept { return min_x.size(); }
+};
+
+template<typename T>
+struct Frustum {
+	// xyz is the inward unit normal, w the offset: a point p is inside when dot(xyz, p) + w >= 0
+	Vec4<T> planes[6];
+
+	// Gribb-Hartmann extraction for Vulkan clip space: -w <= x, y <= w and 0 <= z <= w
+	[[nodiscard]] constexpr static Frustum fromMatrix(const Mat4<T>& view_projection) noexcept {
+		const Vec4<T> r0 = view_projection.row(0);
+		const Vec4<T> r1 = view_projection.row(1);
+		const Vec4<T> r2 = view_projection.row(2);
+		const Vec4<T> r3 = view_projection.row(3);
+		Frustum frustum{ { r3 + r0, r3 - r0, r3 + r1, r3 - r1, r2, r3 - r2 } };
+		for (Vec4<T>& plane : frustum.planes) {
+			const T length = Vec3<T>{ plane.x, plane.y, plane.z }.length();
+			assert(length != 0);
+			plane /= length;
+		}
+		return frustum;
+	}
+
+	[[nodiscard]] constexpr bool containsSphere(const Vec3<T>& center, const T radius) const noexcept {
+		for (const Vec4<T>& plane : planes) {
+			if (plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w < -radius) return false;
+		}
+		return true;
+	}
+	[[nodiscard]] constexpr bool intersectsBox(const Vec3<T>& min, const Vec3<T>& max) const noexcept {
+		const Vec3<T> center = (min + max) / 2;
+		const Vec3<T> extent = (max - min) / 2;
+		for (const Vec4<T>& plane : planes) {
+			const T reach = std::abs(plane.x) * extent.x + std::abs(plane.y) * extent.y + std::abs(plane.z) * extent.z;
+			if (plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w < -reach) return false;
+		}
+		return true;
+	}
+
+	// Writes the indices of potentially visible objects to the front of visible and returns how many there are.
+	// visible must hold one index per object; chunks are culled in parallel when thread_count > 1.
+	usize cullSpheres(const BoundingSpheres& spheres, const std::span<u32> visible, const usize thread_count = 1) const noexcept requires std::is_same_v<T, f32> {
+		assert(spheres.y.size() == spheres.size() && spheres.z.size() == spheres.size() && spheres.radius.size() == spheres.size());
+		return split(spheres.size(), visible, thread_count, [&](const usize begin, const usize end, u32* out) {
+			return cullSpheresRange(spheres, begin, end, out);
+		});
+	}
+	usize cullBoxes(const BoundingBoxes& boxes, const std::span<u32> visible, const usize thread_count = 1) const noexcept requires std::is_same_v<T, f32> {
+		assert(boxes.min_y.size() == boxes.size() && boxes.min_z.size() == boxes.size());
+		assert(boxes.max_x.size() == boxes.size() && boxes.max_y.size() == boxes.size() && boxes.max_z.size() == boxes.size());
+		return split(boxes.size(), visible, thread_count, [&](const usize begin, const usize end, u32* out) {
+			return cullBoxesRange(boxes, begin, end, out);
+		});
+	}
+
+private:
+	template<typename Cull>
+	static usize split(const usize count, const std::span<u32> visible, const usize thread_count, const Cull& cull) noexcept {
+		assert(visible.size() >= count);
+
+		// Each chunk compacts into its own slice of visible, then the slices are packed together in order
+		ScratchScope scratch;
+		ArenaVector<usize> counts(std::max<usize>(thread_count, 1), scratch.arena());
+		usize chunk_size = count;
+		const usize chunks = parallelChunks(count, thread_count, 16384, [&](const usize chunk, const usize begin, const usize end) {
+			if (chunk == 0) chunk_size = end;
+			counts[chunk] = cull(begin, end, visible.data() + begin);
+		});
+		usize total = counts[0];
+		for (usize chunk = 1; chunk < chunks; ++chunk) {
+			std::copy_n(visible.data() + chunk * chunk_size, counts[chunk], visible.data() + total);
+			total += counts[chunk];
+		}
+		return total;
+	}
+
+	// Appends the set lanes of an 8-bit visibility mask as indices
+	static u32* compact(u32 bits, const u32 base, u32* out) noexcept {
+		while (bits != 0) {
+			*out++ = base + (u32)std::countr_zero(bits);
+			bits &= bits - 1;
+		}
+		return out;
+	}
+
+	usize cullSpheresRange(const BoundingSpheres& spheres, const usize begin, const usize end, u32* out) const noexcept {
+		using namespace Simd;
+		u32* const start = out;
+		usize n = begin;
+		for (; n + 8 <= end; n += 8) {
+			const F32x8 x = load8(&spheres.x[n]);
+			const F32x8 y = load8(&spheres.y[n]);
+			const F32x8 z = load8(&spheres.z[n]);
+			const F32x8 neg_radius = sub(splat8(0), load8(&spheres.radius[n]));
+			F32x8 outside = splat8(0);
+			for (const Vec4<T>& plane : planes) {
+				const F32x8 distance = add(
+					add(mul(splat8(plane.x), x), mul(splat8(plane.y), y)),
+					add(mul(splat8(plane.z), z), splat8(plane.w))
+				);
+				outside = bitOr(outside, less(distance, neg_radius));
+			}
+			out = compact(~mask(outside) & 0xFF, (u32)n, out);
+		}
+		for (; n < end; ++n) {
+			if (containsSphere({ spheres.x[n], spheres.y[n], spheres.z[n] }, spheres.radius[n])) *out++ = (u32)n;
+		}
+		return (usize)(out - start);
+	}
+
+	usize cullBoxesRange(const BoundingBoxes& boxes, const usize begin, const usize end, u32* out) const noexcept {
+		using namespace Simd;
+		u32* const start = out;
+		usize n = begin;
+		const F32x8 half = splat8(0.5f);
+		for (; n + 8 <= end; n += 8) {
+			const F32x8 min_x = load8(&boxes.min_x[n]);
+			const F32x8 min_y = load8(&boxes.min_y[n]);
+			const F32x8 min_z = load8(&boxes.min_z[n]);
+			const F32x8 max_x = load8(&boxes.max_x[n]);
+			const F32x8 max_y = load8(&boxes.max_y[n]);
+			const F32x8 max_z = load8(&boxes.max_z[n]);
+			const F32x8 center_x = mul(add(min_x, max_x), half);
+			const F32x8 center_y = mul(add(min_y, max_y), half);
+			const F32x8 center_z = mul(add(min_z, max_z), half);
+			const F32x8 extent_x = mul(sub(max_x, min_x), half);
+			const F32x8 extent_y = mul(sub(max_y, min_y), half);
+			const F32x8 extent_z = mul(sub(max_z, min_z), half);
+			F32x8 outside = splat8(0);
+			for (const Vec4<T>& plane : planes) {
+				const F32x8 distance = add(
+					add(mul(splat8(plane.x), center_x), mul(splat8(plane.y), center_y)),
+					add(mul(splat8(plane.z), center_z), splat8(plane.w))
+				);
+				const F32x8 reach = add(
+					add(mul(splat8(std::abs(plane.x)), extent_x), mul(splat8(std::abs(plane.y)), extent_y)),
+					mul(splat8(std::abs(plane.z)), extent_z)
+				);
+				outside = bitOr(outside, less(add(distance, reach), splat8(0)));
+			}
+			out = compact(~mask(outside) & 0xFF, (u32)n, out);
+		}
+		for (; n < end; ++n) {
+			const Vec3<T> min{ boxes.min_x[n], boxes.min_y[n], boxes.min_z[n] };
+			const Vec3<T> max{ boxes.max_x[n], boxes.max_y[n], boxes.max_z[n] };
+			if (intersectsBox(min, max)) *out++ = (u32)n;
+		}
+		return (usize)(out - start);
+	}
+};
+
+using Frustumf = Frustum<f32>;
+
+}
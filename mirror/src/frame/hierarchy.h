@@ -0,0 +1,275 @@
+#pragma once
+
+#include "types.h"
+#include "parallel.h"
+#include "memory.h"
+#include "matrix.h"
+#include "transform.h"
+
+#include <limits>
+
+namespace Mirror {
+
+// Parent/child transforms stored as flat arrays in depth-first order, so every subtree is one contiguous range
+// that follows its root. Nodes are addressed by stable ids; their array index changes when the structure does.
+//
+// update() only recomputes the subtrees under nodes whose local transform changed since the last update, using the
+// batched Transform3D::matrices() path, and spreads independent subtrees over threads. Structural changes (add,
+// remove, setParent) re-sort the arrays and recompute every world matrix on the next update.
+template<typename T>
+class Hierarchy {
+public:
+	static constexpr u32 NONE = std::numeric_limits<u32>::max();
+
+	u32 add(const Transform3D<T>& local, const u32 parent = NONE) {
+		assert(parent == NONE || contains(parent));
+		u32 id;
+		if (free_ids_.empty()) {
+			id = (u32)indices_.size();
+			indices_.push_back(NONE);
+			marked_.push_back(0);
+		} else {
+			id = free_ids_.back();
+			free_ids_.pop_back();
+		}
+		indices_[id] = (u32)ids_.size();
+		ids_.push_back(id);
+		parents_.push_back(parent == NONE ? NONE : indices_[parent]);
+		sizes_.push_back(1);
+		positions_.push_back(local.position);
+		scales_.push_back(local.scale);
+		rotations_.push_back(local.rotation);
+		worlds_.push_back(local.matrix());
+		layout_dirty_ = true;
+		return id;
+	}
+	// Removes the node and everything below it
+	void remove(const u32 id) {
+		assert(contains(id));
+		parents_[indices_[id]] = REMOVED;
+		layout_dirty_ = true;
+	}
+	// Returns false and changes nothing if parent is id itself or below it, which would make a cycle
+	bool setParent(const u32 id, const u32 parent) {
+		assert(contains(id) && (parent == NONE || contains(parent)));
+		for (u32 ancestor = parent; ancestor != NONE; ancestor = this->parent(ancestor)) {
+			if (ancestor == id) return false;
+		}
+		parents_[indices_[id]] = parent == NONE ? NONE : indices_[parent];
+		layout_dirty_ = true;
+		return true;
+	}
+
+	[[nodiscard]] bool contains(const u32 id) const noexcept {
+		return id < indices_.size() && indices_[id] != NONE && parents_[indices_[id]] != REMOVED;
+	}
+	[[nodiscard]] u32 parent(const u32 id) const noexcept {
+		assert(contains(id));
+		const u32 index = parents_[indices_[id]];
+		return index == NONE ? NONE : ids_[index];
+	}
+	[[nodiscard]] Transform3D<T> local(const u32 id) const noexcept {
+		assert(contains(id));
+		const u32 index = indices_[id];
+		return { positions_[index], scales_[index], rotations_[index] };
+	}
+	// World matrix as of the last update()
+	[[nodiscard]] const Mat4<T>& world(const u32 id) const noexcept {
+		assert(contains(id));
+		return worlds_[indices_[id]];
+	}
+
+	void setLocal(const u32 id, const Transform3D<T>& local) noexcept {
+		const u32 index = mark(id);
+		positions_[index] = local.position;
+		scales_[index] = local.scale;
+		rotations_[index] = local.rotation;
+	}
+	void setPosition(const u32 id, const Vec3<T>& position) noexcept {
+		positions_[mark(id)] = position;
+	}
+	void setScale(const u32 id, const Vec3<T>& scale) noexcept {
+		scales_[mark(id)] = scale;
+	}
+	void setRotation(const u32 id, const Quaternion<T>& rotation) noexcept {
+		rotations_[mark(id)] = rotation;
+	}
+
+	// Brings world matrices up to date, returns the number of nodes recomputed
+	usize update(const usize thread_count = 1) {
+		ranges_.clear();
+		if (layout_dirty_) {
+			relayout();
+			for (u32 index = 0; index < ids_.size(); index += sizes_[index]) ranges_.push_back({ index, index + sizes_[index] });
+		} else {
+			// A dirty node's subtree covers every dirty node inside it, so sorted indices merge into disjoint ranges
+			std::vector<u32>& dirty = dirty_indices_;
+			dirty.clear();
+			for (const u32 id : dirty_) {
+				if (contains(id)) dirty.push_back(indices_[id]);
+			}
+			std::ranges::sort(dirty);
+			for (const u32 index : dirty) {
+				if (!ranges_.empty() && index < ranges_.back().end) continue;
+				ranges_.push_back({ index, index + sizes_[index] });
+			}
+		}
+		for (const u32 id : dirty_) {
+			if (id < marked_.size()) marked_[id] = 0;
+		}
+		dirty_.clear();
+
+		usize total = 0;
+		for (const Range& range : ranges_) total += range.end - range.begin;
+		if (ranges_.size() == 1 || thread_count <= 1 || total < PARALLEL_MIN_NODES) {
+			for (const Range& range : ranges_) updateRange(range, ranges_.size() == 1 ? thread_count : 1);
+			return total;
+		}
+
+		// Ranges don't depend on each other, split them into groups of roughly equal node counts
+		const usize group_count = std::min(thread_count, ranges_.size());
+		ScratchScope scratch;
+		ArenaVector<usize> group_ends(scratch.arena());
+		group_ends.reserve(group_count);
+		usize accumulated = 0;
+		for (usize n = 0; n < ranges_.size(); ++n) {
+			accumulated += ranges_[n].end - ranges_[n].begin;
+			if (accumulated * group_count >= total * (group_ends.size() + 1)) group_ends.push_back(n + 1);
+		}
+		parallelTasks(group_ends.size(), [&](const usize group) {
+			const usize begin = group == 0 ? 0 : group_ends[group - 1];
+			for (usize n = begin; n < group_ends[group]; ++n) updateRange(ranges_[n], 1);
+		});
+		return total;
+	}
+
+	[[nodiscard]] usize size() const noexcept { return ids_.size(); }
+	// Depth-first arrays for direct consumption, indexed by index(id)
+	[[nodiscard]] u32 index(const u32 id) const noexcept {
+		assert(contains(id));
+		return indices_[id];
+	}
+	[[nodiscard]] std::span<const Mat4<T>> worlds() const noexcept { return worlds_; }
+	[[nodiscard]] std::span<const u32> parents() const noexcept { return parents_; }
+
+private:
+	static constexpr u32 REMOVED = NONE - 1;
+	static constexpr usize PARALLEL_MIN_NODES = 4096;
+
+	struct Range {
+		u32 begin, end;
+	};
+
+	u32 mark(const u32 id) {
+		assert(contains(id));
+		if (!marked_[id]) {
+			marked_[id] = 1;
+			dirty_.push_back(id);
+		}
+		return indices_[id];
+	}
+
+	void updateRange(const Range& range, const usize thread_count) noexcept {
+		const usize count = range.end - range.begin;
+		Transform3D<T>::matrices(
+			{ positions_.data() + range.begin, count },
+			{ scales_.data() + range.begin, count },
+			{ rotations_.data() + range.begin, count },
+			{ worlds_.data() + range.begin, count },
+			thread_count
+		);
+		// Parents precede their children, and the range root's parent lies outside the range and is current
+		for (u32 n = range.begin; n < range.end; ++n) {
+			if (parents_[n] != NONE) worlds_[n] = worlds_[parents_[n]] * worlds_[n];
+		}
+	}
+
+	// Re-sorts every array into depth-first order, dropping removed subtrees
+	void relayout() {
+		const usize count = ids_.size();
+		std::vector<u32> child_counts(count + 1, 0);
+		for (usize n = 0; n < count; ++n) {
+			if (parents_[n] != NONE && parents_[n] != REMOVED) ++child_counts[parents_[n]];
+		}
+		// Children grouped by parent in their current order, offsets by prefix sum
+		std::vector<u32> child_offsets(count + 1, 0);
+		for (usize n = 0; n < count; ++n) child_offsets[n + 1] = child_offsets[n] + child_counts[n];
+		std::vector<u32> children(child_offsets[count]);
+		std::ranges::fill(child_counts, 0);
+		for (u32 n = 0; n < count; ++n) {
+			if (parents_[n] != NONE && parents_[n] != REMOVED) children[child_offsets[parents_[n]] + child_counts[parents_[n]]++] = n;
+		}
+
+		std::vector<u32> order;
+		order.reserve(count);
+		std::vector<u32> new_parents;
+		new_parents.reserve(count);
+		std::vector<u32> new_index(count, NONE);
+		std::vector<u32> stack;
+		for (u32 root = 0; root < count; ++root) {
+			if (parents_[root] != NONE) continue;
+			stack.push_back(root);
+			while (!stack.empty()) {
+				const u32 n = stack.back();
+				stack.pop_back();
+				new_index[n] = (u32)order.size();
+				order.push_back(n);
+				new_parents.push_back(parents_[n] == NONE ? NONE : new_index[parents_[n]]);
+				// Reversed so children keep their relative order
+				for (u32 c = child_offsets[n + 1]; c-- > child_offsets[n];) stack.push_back(children[c]);
+			}
+		}
+
+		// Everything not reached was removed, directly or through an ancestor
+		for (u32 n = 0; n < count; ++n) {
+			if (new_index[n] != NONE) continue;
+			indices_[ids_[n]] = NONE;
+			free_ids_.push_back(ids_[n]);
+		}
+
+		permute(ids_, order);
+		permute(positions_, order);
+		permute(scales_, order);
+		permute(rotations_, order);
+		permute(worlds_, order);
+		parents_ = std::move(new_parents);
+		for (u32 n = 0; n < ids_.size(); ++n) indices_[ids_[n]] = n;
+
+		sizes_.assign(ids_.size(), 1);
+		for (usize n = ids_.size(); n-- > 0;) {
+			if (parents_[n] != NONE) sizes_[parents_[n]] += sizes_[n];
+		}
+		layout_dirty_ = false;
+	}
+
+	template<typename V>
+	static void permute(std::vector<V>& values, const std::vector<u32>& order) {
+		std::vector<V> sorted;
+		sorted.reserve(order.size());
+		for (const u32 n : order) sorted.push_back(values[n]);
+		values = std::move(sorted);
+	}
+
+	// Per index, in depth-first order
+	std::vector<u32> ids_;
+	std::vector<u32> parents_;
+	std::vector<u32> sizes_; // subtree size including the node itself
+	std::vector<Vec3<T>> positions_;
+	std::vector<Vec3<T>> scales_;
+	std::vector<Quaternion<T>> rotations_;
+	std::vector<Mat4<T>> worlds_;
+
+	// Per id
+	std::vector<u32> indices_;
+	std::vector<u8> marked_;
+	std::vector<u32> free_ids_;
+
+	std::vector<u32> dirty_;
+	std::vector<u32> dirty_indices_;
+	std::vector<Range> ranges_;
+	bool layout_dirty_ = false;
+};
+
+using Hierarchyf = Hierarchy<f32>;
+
+}
@@ -0,0 +1,322 @@
+#pragma once
+
+#include "types.h"
+#include "profiler.h"
+#include "scheduler.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+
+namespace Mirror {
+
+// Chase-Lev work-stealing deque of pointers with a fixed power-of-two capacity (Le et al., "Correct and Efficient
+// Work-Stealing for Weak Memory Models"). The owning thread pushes and pops at the bottom, any thread steals from the top.
+template<typename T, usize CAPACITY = 4096>
+class WorkStealingDeque {
+	static_assert(std::is_pointer_v<T> && std::has_single_bit(CAPACITY));
+
+public:
+	// Owner only, false when full
+	bool push(const T item) noexcept {
+		const i64 bottom = bottom_.load(std::memory_order_relaxed);
+		const i64 top = top_.load(std::memory_order_acquire);
+		if (bottom - top >= (i64)CAPACITY) return false;
+		items_[(usize)bottom & (CAPACITY - 1)].store(item, std::memory_order_relaxed);
+		bottom_.store(bottom + 1, std::memory_order_release);
+		return true;
+	}
+	// Owner only, most recently pushed first; nullptr when empty
+	[[nodiscard]] T pop() noexcept {
+		const i64 bottom = bottom_.load(std::memory_order_relaxed) - 1;
+		bottom_.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		i64 top = top_.load(std::memory_order_relaxed);
+		if (top > bottom) {
+			bottom_.store(bottom + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+		T item = items_[(usize)bottom & (CAPACITY - 1)].load(std::memory_order_relaxed);
+		if (top == bottom) {
+			// Last item, race the thieves for it
+			if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) item = nullptr;
+			bottom_.store(bottom + 1, std::memory_order_relaxed);
+		}
+		return item;
+	}
+	// Any thread, oldest first; nullptr when empty or when another thread won the race
+	[[nodiscard]] T steal() noexcept {
+		i64 top = top_.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const i64 bottom = bottom_.load(std::memory_order_acquire);
+		if (top >= bottom) return nullptr;
+		T item = items_[(usize)top & (CAPACITY - 1)].load(std::memory_order_relaxed);
+		if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) return nullptr;
+		return item;
+	}
+
+	// Approximate when called concurrently
+	[[nodiscard]] usize size() const noexcept {
+		const i64 bottom = bottom_.load(std::memory_order_relaxed);
+		const i64 top = top_.load(std::memory_order_relaxed);
+		return bottom > top ? (usize)(bottom - top) : 0;
+	}
+
+private:
+	alignas(64) std::atomic<i64> top_{ 0 };
+	alignas(64) std::atomic<i64> bottom_{ 0 };
+	alignas(64) std::atomic<T> items_[CAPACITY]{};
+};
+
+// Work-stealing thread pool for fork-join parallelism. Every worker owns a Chase-Lev deque; threads outside the pool
+// (the main thread) queue into a shared injection queue instead. Jobs are children of a Counter, and wait() keeps the
+// waiting thread busy running queued jobs until the counter drains, so the main thread works alongside the pool and
+// nested waits inside jobs can't deadlock. Queuing doesn't allocate: jobs come from a fixed per-thread pool and run
+// inline when it or the deque is exhausted. Idle workers spin briefly, then sleep until new work is queued.
+class JobSystem {
+public:
+	struct Counter {
+		std::atomic<u32> pending{ 0 };
+
+		[[nodiscard]] bool done() const noexcept { return pending.load(std::memory_order_acquire) == 0; }
+	};
+
+	// Defaults to one worker per core besides the calling thread
+	explicit JobSystem(const usize worker_count = std::max<usize>(std::thread::hardware_concurrency(), 1) - 1) :
+		worker_count_(worker_count), queues_(std::make_unique<Queue[]>(std::max<usize>(worker_count, 1))) {
+		workers_.reserve(worker_count);
+		for (usize n = 0; n < worker_count; ++n) {
+			workers_.emplace_back([this, n]() { work(n); });
+		}
+	}
+	~JobSystem() {
+		stop_.store(true, std::memory_order_seq_cst);
+		epoch_.fetch_add(1, std::memory_order_seq_cst);
+		epoch_.notify_all();
+		workers_.clear();
+	}
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	// The pool behind parallelFor(), parallelChunks() and parallelTasks(), created on first use
+	[[nodiscard]] static JobSystem& instance() {
+		static JobSystem jobs;
+		return jobs;
+	}
+
+	[[nodiscard]] usize workerCount() const noexcept { return worker_count_; }
+	// Workers plus the thread that waits
+	[[nodiscard]] usize threadCount() const noexcept { return worker_count_ + 1; }
+
+	// Queues fn() as a child of counter. fn is referenced, not copied, and must outlive wait(counter).
+	template<typename Fn>
+	void run(Counter& counter, const Fn& fn) {
+		Job* job = allocate();
+		if (job == nullptr) {
+			fn();
+			return;
+		}
+		job->set([](JobSystem&, const Job& job) { (*(const Fn*)job.fn)(); }, &fn, 0, 0, 0, counter);
+		submit(*job);
+	}
+
+	// Runs queued jobs on the calling thread until every child of counter has finished
+	void wait(const Counter& counter) {
+		for (u32 idle = 0; !counter.done();) {
+			if (tryRunOne()) {
+				idle = 0;
+			} else if (++idle < 64) {
+				FrameLimiter::spinPause();
+			} else {
+				std::this_thread::yield();
+			}
+		}
+	}
+	// Runs one queued job on the calling thread, false if there was none; for loops that wait on more than a counter
+	bool tryRunOne() {
+		Job* job = find();
+		if (job == nullptr) return false;
+		execute(*job);
+		return true;
+	}
+
+	// Calls fn(begin, end) over disjoint ranges covering [0, count) and returns when all are done. Ranges are split in
+	// halves on demand: whoever runs a range queues its upper half and keeps the lower one until it's down to the
+	// grain, max(min_grain, count / (4 * threads)), so idle threads steal large pieces and busy ones don't pay for
+	// splitting. Range bounds stay multiples of 8 except at count.
+	template<typename Fn>
+	void parallelFor(const usize count, const usize min_grain, const Fn& fn) {
+		if (count == 0) return;
+		const usize grain = std::max<usize>({ min_grain, count / (4 * threadCount()), 1 });
+		if (worker_count_ == 0 || count <= grain) {
+			fn(usize{ 0 }, count);
+			return;
+		}
+		Counter counter;
+		runRange<Fn>(counter, fn, 0, count, grain);
+		wait(counter);
+	}
+
+private:
+	// Pool slots are reused round-robin, busy is cleared by whichever thread finishes the job
+	struct Job {
+		void (*execute)(JobSystem&, const Job&);
+		const void* fn;
+		usize begin, end, grain;
+		Counter* counter;
+		std::atomic<bool> busy{ false };
+
+		void set(void (*execute_)(JobSystem&, const Job&), const void* fn_, const usize begin_, const usize end_, const usize grain_, Counter& counter_) noexcept {
+			execute = execute_;
+			fn = fn_;
+			begin = begin_;
+			end = end_;
+			grain = grain_;
+			counter = &counter_;
+		}
+	};
+	struct alignas(64) Queue {
+		WorkStealingDeque<Job*> deque;
+	};
+
+	static constexpr usize POOL_SIZE = 4096;
+	static constexpr u32 NO_WORKER = std::numeric_limits<u32>::max();
+
+	struct ThreadContext {
+		JobSystem* system = nullptr;
+		u32 worker = NO_WORKER;
+		u32 random = 0x9E3779B9u;
+		usize next_slot = 0;
+		std::unique_ptr<Job[]> pool;
+	};
+	[[nodiscard]] static ThreadContext& context() noexcept {
+		thread_local ThreadContext context;
+		return context;
+	}
+
+	[[nodiscard]] Job* allocate() {
+		ThreadContext& local = context();
+		if (!local.pool) local.pool = std::make_unique<Job[]>(POOL_SIZE);
+		for (usize tries = 0; tries < 8; ++tries) {
+			Job& job = local.pool[local.next_slot++ & (POOL_SIZE - 1)];
+			if (!job.busy.load(std::memory_order_acquire)) {
+				job.busy.store(true, std::memory_order_relaxed);
+				return &job;
+			}
+		}
+		return nullptr;
+	}
+
+	void submit(Job& job) {
+		job.counter->pending.fetch_add(1, std::memory_order_relaxed);
+		const ThreadContext& local = context();
+		if (local.system == this && local.worker != NO_WORKER) {
+			if (!queues_[local.worker].deque.push(&job)) {
+				execute(job);
+				return;
+			}
+		} else {
+			std::scoped_lock lock{ injection_mutex_ };
+			injection_.push_back(&job);
+			injection_size_.store(injection_.size() - injection_head_, std::memory_order_relaxed);
+		}
+		epoch_.fetch_add(1, std::memory_order_seq_cst);
+		if (sleepers_.load(std::memory_order_seq_cst) > 0) epoch_.notify_one();
+	}
+
+	void execute(Job& job) {
+		Counter& counter = *job.counter;
+		job.execute(*this, job);
+		job.busy.store(false, std::memory_order_release);
+		counter.pending.fetch_sub(1, std::memory_order_acq_rel);
+	}
+
+	template<typename Fn>
+	void runRange(Counter& counter, const Fn& fn, const usize begin, usize end, const usize grain) {
+		while (end - begin > grain) {
+			const usize middle = std::min(begin + ((((end - begin) / 2) + 7) & ~usize{ 7 }), end);
+			Job* job = middle < end ? allocate() : nullptr;
+			if (job == nullptr) break;
+			job->set(
+				[](JobSystem& jobs, const Job& job) { jobs.runRange<Fn>(*job.counter, *(const Fn*)job.fn, job.begin, job.end, job.grain); },
+				&fn, middle, end, grain, counter
+			);
+			submit(*job);
+			end = middle;
+		}
+		fn(begin, end);
+	}
+
+	// Own deque first, then the injection queue, then steal from a random worker
+	[[nodiscard]] Job* find() {
+		ThreadContext& local = context();
+		const bool is_worker = local.system == this && local.worker != NO_WORKER;
+		if (is_worker) {
+			if (Job* job = queues_[local.worker].deque.pop()) return job;
+		}
+		if (injection_size_.load(std::memory_order_relaxed) > 0) {
+			std::scoped_lock lock{ injection_mutex_ };
+			if (injection_head_ < injection_.size()) {
+				// Oldest first, the earliest splits are the largest
+				Job* job = injection_[injection_head_++];
+				if (injection_head_ == injection_.size()) {
+					injection_.clear();
+					injection_head_ = 0;
+				}
+				injection_size_.store(injection_.size() - injection_head_, std::memory_order_relaxed);
+				return job;
+			}
+		}
+		const usize count = worker_count_;
+		if (count == 0) return nullptr;
+		local.random ^= local.random << 13;
+		local.random ^= local.random >> 17;
+		local.random ^= local.random << 5;
+		const usize first = local.random % count;
+		for (usize n = 0; n < count; ++n) {
+			const usize victim = (first + n) % count;
+			if (is_worker && victim == local.worker) continue;
+			if (Job* job = queues_[victim].deque.steal()) return job;
+		}
+		return nullptr;
+	}
+
+	void work(const usize index) {
+		ThreadContext& local = context();
+		local.system = this;
+		local.worker = (u32)index;
+		local.random += (u32)index * 0x85EBCA6Bu;
+		MIRROR_PROFILE_THREAD("Worker " + std::to_string(index + 1));
+
+		while (!stop_.load(std::memory_order_relaxed)) {
+			// Read before looking for work, so a job queued after the last look changes it and wait() returns at once
+			const u32 epoch = epoch_.load(std::memory_order_seq_cst);
+			Job* job = find();
+			for (u32 spin = 0; job == nullptr && spin < 256; ++spin) {
+				FrameLimiter::spinPause();
+				job = find();
+			}
+			if (job != nullptr) {
+				execute(*job);
+				continue;
+			}
+			sleepers_.fetch_add(1, std::memory_order_seq_cst);
+			if (!stop_.load(std::memory_order_seq_cst)) epoch_.wait(epoch, std::memory_order_seq_cst);
+			sleepers_.fetch_sub(1, std::memory_order_seq_cst);
+		}
+	}
+
+	const usize worker_count_; // workers_ is still growing while the first workers start stealing
+	std::unique_ptr<Queue[]> queues_;
+	std::mutex injection_mutex_;
+	std::vector<Job*> injection_;
+	usize injection_head_ = 0;
+	std::atomic<usize> injection_size_{ 0 };
+	alignas(64) std::atomic<u32> epoch_{ 0 };
+	std::atomic<u32> sleepers_{ 0 };
+	std::atomic<bool> stop_{ false };
+	std::vector<std::jthread> workers_; // last, so workers stop before the queues go away
+};
+
+}
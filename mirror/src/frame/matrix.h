@@ -2,6 +2,7 @@
 
 #include "types.h"
 
+#include "simd.h"
 #include "vector.h"
 
 namespace Mirror {
@@ -310,41 +311,34 @@ struct Matrix<T, 4, 4> {
 	}
 
 	[[nodiscard]] constexpr Matrix<T, 4, 4> operator*(const Matrix<T, 4, 4>& other) const noexcept {
-		return {
-			{
-				at(0, 0) * other(0, 0) + at(1, 0) * other(0, 1) + at(2, 0) * other(0, 2) + at(3, 0) * other(0, 3),
-				at(0, 1) * other(0, 0) + at(1, 1) * other(0, 1) + at(2, 1) * other(0, 2) + at(3, 1) * other(0, 3),
-				at(0, 2) * other(0, 0) + at(1, 2) * other(0, 1) + at(2, 2) * other(0, 2) + at(3, 2) * other(0, 3),
-				at(0, 3) * other(0, 0) + at(1, 3) * other(0, 1) + at(2, 3) * other(0, 2) + at(3, 3) * other(0, 3),
-			},
-			{
-				at(0, 0) * other(1, 0) + at(1, 0) * other(1, 1) + at(2, 0) * other(1, 2) + at(3, 0) * other(1, 3),
-				at(0, 1) * other(1, 0) + at(1, 1) * other(1, 1) + at(2, 1) * other(1, 2) + at(3, 1) * other(1, 3),
-				at(0, 2) * other(1, 0) + at(1, 2) * other(1, 1) + at(2, 2) * other(1, 2) + at(3, 2) * other(1, 3),
-				at(0, 3) * other(1, 0) + at(1, 3) * other(1, 1) + at(2, 3) * other(1, 2) + at(3, 3) * other(1, 3),
-			},
-			{
-				at(0, 0) * other(2, 0) + at(1, 0) * other(2, 1) + at(2, 0) * other(2, 2) + at(3, 0) * other(2, 3),
-				at(0, 1) * other(2, 0) + at(1, 1) * other(2, 1) + at(2, 1) * other(2, 2) + at(3, 1) * other(2, 3),
-				at(0, 2) * other(2, 0) + at(1, 2) * other(2, 1) + at(2, 2) * other(2, 2) + at(3, 2) * other(2, 3),
-				at(0, 3) * other(2, 0) + at(1, 3) * other(2, 1) + at(2, 3) * other(2, 2) + at(3, 3) * other(2, 3),
-			},
-			{
-				at(0, 0) * other(3, 0) + at(1, 0) * other(3, 1) + at(2, 0) * other(3, 2) + at(3, 0) * other(3, 3),
-				at(0, 1) * other(3, 0) + at(1, 1) * other(3, 1) + at(2, 1) * other(3, 2) + at(3, 1) * other(3, 3),
-				at(0, 2) * other(3, 0) + at(1, 2) * other(3, 1) + at(2, 2) * other(3, 2) + at(3, 2) * other(3, 3),
-				at(0, 3) * other(3, 0) + at(1, 3) * other(3, 1) + at(2, 3) * other(3, 2) + at(3, 3) * other(3, 3),
-			},
-		};
+		if constexpr (Simd::ENABLED && std::is_same_v<T, f32>) {
+			if !consteval {
+				const Simd::F32x4 c0 = Simd::load(&x.x);
+				const Simd::F32x4 c1 = Simd::load(&y.x);
+				const Simd::F32x4 c2 = Simd::load(&z.x);
+				const Simd::F32x4 c3 = Simd::load(&w.x);
+				Matrix<T, 4, 4> result;
+				Simd::store(&result.x.x, Simd::combine(c0, c1, c2, c3, Simd::load(&other.x.x)));
+				Simd::store(&result.y.x, Simd::combine(c0, c1, c2, c3, Simd::load(&other.y.x)));
+				Simd::store(&result.z.x, Simd::combine(c0, c1, c2, c3, Simd::load(&other.z.x)));
+				Simd::store(&result.w.x, Simd::combine(c0, c1, c2, c3, Simd::load(&other.w.x)));
+				return result;
+			}
+		}
+		return { *this * other.x, *this * other.y, *this * other.z, *this * other.w };
 	}
 
 	[[nodiscard]] constexpr Vec4<T> operator*(const Vec4<T>& v) const noexcept {
-		return {
-			at(0, 0) * v[0] + at(1, 0) * v[1] + at(2, 0) * v[2] + at(3, 0) * v[3],
-			at(0, 1) * v[0] + at(1, 1) * v[1] + at(2, 1) * v[2] + at(3, 1) * v[3],
-			at(0, 2) * v[0] + at(1, 2) * v[1] + at(2, 2) * v[2] + at(3, 2) * v[3],
-			at(0, 3) * v[0] + at(1, 3) * v[1] + at(2, 3) * v[2] + at(3, 3) * v[3],
-		};
+		if constexpr (Simd::ENABLED && std::is_same_v<T, f32>) {
+			if !consteval {
+				Vec4<T> result;
+				Simd::store(&result.x, Simd::combine(
+					Simd::load(&x.x), Simd::load(&y.x), Simd::load(&z.x), Simd::load(&w.x), Simd::load(&v.x)
+				));
+				return result;
+			}
+		}
+		return x * v.x + y * v.y + z * v.z + w * v.w;
 	}
 
 	[[nodiscard]] constexpr Matrix<T, 4, 4> hadamard(const Matrix<T, 4, 4>& other) const noexcept {
@@ -359,12 +353,24 @@ struct Matrix<T, 4, 4> {
 	}
 
 	[[nodiscard]] constexpr T determinant() const noexcept {
-		return {
-			at(0, 0) * at(1, 1) * at(2, 2) * at(3, 3) - at(3, 0) * at(2, 1) * at(1, 2) * at(0, 3) +
-			at(1, 0) * at(2, 1) * at(3, 2) * at(0, 3) - at(2, 0) * at(1, 1) * at(0, 2) * at(3, 3) +
-			at(2, 0) * at(3, 1) * at(0, 2) * at(1, 3) - at(1, 0) * at(0, 1) * at(3, 2) * at(2, 3) +
-			at(3, 0) * at(0, 1) * at(1, 2) * at(2, 3) - at(0, 0) * at(3, 1) * at(2, 2) * at(1, 3)
-		};
+		if constexpr (Simd::ENABLED && std::is_same_v<T, f32>) {
+			if !consteval {
+				return Simd::determinant(Simd::load(&x.x), Simd::load(&y.x), Simd::load(&z.x), Simd::load(&w.x));
+			}
+		}
+		const T s0 = x.x * y.y - y.x * x.y;
+		const T s1 = x.x * y.z - y.x * x.z;
+		const T s2 = x.x * y.w - y.x * x.w;
+		const T s3 = x.y * y.z - y.y * x.z;
+		const T s4 = x.y * y.w - y.y * x.w;
+		const T s5 = x.z * y.w - y.z * x.w;
+		const T c5 = z.z * w.w - w.z * z.w;
+		const T c4 = z.y * w.w - w.y * z.w;
+		const T c3 = z.y * w.z - w.y * z.z;
+		const T c2 = z.x * w.w - w.x * z.w;
+		const T c1 = z.x * w.z - w.x * z.z;
+		const T c0 = z.x * w.y - w.x * z.y;
+		return (s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2) + (-s4 * c1 + s5 * c0);
 	}
 	[[nodiscard]] constexpr Vec4<T> row(usize index) const noexcept {
 		assert(index < 4);
@@ -376,17 +382,144 @@ struct Matrix<T, 4, 4> {
 		};
 	}
 	[[nodiscard]] constexpr Matrix<T, 4, 4> transposed() const noexcept {
+		if constexpr (Simd::ENABLED && std::is_same_v<T, f32>) {
+			if !consteval {
+				Simd::F32x4 c0 = Simd::load(&x.x);
+				Simd::F32x4 c1 = Simd::load(&y.x);
+				Simd::F32x4 c2 = Simd::load(&z.x);
+				Simd::F32x4 c3 = Simd::load(&w.x);
+				Simd::transpose(c0, c1, c2, c3);
+				Matrix<T, 4, 4> result;
+				Simd::store(&result.x.x, c0);
+				Simd::store(&result.y.x, c1);
+				Simd::store(&result.z.x, c2);
+				Simd::store(&result.w.x, c3);
+				return result;
+			}
+		}
 		return {
-			row(0),
-			row(1),
-			row(2),
-			row(3)
+			{ x.x, y.x, z.x, w.x },
+			{ x.y, y.y, z.y, w.y },
+			{ x.z, y.z, z.z, w.z },
+			{ x.w, y.w, z.w, w.w }
 		};
 	}
 	constexpr Matrix<T, 4, 4>& transpose() noexcept {
 		*this = transposed();
 		return *this;
 	}
+
+	[[nodiscard]] constexpr Matrix<T, 4, 4> inverted() const noexcept {
+		if constexpr (Simd::ENABLED && std::is_same_v<T, f32>) {
+			if !consteval {
+				Simd::F32x4 c0 = Simd::load(&x.x);
+				Simd::F32x4 c1 = Simd::load(&y.x);
+				Simd::F32x4 c2 = Simd::load(&z.x);
+				Simd::F32x4 c3 = Simd::load(&w.x);
+				Simd::inverse(c0, c1, c2, c3);
+				Matrix<T, 4, 4> result;
+				Simd::store(&result.x.x, c0);
+				Simd::store(&result.y.x, c1);
+				Simd::store(&result.z.x, c2);
+				Simd::store(&result.w.x, c3);
+				return result;
+			}
+		}
+		const T s0 = x.x * y.y - y.x * x.y;
+		const T s1 = x.x * y.z - y.x * x.z;
+		const T s2 = x.x * y.w - y.x * x.w;
+		const T s3 = x.y * y.z - y.y * x.z;
+		const T s4 = x.y * y.w - y.y * x.w;
+		const T s5 = x.z * y.w - y.z * x.w;
+		const T c5 = z.z * w.w - w.z * z.w;
+		const T c4 = z.y * w.w - w.y * z.w;
+		const T c3 = z.y * w.z - w.y * z.z;
+		const T c2 = z.x * w.w - w.x * z.w;
+		const T c1 = z.x * w.z - w.x * z.z;
+		const T c0 = z.x * w.y - w.x * z.y;
+		const T det = (s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2) + (-s4 * c1 + s5 * c0);
+		assert(det != 0);
+		const T inv_det = 1 / det;
+		return {
+			{
+				(y.y * c5 - y.z * c4 + y.w * c3) * inv_det,
+				(-x.y * c5 + x.z * c4 - x.w * c3) * inv_det,
+				(w.y * s5 - w.z * s4 + w.w * s3) * inv_det,
+				(-z.y * s5 + z.z * s4 - z.w * s3) * inv_det,
+			},
+			{
+				(-y.x * c5 + y.z * c2 - y.w * c1) * inv_det,
+				(x.x * c5 - x.z * c2 + x.w * c1) * inv_det,
+				(-w.x * s5 + w.z * s2 - w.w * s1) * inv_det,
+				(z.x * s5 - z.z * s2 + z.w * s1) * inv_det,
+			},
+			{
+				(y.x * c4 - y.y * c2 + y.w * c0) * inv_det,
+				(-x.x * c4 + x.y * c2 - x.w * c0) * inv_det,
+				(w.x * s4 - w.y * s2 + w.w * s0) * inv_det,
+				(-z.x * s4 + z.y * s2 - z.w * s0) * inv_det,
+			},
+			{
+				(-y.x * c3 + y.y * c1 - y.z * c0) * inv_det,
+				(x.x * c3 - x.y * c1 + x.z * c0) * inv_det,
+				(-w.x * s3 + w.y * s1 - w.z * s0) * inv_det,
+				(z.x * s3 - z.y * s1 + z.z * s0) * inv_det,
+			},
+		};
+	}
+	constexpr Matrix<T, 4, 4>& invert() noexcept {
+		*this = inverted();
+		return *this;
+	}
+
+	// Inverse of a matrix whose last row is (0, 0, 0, 1), e.g. from Transform3D::matrix() or a hierarchy of them
+	[[nodiscard]] constexpr Matrix<T, 4, 4> affineInverted() const noexcept {
+		const Vec3<T> a{ x.x, x.y, x.z };
+		const Vec3<T> b{ y.x, y.y, y.z };
+		const Vec3<T> c{ z.x, z.y, z.z };
+		const Vec3<T> bc = b.cross(c);
+		const T det = a.dot(bc);
+		assert(det != 0);
+		const Vec3<T> r0 = bc / det;
+		const Vec3<T> r1 = c.cross(a) / det;
+		const Vec3<T> r2 = a.cross(b) / det;
+		const Vec3<T> t{ w.x, w.y, w.z };
+		return {
+			{ r0.x, r1.x, r2.x, 0 },
+			{ r0.y, r1.y, r2.y, 0 },
+			{ r0.z, r1.z, r2.z, 0 },
+			{ -r0.dot(t), -r1.dot(t), -r2.dot(t), 1 },
+		};
+	}
+	// Inverse of a rotation and translation with no scale, e.g. from Camera::view()
+	[[nodiscard]] constexpr Matrix<T, 4, 4> rigidInverted() const noexcept {
+		if constexpr (Simd::ENABLED && std::is_same_v<T, f32>) {
+			if !consteval {
+				Simd::F32x4 c0 = Simd::load(&x.x);
+				Simd::F32x4 c1 = Simd::load(&y.x);
+				Simd::F32x4 c2 = Simd::load(&z.x);
+				Simd::F32x4 c3 = Simd::load(&w.x);
+				Simd::rigidInverse(c0, c1, c2, c3);
+				Matrix<T, 4, 4> result;
+				Simd::store(&result.x.x, c0);
+				Simd::store(&result.y.x, c1);
+				Simd::store(&result.z.x, c2);
+				Simd::store(&result.w.x, c3);
+				return result;
+			}
+		}
+		return {
+			{ x.x, y.x, z.x, 0 },
+			{ x.y, y.y, z.y, 0 },
+			{ x.z, y.z, z.z, 0 },
+			{
+				-(x.x * w.x + x.y * w.y + x.z * w.z),
+				-(y.x * w.x + y.y * w.y + y.z * w.z),
+				-(z.x * w.x + z.y * w.y + z.z * w.z),
+				1
+			},
+		};
+	}
 };
 
 template<typename T>
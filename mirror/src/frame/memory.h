@@ -0,0 +1,603 @@
+#pragma once
+
+#include "types.h"
+
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <new>
+
+namespace Mirror {
+
+#if defined(MIRROR_HEAP_CHECKS) || defined(MIRROR_MEMORY_TRACKING)
+#define MIRROR_HEAP_HOOKS 1
+#endif
+
+// Counts general-heap allocations through the operator new replacements in mirror.cpp, which are only compiled with
+// MIRROR_HEAP_CHECKS or MIRROR_MEMORY_TRACKING; otherwise every count stays zero
+class HeapMonitor {
+public:
+	[[nodiscard]] static constexpr bool enabled() noexcept {
+#if defined(MIRROR_HEAP_HOOKS)
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	// All threads, since startup
+	[[nodiscard]] static u64 allocations() noexcept { return allocations_.load(std::memory_order_relaxed); }
+	[[nodiscard]] static u64 bytes() noexcept { return bytes_.load(std::memory_order_relaxed); }
+	// Calling thread only, for checks that must not see other threads
+	[[nodiscard]] static u64 threadAllocations() noexcept { return thread_allocations_; }
+
+	static void onAllocate(const usize size) noexcept {
+		allocations_.fetch_add(1, std::memory_order_relaxed);
+		bytes_.fetch_add(size, std::memory_order_relaxed);
+		++thread_allocations_;
+	}
+
+private:
+	static inline std::atomic<u64> allocations_{ 0 };
+	static inline std::atomic<u64> bytes_{ 0 };
+	static inline thread_local u64 thread_allocations_ = 0;
+};
+
+// Attributes heap allocations to the subsystem tag active on the allocating thread (MIRROR_MEMORY_TAG) and tracks
+// live bytes, peaks and per-frame churn for each, with MIRROR_MEMORY_TRACKING. The hooks prefix every allocation
+// with a small header holding its size and tag, so frees are charged back to the right tag from any thread. Each
+// thread counts into its own block with plain stores, summed by endFrame() and snapshot(), so peaks are sampled
+// once per frame. The SystemScheduler tags each system by name; untagged memory is charged to tag 0.
+class MemoryTracker {
+public:
+	static constexpr u32 MAX_TAGS = 64;
+	static constexpr usize MAX_NAME = 48;
+	static constexpr u32 MAX_THREADS = 128; // later threads share one block through atomic adds
+	static constexpr usize HEADER_SIZE = 16;
+
+	struct Header {
+		u64 size;
+		u32 tag;
+		u32 padding;
+	};
+	static_assert(sizeof(Header) == HEADER_SIZE);
+
+	struct TagSummary {
+		const char* name = nullptr;
+		u64 live_bytes = 0;
+		u64 peak_bytes = 0; // highest live_bytes seen by endFrame() or snapshot()
+		u64 allocations = 0;
+		u64 frees = 0;
+		u64 frame_allocations = 0; // in the last frame closed by endFrame()
+		u64 frame_bytes = 0;
+	};
+	struct Snapshot {
+		u64 frame = 0;
+		u64 live_bytes = 0;
+		u64 peak_bytes = 0;
+		u64 frame_allocations = 0;
+		u64 frame_bytes = 0;
+		u32 tag_count = 0;
+		std::array<TagSummary, MAX_TAGS> tags{}; // first tag_count entries, by tag id
+	};
+
+	// Makes tag the current one on this thread for the scope's lifetime
+	class Scope {
+	public:
+		explicit Scope(const u32 tag) noexcept : previous_(current_) { current_ = tag; }
+		~Scope() { current_ = previous_; }
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		u32 previous_;
+	};
+
+	[[nodiscard]] static constexpr bool enabled() noexcept {
+#if defined(MIRROR_MEMORY_TRACKING)
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	// Id for a name, registered on first use and truncated to MAX_NAME - 1 characters. Doesn't allocate, so it's safe
+	// anywhere. Returns 0 once MAX_TAGS names exist.
+	[[nodiscard]] static u32 tag(const std::string_view name) noexcept {
+		const std::string_view key = name.substr(0, MAX_NAME - 1);
+		std::scoped_lock lock{ state_.mutex };
+		const u32 count = state_.tag_count.load(std::memory_order_relaxed);
+		for (u32 n = 0; n < count; ++n) {
+			if (key == state_.tags[n].name.data()) return n;
+		}
+		if (count == MAX_TAGS) return 0;
+		std::ranges::copy(key, state_.tags[count].name.begin());
+		state_.tag_count.store(count + 1, std::memory_order_release);
+		return count;
+	}
+	[[nodiscard]] static u32 current() noexcept { return current_; }
+
+	// Called by the hooks
+	static void onAllocate(void* header, const usize size) noexcept {
+		const u32 tag = current_;
+		new (header) Header{ size, tag, 0 };
+		Counters& counters = threadCounters();
+		add(counters.allocations[tag], 1, counters.shared);
+		add(counters.allocated_bytes[tag], size, counters.shared);
+	}
+	// Returns the size recorded in the header
+	static usize onFree(const void* header) noexcept {
+		const Header& data = *static_cast<const Header*>(header);
+		Counters& counters = threadCounters();
+		add(counters.frees[data.tag], 1, counters.shared);
+		add(counters.freed_bytes[data.tag], data.size, counters.shared);
+		return data.size;
+	}
+
+	// Closes a frame for the per-frame counts and samples peaks; Mirror::update() calls it once per frame
+	static void endFrame() noexcept {
+		std::scoped_lock lock{ state_.mutex };
+		const Totals totals = sum();
+		for (u32 n = 0; n < totals.tag_count; ++n) {
+			Tag& tag = state_.tags[n];
+			tag.frame_allocations = totals.allocations[n] - tag.allocations_mark;
+			tag.frame_bytes = totals.allocated_bytes[n] - tag.bytes_mark;
+			tag.allocations_mark = totals.allocations[n];
+			tag.bytes_mark = totals.allocated_bytes[n];
+		}
+		samplePeaks(totals);
+		++state_.frame;
+	}
+
+	[[nodiscard]] static Snapshot snapshot() noexcept {
+		std::scoped_lock lock{ state_.mutex };
+		const Totals totals = sum();
+		samplePeaks(totals);
+		Snapshot snapshot;
+		snapshot.frame = state_.frame;
+		snapshot.peak_bytes = state_.peak_bytes;
+		snapshot.tag_count = totals.tag_count;
+		for (u32 n = 0; n < totals.tag_count; ++n) {
+			const Tag& tag = state_.tags[n];
+			TagSummary& summary = snapshot.tags[n];
+			summary.name = tag.name.data();
+			summary.live_bytes = live(totals, n);
+			summary.peak_bytes = tag.peak_bytes;
+			summary.allocations = totals.allocations[n];
+			summary.frees = totals.frees[n];
+			summary.frame_allocations = tag.frame_allocations;
+			summary.frame_bytes = tag.frame_bytes;
+			snapshot.live_bytes += summary.live_bytes;
+			snapshot.frame_allocations += summary.frame_allocations;
+			snapshot.frame_bytes += summary.frame_bytes;
+		}
+		return snapshot;
+	}
+
+	// One row per tag, for diffing runs offline
+	static bool writeCsv(const Snapshot& snapshot, const std::string& path) {
+		std::ofstream file{ path };
+		file << "# frame " << snapshot.frame << ", live " << snapshot.live_bytes << " B, peak " << snapshot.peak_bytes << " B\n";
+		file << "tag,live_bytes,peak_bytes,allocations,frees,frame_allocations,frame_bytes\n";
+		for (u32 n = 0; n < snapshot.tag_count; ++n) {
+			const TagSummary& tag = snapshot.tags[n];
+			file << tag.name << ',' << tag.live_bytes << ',' << tag.peak_bytes << ',' << tag.allocations << ',' << tag.frees << ','
+				<< tag.frame_allocations << ',' << tag.frame_bytes << '\n';
+		}
+		return (bool)file;
+	}
+
+private:
+	// Written by one thread with relaxed load and store, read by anyone; the shared overflow block uses atomic adds.
+	// Frees on another thread than the allocation's count there, so only sums over threads are meaningful.
+	struct alignas(64) Counters {
+		std::array<std::atomic<u64>, MAX_TAGS> allocations;
+		std::array<std::atomic<u64>, MAX_TAGS> allocated_bytes;
+		std::array<std::atomic<u64>, MAX_TAGS> frees;
+		std::array<std::atomic<u64>, MAX_TAGS> freed_bytes;
+		bool shared;
+	};
+	struct Tag {
+		std::array<char, MAX_NAME> name;
+		u64 peak_bytes;
+		u64 frame_allocations;
+		u64 frame_bytes;
+		u64 allocations_mark;
+		u64 bytes_mark;
+	};
+	struct State {
+		std::mutex mutex;
+		std::array<Tag, MAX_TAGS> tags;
+		std::atomic<u32> tag_count;
+		std::atomic<u32> thread_count;
+		std::array<Counters, MAX_THREADS + 1> threads; // last one shared
+		u64 peak_bytes;
+		u64 frame;
+	};
+	struct Totals {
+		u32 tag_count = 0;
+		std::array<u64, MAX_TAGS> allocations{};
+		std::array<u64, MAX_TAGS> allocated_bytes{};
+		std::array<u64, MAX_TAGS> frees{};
+		std::array<u64, MAX_TAGS> freed_bytes{};
+	};
+
+	static void add(std::atomic<u64>& counter, const u64 value, const bool shared) noexcept {
+		if (shared) counter.fetch_add(value, std::memory_order_relaxed);
+		else counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+	}
+	[[nodiscard]] static Counters& threadCounters() noexcept {
+		static thread_local Counters* counters = nullptr;
+		if (counters == nullptr) {
+			const u32 index = state_.thread_count.fetch_add(1, std::memory_order_relaxed);
+			counters = &state_.threads[std::min(index, MAX_THREADS)];
+			counters->shared = index >= MAX_THREADS;
+		}
+		return *counters;
+	}
+
+	// Callers hold the mutex
+	[[nodiscard]] static Totals sum() noexcept {
+		Totals totals;
+		totals.tag_count = state_.tag_count.load(std::memory_order_acquire);
+		const u32 threads = std::min(state_.thread_count.load(std::memory_order_relaxed), MAX_THREADS) + 1;
+		for (u32 thread = 0; thread < threads; ++thread) {
+			const Counters& counters = state_.threads[thread == threads - 1 ? MAX_THREADS : thread];
+			for (u32 n = 0; n < totals.tag_count; ++n) {
+				totals.allocations[n] += counters.allocations[n].load(std::memory_order_relaxed);
+				totals.allocated_bytes[n] += counters.allocated_bytes[n].load(std::memory_order_relaxed);
+				totals.frees[n] += counters.frees[n].load(std::memory_order_relaxed);
+				totals.freed_bytes[n] += counters.freed_bytes[n].load(std::memory_order_relaxed);
+			}
+		}
+		return totals;
+	}
+	// Memory allocated before a tag was set can be freed under it, so a tag's balance may dip below zero
+	[[nodiscard]] static u64 live(const Totals& totals, const u32 tag) noexcept {
+		return totals.allocated_bytes[tag] > totals.freed_bytes[tag] ? totals.allocated_bytes[tag] - totals.freed_bytes[tag] : 0;
+	}
+	static void samplePeaks(const Totals& totals) noexcept {
+		u64 total = 0;
+		for (u32 n = 0; n < totals.tag_count; ++n) {
+			const u64 bytes = live(totals, n);
+			state_.tags[n].peak_bytes = std::max(state_.tags[n].peak_bytes, bytes);
+			total += bytes;
+		}
+		state_.peak_bytes = std::max(state_.peak_bytes, total);
+	}
+
+	static State state_;
+	static inline thread_local u32 current_ = 0;
+};
+
+// Constant-initialized: the hooks can run before any dynamic initializer
+constinit inline MemoryTracker::State MemoryTracker::state_{ .tags{ MemoryTracker::Tag{ { 'u', 'n', 't', 'a', 'g', 'g', 'e', 'd' } } }, .tag_count{ 1 } };
+
+// Bump allocator over one block. allocate() is for a single owner; allocateConcurrent() is a lock-free version that
+// is safe from any thread, at the cost of a CAS, and the two must not be mixed concurrently. reset() and rewind() must
+// not race either. Requests that don't fit go to the heap and are freed by the next reset(), which then grows the
+// block to the high-water mark, so a workload that repeats stops touching the heap after its first pass.
+// Destructors of objects created here never run.
+class LinearArena {
+public:
+	struct Marker {
+		usize offset;
+		usize overflow_count;
+	};
+
+	explicit LinearArena(const usize capacity = 64 * 1024) : capacity_(capacity) {
+		block_ = static_cast<std::byte*>(::operator new(capacity_, std::align_val_t{ 64 }));
+	}
+	~LinearArena() {
+		releaseOverflow(0);
+		::operator delete(block_, std::align_val_t{ 64 });
+	}
+
+	LinearArena(const LinearArena&) = delete;
+	LinearArena& operator=(const LinearArena&) = delete;
+
+	[[nodiscard]] void* allocate(const usize size, const usize align = alignof(std::max_align_t)) {
+		assert(std::has_single_bit(align));
+		const usize begin = (offset_.load(std::memory_order_relaxed) + align - 1) & ~(align - 1);
+		if (begin + size > capacity_) return allocateOverflow(size, align);
+		offset_.store(begin + size, std::memory_order_relaxed);
+		return block_ + begin;
+	}
+	[[nodiscard]] void* allocateConcurrent(const usize size, const usize align = alignof(std::max_align_t)) {
+		assert(std::has_single_bit(align));
+		usize offset = offset_.load(std::memory_order_relaxed);
+		for (;;) {
+			const usize begin = (offset + align - 1) & ~(align - 1);
+			if (begin + size > capacity_) return allocateOverflow(size, align);
+			if (offset_.compare_exchange_weak(offset, begin + size, std::memory_order_relaxed)) return block_ + begin;
+		}
+	}
+	// Uninitialized storage for count objects
+	template<typename T>
+	[[nodiscard]] T* allocate(const usize count) {
+		return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+	}
+	template<typename T, typename... Args>
+	[[nodiscard]] T* create(Args&&... args) {
+		return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+	}
+
+	[[nodiscard]] Marker mark() const noexcept {
+		return { offset_.load(std::memory_order_relaxed), overflow_.size() };
+	}
+	// Frees everything allocated since the marker; rewinding to an empty arena is a reset()
+	void rewind(const Marker marker) {
+		if (marker.offset == 0 && marker.overflow_count == 0) return reset();
+		releaseOverflow(marker.overflow_count);
+		offset_.store(marker.offset, std::memory_order_relaxed);
+	}
+	void reset() {
+		const usize used = offset_.load(std::memory_order_relaxed) + overflow_bytes_;
+		high_water_ = std::max(high_water_, used);
+		if (!overflow_.empty()) {
+			releaseOverflow(0);
+			::operator delete(block_, std::align_val_t{ 64 });
+			capacity_ = std::bit_ceil(high_water_);
+			block_ = static_cast<std::byte*>(::operator new(capacity_, std::align_val_t{ 64 }));
+		}
+		overflow_bytes_ = 0;
+		offset_.store(0, std::memory_order_relaxed);
+	}
+
+	// Bytes handed out since the last reset, including overflow
+	[[nodiscard]] usize used() const noexcept { return offset_.load(std::memory_order_relaxed) + overflow_bytes_; }
+	[[nodiscard]] usize capacity() const noexcept { return capacity_; }
+	[[nodiscard]] usize highWater() const noexcept { return std::max(high_water_, used()); }
+	// Heap allocations since the last reset; non-zero means the block is still growing
+	[[nodiscard]] usize overflowCount() const noexcept { return overflow_.size(); }
+
+private:
+	struct Overflow {
+		std::byte* data;
+		usize align;
+	};
+
+	[[nodiscard]] void* allocateOverflow(const usize size, const usize align) {
+		const usize overflow_align = std::max<usize>(align, 64);
+		std::byte* data = static_cast<std::byte*>(::operator new(size, std::align_val_t{ overflow_align }));
+		std::scoped_lock lock{ overflow_mutex_ };
+		overflow_.push_back({ data, overflow_align });
+		// Alignment slack, so the grown block fits the same sequence of requests
+		overflow_bytes_ += size + align - 1;
+		return data;
+	}
+	void releaseOverflow(const usize keep) noexcept {
+		for (usize n = keep; n < overflow_.size(); ++n) ::operator delete(overflow_[n].data, std::align_val_t{ overflow_[n].align });
+		overflow_.resize(keep);
+	}
+
+	std::byte* block_ = nullptr;
+	usize capacity_;
+	std::atomic<usize> offset_{ 0 };
+	usize high_water_ = 0;
+
+	std::mutex overflow_mutex_;
+	std::vector<Overflow> overflow_;
+	usize overflow_bytes_ = 0;
+};
+
+// Two arenas used on alternate frames: memory allocated during a frame stays valid through the next one, long enough
+// for anything handed from one frame to the next (or to a renderer a frame behind), and is freed wholesale by flip().
+// Allocation is safe from any thread, so systems running as jobs can share it.
+class FrameArena {
+public:
+	explicit FrameArena(const usize capacity = 1024 * 1024) : arenas_{ LinearArena{ capacity }, LinearArena{ capacity } } {}
+
+	[[nodiscard]] LinearArena& current() noexcept { return arenas_[index_]; }
+	[[nodiscard]] LinearArena& previous() noexcept { return arenas_[index_ ^ 1]; }
+
+	[[nodiscard]] void* allocate(const usize size, const usize align = alignof(std::max_align_t)) { return current().allocateConcurrent(size, align); }
+	template<typename T>
+	[[nodiscard]] T* allocate(const usize count) { return static_cast<T*>(allocate(sizeof(T) * count, alignof(T))); }
+	template<typename T, typename... Args>
+	[[nodiscard]] T* create(Args&&... args) { return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...); }
+
+	// Called between frames with no allocation in flight: frees the frame before last and makes it current
+	void flip() {
+		index_ ^= 1;
+		arenas_[index_].reset();
+		++frame_;
+	}
+	[[nodiscard]] u64 frame() const noexcept { return frame_; }
+
+private:
+	std::array<LinearArena, 2> arenas_;
+	u32 index_ = 0;
+	u64 frame_ = 0;
+};
+
+// Per-thread arena for temporaries that die with the enclosing ScratchScope
+[[nodiscard]] inline LinearArena& scratchArena() {
+	thread_local LinearArena arena{ 256 * 1024 };
+	return arena;
+}
+
+// Frees the scratch allocations made while it's alive; scopes nest like the stack
+class ScratchScope {
+public:
+	ScratchScope() : arena_(scratchArena()), marker_(arena_.mark()) {}
+	~ScratchScope() { arena_.rewind(marker_); }
+
+	ScratchScope(const ScratchScope&) = delete;
+	ScratchScope& operator=(const ScratchScope&) = delete;
+
+	[[nodiscard]] LinearArena& arena() noexcept { return arena_; }
+	template<typename T>
+	[[nodiscard]] T* allocate(const usize count) { return arena_.allocate<T>(count); }
+
+private:
+	LinearArena& arena_;
+	LinearArena::Marker marker_;
+};
+
+// Fixed-size blocks carved from 64-byte aligned pages, with an intrusive free list: O(1) allocate and free that
+// reuse memory instead of returning it. Not thread-safe; give each thread or owner its own pool.
+class BlockPool {
+public:
+	explicit BlockPool(const usize block_size, const usize blocks_per_page = 256) :
+		block_size_((std::max(block_size, sizeof(FreeBlock)) + 15) & ~usize{ 15 }), blocks_per_page_(blocks_per_page) {}
+	~BlockPool() {
+		for (std::byte* page : pages_) ::operator delete(page, std::align_val_t{ 64 });
+	}
+
+	BlockPool(const BlockPool&) = delete;
+	BlockPool& operator=(const BlockPool&) = delete;
+
+	// 16-byte aligned
+	[[nodiscard]] void* allocate() {
+		if (free_ == nullptr) grow();
+		FreeBlock* block = free_;
+		free_ = block->next;
+		++live_;
+		return block;
+	}
+	void free(void* block) noexcept {
+		assert(block != nullptr && live_ > 0);
+		free_ = new (block) FreeBlock{ free_ };
+		--live_;
+	}
+
+	[[nodiscard]] usize blockSize() const noexcept { return block_size_; }
+	[[nodiscard]] usize size() const noexcept { return live_; }
+	[[nodiscard]] usize capacity() const noexcept { return pages_.size() * blocks_per_page_; }
+
+private:
+	struct FreeBlock {
+		FreeBlock* next;
+	};
+
+	void grow() {
+		std::byte* page = static_cast<std::byte*>(::operator new(block_size_ * blocks_per_page_, std::align_val_t{ 64 }));
+		pages_.push_back(page);
+		// Threaded back to front so blocks come out in address order
+		for (usize n = blocks_per_page_; n-- > 0;) free_ = new (page + n * block_size_) FreeBlock{ free_ };
+	}
+
+	usize block_size_;
+	usize blocks_per_page_;
+	std::vector<std::byte*> pages_;
+	FreeBlock* free_ = nullptr;
+	usize live_ = 0;
+};
+
+// Typed BlockPool that constructs and destroys its objects
+template<typename T>
+class ObjectPool {
+public:
+	static_assert(alignof(T) <= 16);
+
+	explicit ObjectPool(const usize objects_per_page = 256) : pool_(sizeof(T), objects_per_page) {}
+
+	template<typename... Args>
+	[[nodiscard]] T* create(Args&&... args) {
+		return new (pool_.allocate()) T(std::forward<Args>(args)...);
+	}
+	void destroy(T* object) noexcept {
+		object->~T();
+		pool_.free(object);
+	}
+
+	[[nodiscard]] usize size() const noexcept { return pool_.size(); }
+
+private:
+	BlockPool pool_;
+};
+
+// Power-of-two size classes from 16 to 512 bytes for PoolAllocator; larger requests fall through to the heap
+class PoolSet {
+public:
+	static constexpr usize MIN_SIZE = 16;
+	static constexpr usize MAX_SIZE = 512;
+	static constexpr usize CLASSES = 6;
+
+	PoolSet() : pools_{ BlockPool{ 16 }, BlockPool{ 32 }, BlockPool{ 64 }, BlockPool{ 128 }, BlockPool{ 256 }, BlockPool{ 512, 64 } } {}
+
+	[[nodiscard]] void* allocate(const usize size, const usize align) {
+		if (size > MAX_SIZE || align > 16) return ::operator new(size, std::align_val_t{ align });
+		return pools_[sizeClass(size)].allocate();
+	}
+	void free(void* data, const usize size, const usize align) noexcept {
+		if (size > MAX_SIZE || align > 16) return ::operator delete(data, std::align_val_t{ align });
+		pools_[sizeClass(size)].free(data);
+	}
+
+	[[nodiscard]] const BlockPool& pool(const usize size_class) const noexcept { return pools_[size_class]; }
+
+private:
+	[[nodiscard]] static usize sizeClass(const usize size) noexcept {
+		return (usize)std::countr_zero(std::bit_ceil(std::max(size, MIN_SIZE))) - 4;
+	}
+
+	std::array<BlockPool, CLASSES> pools_;
+};
+
+// std allocator handing out memory from a LinearArena; deallocate() is a no-op, the arena frees everything at once.
+// For containers that live within a frame or a ScratchScope.
+template<typename T>
+class ArenaAllocator {
+public:
+	using value_type = T;
+
+	ArenaAllocator(LinearArena& arena) noexcept : arena_(&arena) {}
+	template<typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena_(other.arena_) {}
+
+	[[nodiscard]] T* allocate(const usize count) { return arena_->allocate<T>(count); }
+	void deallocate(T*, usize) noexcept {}
+
+	template<typename U>
+	[[nodiscard]] bool operator==(const ArenaAllocator<U>& other) const noexcept { return arena_ == other.arena_; }
+
+private:
+	template<typename>
+	friend class ArenaAllocator;
+
+	LinearArena* arena_;
+};
+
+// std allocator over a PoolSet, for node-based containers (map, list, unordered_map) whose nodes would otherwise be
+// one malloc each. The PoolSet must outlive the container and, like it, stay on one thread at a time.
+template<typename T>
+class PoolAllocator {
+public:
+	using value_type = T;
+
+	PoolAllocator(PoolSet& pools) noexcept : pools_(&pools) {}
+	template<typename U>
+	PoolAllocator(const PoolAllocator<U>& other) noexcept : pools_(other.pools_) {}
+
+	[[nodiscard]] T* allocate(const usize count) { return static_cast<T*>(pools_->allocate(sizeof(T) * count, alignof(T))); }
+	void deallocate(T* data, const usize count) noexcept { pools_->free(data, sizeof(T) * count, alignof(T)); }
+
+	template<typename U>
+	[[nodiscard]] bool operator==(const PoolAllocator<U>& other) const noexcept { return pools_ == other.pools_; }
+
+private:
+	template<typename>
+	friend class PoolAllocator;
+
+	PoolSet* pools_;
+};
+
+template<typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+}
+
+#if defined(MIRROR_MEMORY_TRACKING)
+// Charges heap allocations in the rest of the enclosing scope to a string literal subsystem name
+#define MIRROR_MEMORY_TAG(name) \
+	static const u32 MIRROR_MEMORY_CONCAT(mirror_memory_tag_, __LINE__) = ::Mirror::MemoryTracker::tag(name); \
+	const ::Mirror::MemoryTracker::Scope MIRROR_MEMORY_CONCAT(mirror_memory_scope_, __LINE__){ MIRROR_MEMORY_CONCAT(mirror_memory_tag_, __LINE__) }
+#define MIRROR_MEMORY_CONCAT_INNER(a, b) a##b
+#define MIRROR_MEMORY_CONCAT(a, b) MIRROR_MEMORY_CONCAT_INNER(a, b)
+#else
+#define MIRROR_MEMORY_TAG(name) ((void)0)
+#endif
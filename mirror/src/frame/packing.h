@@ -0,0 +1,293 @@
+#pragma once
+
+#include "types.h"
+#include "simd.h"
+#include "vector.h"
+#include "matrix.h"
+#include "quaternion.h"
+#include "transform.h"
+
+#include <limits>
+
+namespace Mirror {
+
+// Compact encodings for data streamed to the GPU every frame. Error bounds are the worst case over all inputs
+// in range unless noted, and are checked in the tests.
+
+// IEEE binary16, round to nearest even. Relative error <= 2^-11 for |v| in [2^-14, 65504],
+// absolute error <= 2^-25 below that, overflow becomes infinity and NaN stays NaN.
+[[nodiscard]] constexpr u16 packHalf(const f32 value) noexcept {
+	u32 bits = std::bit_cast<u32>(value);
+	const u32 sign = bits & 0x80000000u;
+	bits ^= sign;
+	u32 half;
+	if (bits >= 0x47800000u) {
+		half = bits > 0x7F800000u ? 0x7E00u : 0x7C00u;
+	} else if (bits < 0x38800000u) {
+		// Subnormal or zero: let the FPU round by adding a magic number that aligns the mantissa
+		half = std::bit_cast<u32>(std::bit_cast<f32>(bits) + std::bit_cast<f32>(0x3F000000u)) - 0x3F000000u;
+	} else {
+		const u32 odd = (bits >> 13) & 1;
+		bits += 0xC8000FFFu + odd; // rebias the exponent and round
+		half = bits >> 13;
+	}
+	return (u16)(half | (sign >> 16));
+}
+[[nodiscard]] constexpr f32 unpackHalf(const u16 half) noexcept {
+	constexpr u32 EXPONENT = 0x7C00u << 13;
+	u32 bits = (half & 0x7FFFu) << 13;
+	const u32 exponent = bits & EXPONENT;
+	bits += (127 - 15) << 23;
+	if (exponent == EXPONENT) {
+		bits += (128 - 16) << 23;
+	} else if (exponent == 0) {
+		bits += 1 << 23;
+		bits = std::bit_cast<u32>(std::bit_cast<f32>(bits) - std::bit_cast<f32>(113u << 23));
+	}
+	return std::bit_cast<f32>(bits | ((u32)(half & 0x8000u) << 16));
+}
+
+// Batch conversions, 8 lanes at a time with F16C or NEON and bit identical to the scalar versions for non-NaN input
+inline void packHalfs(const std::span<const f32> in, const std::span<u16> out) noexcept {
+	assert(out.size() >= in.size());
+	const usize count = in.size();
+	usize n = 0;
+#if defined(MIRROR_SIMD_HALF)
+	for (; n < (count & ~usize{ 7 }); n += 8) Simd::toHalf8(&in[n], &out[n]);
+#endif
+	for (; n < count; ++n) out[n] = packHalf(in[n]);
+}
+inline void unpackHalfs(const std::span<const u16> in, const std::span<f32> out) noexcept {
+	assert(out.size() >= in.size());
+	const usize count = in.size();
+	usize n = 0;
+#if defined(MIRROR_SIMD_HALF)
+	for (; n < (count & ~usize{ 7 }); n += 8) Simd::fromHalf8(&in[n], &out[n]);
+#endif
+	for (; n < count; ++n) out[n] = unpackHalf(in[n]);
+}
+
+struct Half2 {
+	u16 x, y;
+
+	[[nodiscard]] constexpr static Half2 pack(const Vec2f& v) noexcept {
+		return { packHalf(v.x), packHalf(v.y) };
+	}
+	[[nodiscard]] constexpr Vec2f unpack() const noexcept {
+		return { unpackHalf(x), unpackHalf(y) };
+	}
+};
+
+struct Half4 {
+	u16 x, y, z, w;
+
+	[[nodiscard]] constexpr static Half4 pack(const Vec4f& v) noexcept {
+		return { packHalf(v.x), packHalf(v.y), packHalf(v.z), packHalf(v.w) };
+	}
+	[[nodiscard]] constexpr Vec4f unpack() const noexcept {
+		return { unpackHalf(x), unpackHalf(y), unpackHalf(z), unpackHalf(w) };
+	}
+};
+
+// Normalized integers with Vulkan's SNORM/UNORM decoding rules. Error <= half a step: 1 / (2 * (2^bits - 1))
+// for unorm and 1 / (2 * (2^(bits - 1) - 1)) for snorm, inputs outside the range are clamped first.
+template<typename I>
+[[nodiscard]] constexpr I packSnorm(const f32 value) noexcept {
+	static_assert(std::is_signed_v<I> && std::is_integral_v<I>);
+	constexpr f32 MAX = (f32)std::numeric_limits<I>::max();
+	return (I)std::round(std::clamp(value, -1.0f, 1.0f) * MAX);
+}
+template<typename I>
+[[nodiscard]] constexpr f32 unpackSnorm(const I value) noexcept {
+	constexpr f32 MAX = (f32)std::numeric_limits<I>::max();
+	return std::max((f32)value / MAX, -1.0f);
+}
+template<typename U>
+[[nodiscard]] constexpr U packUnorm(const f32 value) noexcept {
+	static_assert(std::is_unsigned_v<U> && std::is_integral_v<U>);
+	constexpr f32 MAX = (f32)std::numeric_limits<U>::max();
+	return (U)std::round(std::clamp(value, 0.0f, 1.0f) * MAX);
+}
+template<typename U>
+[[nodiscard]] constexpr f32 unpackUnorm(const U value) noexcept {
+	constexpr f32 MAX = (f32)std::numeric_limits<U>::max();
+	return (f32)value / MAX;
+}
+
+// R8G8B8A8 layouts, x in the lowest byte
+[[nodiscard]] constexpr u32 packUnorm4x8(const Vec4f& v) noexcept {
+	return (u32)packUnorm<u8>(v.x) | ((u32)packUnorm<u8>(v.y) << 8) | ((u32)packUnorm<u8>(v.z) << 16) | ((u32)packUnorm<u8>(v.w) << 24);
+}
+[[nodiscard]] constexpr Vec4f unpackUnorm4x8(const u32 packed) noexcept {
+	return { unpackUnorm((u8)packed), unpackUnorm((u8)(packed >> 8)), unpackUnorm((u8)(packed >> 16)), unpackUnorm((u8)(packed >> 24)) };
+}
+[[nodiscard]] constexpr u32 packSnorm4x8(const Vec4f& v) noexcept {
+	return (u32)(u8)packSnorm<i8>(v.x) | ((u32)(u8)packSnorm<i8>(v.y) << 8) | ((u32)(u8)packSnorm<i8>(v.z) << 16) | ((u32)(u8)packSnorm<i8>(v.w) << 24);
+}
+[[nodiscard]] constexpr Vec4f unpackSnorm4x8(const u32 packed) noexcept {
+	return { unpackSnorm((i8)packed), unpackSnorm((i8)(packed >> 8)), unpackSnorm((i8)(packed >> 16)), unpackSnorm((i8)(packed >> 24)) };
+}
+
+// Unit vector as octahedral coordinates in two snorm16 (R16G16_SNORM), x in the low half.
+// Angular error <= 1e-4 radians.
+[[nodiscard]] constexpr u32 packNormal(const Vec3f& normal) noexcept {
+	const f32 l1 = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+	assert(l1 != 0);
+	f32 u = normal.x / l1;
+	f32 v = normal.y / l1;
+	if (normal.z < 0) {
+		const f32 fold_u = (1 - std::abs(v)) * (u >= 0 ? 1.0f : -1.0f);
+		const f32 fold_v = (1 - std::abs(u)) * (v >= 0 ? 1.0f : -1.0f);
+		u = fold_u;
+		v = fold_v;
+	}
+	return (u32)(u16)packSnorm<i16>(u) | ((u32)(u16)packSnorm<i16>(v) << 16);
+}
+[[nodiscard]] constexpr Vec3f unpackNormal(const u32 packed) noexcept {
+	Vec3f n{ unpackSnorm((i16)packed), unpackSnorm((i16)(packed >> 16)), 0 };
+	n.z = 1 - std::abs(n.x) - std::abs(n.y);
+	const f32 t = std::max(-n.z, 0.0f);
+	n.x += n.x >= 0 ? -t : t;
+	n.y += n.y >= 0 ? -t : t;
+	return n.normalized();
+}
+
+// Smallest three: drops the largest component of a unit quaternion, stores its index in the top 2 bits and the
+// other three as 10 bit fixed point in [-1/sqrt(2), 1/sqrt(2)]. Stored components are off by at most 7e-4; the rebuilt
+// one accumulates their error, worst when all four are 0.5, for component error <= 2.1e-3 and rotation error <= 0.28 degrees.
+[[nodiscard]] constexpr u32 packQuaternion(const Quatf& q) noexcept {
+	constexpr f32 RANGE = 0.70710678f;
+	u32 largest = 0;
+	for (u32 n = 1; n < 4; ++n) {
+		if (std::abs(q[n]) > std::abs(q[largest])) largest = n;
+	}
+	// q and -q are the same rotation, flip so the dropped component is positive
+	const f32 sign = q[largest] < 0 ? -1.0f : 1.0f;
+	u32 packed = largest << 30;
+	u32 shift = 20;
+	for (u32 n = 0; n < 4; ++n) {
+		if (n == largest) continue;
+		const f32 unit = std::clamp((q[n] * sign / RANGE + 1) / 2, 0.0f, 1.0f);
+		packed |= (u32)std::round(unit * 1023) << shift;
+		shift -= 10;
+	}
+	return packed;
+}
+[[nodiscard]] constexpr Quatf unpackQuaternion(const u32 packed) noexcept {
+	constexpr f32 RANGE = 0.70710678f;
+	const u32 largest = packed >> 30;
+	Quatf q;
+	f32 sum = 0;
+	u32 shift = 20;
+	for (u32 n = 0; n < 4; ++n) {
+		if (n == largest) continue;
+		const f32 c = ((f32)((packed >> shift) & 1023) / 1023 * 2 - 1) * RANGE;
+		q[n] = c;
+		sum += c * c;
+		shift -= 10;
+	}
+	q[largest] = std::sqrt(std::max(1 - sum, 0.0f));
+	return q;
+}
+
+// Affine matrix as three rows (the implied fourth is 0, 0, 0, 1): 48 bytes instead of 64 and exact.
+// On the GPU a point transforms as vec3(dot(rows[0], p), dot(rows[1], p), dot(rows[2], p)) with p.w = 1.
+template<typename T>
+struct Affine3x4 {
+	Vec4<T> rows[3];
+
+	[[nodiscard]] constexpr static Affine3x4 fromMatrix(const Mat4<T>& m) noexcept {
+		assert(m.x.w == 0 && m.y.w == 0 && m.z.w == 0 && m.w.w == 1);
+		return { { m.row(0), m.row(1), m.row(2) } };
+	}
+	[[nodiscard]] constexpr Mat4<T> matrix() const noexcept {
+		return {
+			{ rows[0].x, rows[1].x, rows[2].x, 0 },
+			{ rows[0].y, rows[1].y, rows[2].y, 0 },
+			{ rows[0].z, rows[1].z, rows[2].z, 0 },
+			{ rows[0].w, rows[1].w, rows[2].w, 1 },
+		};
+	}
+	[[nodiscard]] constexpr Vec3<T> operator*(const Vec3<T>& point) const noexcept {
+		const Vec4<T> p{ point, 1 };
+		return { rows[0].dot(p), rows[1].dot(p), rows[2].dot(p) };
+	}
+
+	// Batch conversion from affine matrices, one 4x4 transpose per matrix
+	static void fromMatrices(const std::span<const Mat4<T>> matrices, const std::span<Affine3x4> out) noexcept requires std::is_same_v<T, f32> {
+		assert(out.size() >= matrices.size());
+		for (usize n = 0; n < matrices.size(); ++n) {
+			const Mat4<T>& m = matrices[n];
+			if constexpr (Simd::ENABLED) {
+				Simd::F32x4 c0 = Simd::load(&m.x.x);
+				Simd::F32x4 c1 = Simd::load(&m.y.x);
+				Simd::F32x4 c2 = Simd::load(&m.z.x);
+				Simd::F32x4 c3 = Simd::load(&m.w.x);
+				Simd::transpose(c0, c1, c2, c3);
+				Simd::store(&out[n].rows[0].x, c0);
+				Simd::store(&out[n].rows[1].x, c1);
+				Simd::store(&out[n].rows[2].x, c2);
+			} else {
+				out[n] = fromMatrix(m);
+			}
+		}
+	}
+};
+
+using Affine3x4f = Affine3x4<f32>;
+
+// Transform3Df in 24 bytes instead of 40 (or 64 as a Mat4f): full precision position, f16 scale and a
+// smallest-three rotation. Scale carries the f16 relative error, rotation the packQuaternion() bounds.
+struct PackedTransform3D {
+	f32 position[3];
+	u32 rotation;
+	u16 scale[3];
+	u16 padding = 0;
+
+	[[nodiscard]] constexpr static PackedTransform3D pack(const Transform3Df& transform) noexcept {
+		return {
+			{ transform.position.x, transform.position.y, transform.position.z },
+			packQuaternion(transform.rotation),
+			{ packHalf(transform.scale.x), packHalf(transform.scale.y), packHalf(transform.scale.z) },
+		};
+	}
+	[[nodiscard]] constexpr Transform3Df unpack() const noexcept {
+		return {
+			{ position[0], position[1], position[2] },
+			{ unpackHalf(scale[0]), unpackHalf(scale[1]), unpackHalf(scale[2]) },
+			unpackQuaternion(rotation),
+		};
+	}
+
+	// Same inputs as Transform3Df::matrices(), with scales converted 8 lanes at a time
+	static void pack(
+		const std::span<const Vec3f> positions,
+		const std::span<const Vec3f> scales,
+		const std::span<const Quatf> rotations,
+		const std::span<PackedTransform3D> out
+	) noexcept {
+		assert(scales.size() == positions.size() && rotations.size() == positions.size() && out.size() >= positions.size());
+		constexpr usize BATCH = 256;
+		u16 halfs[BATCH * 3];
+		for (usize begin = 0; begin < positions.size(); begin += BATCH) {
+			const usize count = std::min(BATCH, positions.size() - begin);
+			packHalfs({ &scales[begin].x, count * 3 }, halfs);
+			for (usize n = 0; n < count; ++n) {
+				PackedTransform3D& packed = out[begin + n];
+				const Vec3f& position = positions[begin + n];
+				packed.position[0] = position.x;
+				packed.position[1] = position.y;
+				packed.position[2] = position.z;
+				packed.rotation = packQuaternion(rotations[begin + n]);
+				packed.scale[0] = halfs[n * 3];
+				packed.scale[1] = halfs[n * 3 + 1];
+				packed.scale[2] = halfs[n * 3 + 2];
+				packed.padding = 0;
+			}
+		}
+	}
+};
+
+static_assert(sizeof(Half4) == 8 && sizeof(Affine3x4f) == 48 && sizeof(PackedTransform3D) == 24);
+
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "types.h"
+#include "jobs.h"
+
+namespace Mirror {
+
+// Calls fn(begin, end) over ranges covering [0, count) on the shared JobSystem, with adaptive grain; see JobSystem::parallelFor
+template<typename Fn>
+void parallelFor(const usize count, const usize min_grain, const Fn& fn) {
+	JobSystem::instance().parallelFor(count, min_grain, fn);
+}
+
+// Splits [0, count) into at most thread_count contiguous chunks of at least min_chunk items and calls
+// fn(chunk, begin, end) for each as jobs on the shared JobSystem, the calling thread taking part. Chunk sizes are
+// rounded up to a multiple of 8 so SIMD kernels only see a remainder in the last chunk. Returns the number of chunks.
+template<typename Fn>
+usize parallelChunks(const usize count, const usize thread_count, const usize min_chunk, const Fn& fn) {
+	const usize max_chunks = std::min(std::max<usize>(thread_count, 1), std::max<usize>(count / std::max<usize>(min_chunk, 1), 1));
+	if (max_chunks == 1) {
+		fn(usize{ 0 }, usize{ 0 }, count);
+		return 1;
+	}
+
+	// Rounding the share up, not down, keeps the chunk count within max_chunks
+	const usize chunk_size = ((count + max_chunks - 1) / max_chunks + 7) & ~usize{ 7 };
+	const usize chunks = (count + chunk_size - 1) / chunk_size;
+	JobSystem::instance().parallelFor(chunks, 1, [&](const usize first, const usize last) {
+		for (usize chunk = first; chunk < last; ++chunk) fn(chunk, chunk * chunk_size, std::min((chunk + 1) * chunk_size, count));
+	});
+	return chunks;
+}
+
+// Runs fn(task) for every task in [0, task_count) as jobs on the shared JobSystem, the calling thread taking part
+template<typename Fn>
+void parallelTasks(const usize task_count, const Fn& fn) {
+	JobSystem::instance().parallelFor(task_count, 1, [&](const usize first, const usize last) {
+		for (usize task = first; task < last; ++task) fn(task);
+	});
+}
+
+}
@@ -0,0 +1,296 @@
+#pragma once
+
+#include "types.h"
+#include "profiler.h"
+
+#include <array>
+#include <atomic>
+#include <mutex>
+
+#if defined(__linux__) && !defined(MIRROR_NO_PERF_COUNTERS)
+#define MIRROR_PERF_EVENTS 1
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Mirror {
+
+// Hardware counters of the thread that constructs it, through Linux perf_event_open, read as one group so the values
+// are consistent with each other. Counters the kernel, CPU or VM doesn't provide (or perf_event_paranoid forbids) are
+// left out instead of failing; check available(). Elsewhere nothing is available and read() returns zeros.
+class PerfCounters {
+public:
+	enum Counter : u32 { CYCLES, INSTRUCTIONS, L1D_MISSES, LLC_MISSES, BRANCH_MISSES, TASK_CLOCK_NS, COUNTER_COUNT };
+	static constexpr std::array<const char*, COUNTER_COUNT> NAMES{
+		"cycles", "instructions", "L1d misses", "LLC misses", "branch misses", "task clock ns"
+	};
+
+	struct Values {
+		std::array<u64, COUNTER_COUNT> counts{};
+
+		[[nodiscard]] u64 operator[](const Counter counter) const noexcept { return counts[counter]; }
+		// Saturating, counters scaled for multiplexing can step back slightly
+		[[nodiscard]] Values operator-(const Values& other) const noexcept {
+			Values result;
+			for (u32 n = 0; n < COUNTER_COUNT; ++n) result.counts[n] = counts[n] > other.counts[n] ? counts[n] - other.counts[n] : 0;
+			return result;
+		}
+		Values& operator+=(const Values& other) noexcept {
+			for (u32 n = 0; n < COUNTER_COUNT; ++n) counts[n] += other.counts[n];
+			return *this;
+		}
+		[[nodiscard]] f64 instructionsPerCycle() const noexcept {
+			return counts[CYCLES] > 0 ? (f64)counts[INSTRUCTIONS] / (f64)counts[CYCLES] : 0;
+		}
+	};
+
+	PerfCounters() noexcept {
+#if defined(MIRROR_PERF_EVENTS)
+		for (u32 counter = 0; counter < COUNTER_COUNT; ++counter) {
+			perf_event_attr attr{};
+			attr.size = sizeof(attr);
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+			switch (counter) {
+				case CYCLES: attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+				case INSTRUCTIONS: attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+				case L1D_MISSES:
+					attr.type = PERF_TYPE_HW_CACHE;
+					attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+					break;
+				case LLC_MISSES: attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_CACHE_MISSES; break;
+				case BRANCH_MISSES: attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+				case TASK_CLOCK_NS: attr.type = PERF_TYPE_SOFTWARE; attr.config = PERF_COUNT_SW_TASK_CLOCK; break;
+			}
+			// The first counter that opens leads the group, the rest join it
+			const i32 fd = (i32)syscall(SYS_perf_event_open, &attr, 0, -1, leader_, 0);
+			if (fd < 0) continue;
+			if (leader_ < 0) leader_ = fd;
+			fds_[group_size_] = fd;
+			order_[group_size_++] = (Counter)counter;
+			mask_ |= 1u << counter;
+		}
+#endif
+	}
+	~PerfCounters() noexcept {
+#if defined(MIRROR_PERF_EVENTS)
+		for (u32 n = 0; n < group_size_; ++n) ::close(fds_[n]);
+#endif
+	}
+
+	PerfCounters(const PerfCounters&) = delete;
+	PerfCounters& operator=(const PerfCounters&) = delete;
+
+	[[nodiscard]] bool valid() const noexcept { return mask_ != 0; }
+	[[nodiscard]] bool available(const Counter counter) const noexcept { return (mask_ >> counter) & 1; }
+
+	// Totals since construction, scaled up when the kernel had to multiplex the group
+	[[nodiscard]] Values read() const noexcept {
+		Values values;
+#if defined(MIRROR_PERF_EVENTS)
+		if (leader_ < 0) return values;
+		// nr, time_enabled, time_running, then one value per group member
+		std::array<u64, 3 + COUNTER_COUNT> buffer{};
+		if (::read(leader_, buffer.data(), sizeof(buffer)) < (i64)(sizeof(u64) * (3 + group_size_))) return values;
+		const f64 scale = buffer[2] > 0 && buffer[2] < buffer[1] ? (f64)buffer[1] / (f64)buffer[2] : 1.0;
+		for (u32 n = 0; n < group_size_ && n < buffer[0]; ++n) {
+			values.counts[order_[n]] = scale == 1.0 ? buffer[3 + n] : (u64)((f64)buffer[3 + n] * scale);
+		}
+#endif
+		return values;
+	}
+
+private:
+	i32 leader_ = -1;
+	u32 group_size_ = 0;
+	u32 mask_ = 0;
+	std::array<i32, COUNTER_COUNT> fds_{};
+	std::array<Counter, COUNTER_COUNT> order_{};
+};
+
+// Per-zone and per-frame hardware counters. MIRROR_PERF_ZONE scopes are also profiler zones; while the monitor is
+// enabled they read their thread's counters on entry and exit and accumulate the difference per zone. Each read is a
+// syscall of around a microsecond, so place them around systems and update loops rather than small functions.
+// frame() collects every thread's zones plus the calling thread's counters over the whole frame.
+class PerfMonitor {
+public:
+	static constexpr u32 NONE = std::numeric_limits<u32>::max();
+	static constexpr usize MAX_ZONES = 64; // zones past this many aren't counted
+
+	// One per instrumented site, constant initialized
+	struct Zone {
+		const char* name;
+		std::atomic<u32> id{ NONE };
+	};
+	struct ZoneCounters {
+		const Zone* zone;
+		u32 count;
+		PerfCounters::Values values; // inclusive of nested zones
+	};
+	struct Frame {
+		u64 index = 0;
+		bool available = false; // whether the calling thread has any counters at all
+		PerfCounters::Values values; // the calling thread's counters since the previous frame
+		std::vector<ZoneCounters> zones; // zones completed since the previous frame, by first use
+	};
+
+private:
+	struct ZoneTotals {
+		u32 count = 0;
+		PerfCounters::Values values;
+	};
+	struct ThreadState {
+		PerfCounters counters;
+		std::mutex mutex; // only contended by frame()
+		std::array<ZoneTotals, MAX_ZONES> zones;
+		bool retired = false;
+	};
+
+public:
+	class Scope {
+	public:
+		explicit Scope(Zone& zone) noexcept {
+			PerfMonitor& monitor = instance();
+			if (!monitor.enabled_.load(std::memory_order_relaxed)) return;
+			ThreadState* state = threadState();
+			if (state == nullptr || !state->counters.valid()) return;
+			zone_id_ = monitor.zoneId(zone);
+			if (zone_id_ == NONE) return;
+			state_ = state;
+			begin_ = state->counters.read();
+		}
+		~Scope() noexcept {
+			if (state_ == nullptr) return;
+			const PerfCounters::Values end = state_->counters.read();
+			std::scoped_lock lock{ state_->mutex };
+			ZoneTotals& totals = state_->zones[zone_id_];
+			++totals.count;
+			totals.values += end - begin_;
+		}
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		ThreadState* state_ = nullptr;
+		u32 zone_id_ = NONE;
+		PerfCounters::Values begin_;
+	};
+
+	// Never destroyed, so threads exiting during static destruction, like the JobSystem's, can still retire
+	[[nodiscard]] static PerfMonitor& instance() {
+		static PerfMonitor& monitor = *new PerfMonitor;
+		return monitor;
+	}
+
+	// Off by default; threads open their counters the first time they enter a zone while enabled
+	void setEnabled(const bool enabled) noexcept { enabled_.store(enabled, std::memory_order_relaxed); }
+	[[nodiscard]] bool enabled() const noexcept { return enabled_.load(std::memory_order_relaxed); }
+
+	// Ends the current frame, call from one thread only, usually the main loop
+	const Frame& frame() {
+		last_frame_.index = frame_index_++;
+		last_frame_.zones.clear();
+		last_frame_.available = false;
+		last_frame_.values = {};
+		if (!enabled()) return last_frame_;
+
+		if (ThreadState* state = threadState(); state != nullptr && state->counters.valid()) {
+			const PerfCounters::Values now = state->counters.read();
+			last_frame_.available = true;
+			last_frame_.values = now - frame_begin_;
+			frame_begin_ = now;
+		}
+
+		std::array<ZoneTotals, MAX_ZONES> totals{};
+		std::scoped_lock lock{ mutex_ };
+		for (const std::unique_ptr<ThreadState>& state : states_) {
+			std::scoped_lock state_lock{ state->mutex };
+			for (u32 id = 0; id < zone_count_; ++id) {
+				totals[id].count += state->zones[id].count;
+				totals[id].values += state->zones[id].values;
+				state->zones[id] = {};
+			}
+		}
+		std::erase_if(states_, [](const std::unique_ptr<ThreadState>& state) { return state->retired; });
+		for (u32 id = 0; id < zone_count_; ++id) {
+			if (totals[id].count > 0) last_frame_.zones.push_back({ zones_[id], totals[id].count, totals[id].values });
+		}
+		return last_frame_;
+	}
+	[[nodiscard]] const Frame& lastFrame() const noexcept { return last_frame_; }
+
+private:
+	PerfMonitor() = default;
+
+	// Owned by the monitor so frame() can drain it after the thread exits; the thread's counters close with it
+	[[nodiscard]] static ThreadState* threadState() {
+		struct Handle {
+			ThreadState* state = instance().registerThread();
+			~Handle() { instance().retireThread(state); }
+		};
+		thread_local Handle handle;
+		return handle.state;
+	}
+	ThreadState* registerThread() {
+		std::scoped_lock lock{ mutex_ };
+		states_.push_back(std::make_unique<ThreadState>());
+		return states_.back().get();
+	}
+	void retireThread(ThreadState* state) {
+		std::scoped_lock lock{ mutex_ };
+		// Keep the zones of the last frame until frame() picks them up, drop the rest of the thread
+		const auto it = std::ranges::find_if(states_, [&](const auto& s) { return s.get() == state; });
+		if (it == states_.end()) return;
+		{
+			std::scoped_lock state_lock{ state->mutex };
+			if (!std::ranges::all_of(state->zones, [](const ZoneTotals& totals) { return totals.count == 0; })) {
+				state->retired = true;
+				return;
+			}
+		}
+		// Only once its mutex is unlocked; frame() can't reach the state meanwhile while mutex_ is held
+		states_.erase(it);
+	}
+
+	[[nodiscard]] u32 zoneId(Zone& zone) {
+		u32 id = zone.id.load(std::memory_order_acquire);
+		if (id == NONE) {
+			std::scoped_lock lock{ mutex_ };
+			id = zone.id.load(std::memory_order_relaxed);
+			if (id == NONE) {
+				id = zone_count_ < MAX_ZONES ? zone_count_++ : (u32)MAX_ZONES;
+				if (id < MAX_ZONES) zones_[id] = &zone;
+				zone.id.store(id, std::memory_order_release);
+			}
+		}
+		return id < MAX_ZONES ? id : NONE;
+	}
+
+	std::atomic<bool> enabled_{ false };
+	std::mutex mutex_;
+	std::vector<std::unique_ptr<ThreadState>> states_;
+	std::array<const Zone*, MAX_ZONES> zones_{};
+	u32 zone_count_ = 0;
+
+	u64 frame_index_ = 0;
+	PerfCounters::Values frame_begin_;
+	Frame last_frame_;
+};
+
+}
+
+#if defined(MIRROR_NO_PERF_COUNTERS)
+#define MIRROR_PERF_ZONE(name) MIRROR_PROFILE_ZONE(name)
+#define MIRROR_PERF_FRAME() ((void)0)
+#else
+// A profiler zone that also counts hardware events while the PerfMonitor is enabled. The counters are read outside
+// the profiler zone so its timings don't include the syscalls.
+#define MIRROR_PERF_ZONE(name) \
+	static constinit ::Mirror::PerfMonitor::Zone MIRROR_PROFILE_CONCAT(mirror_perf_zone_, __LINE__){ name }; \
+	const ::Mirror::PerfMonitor::Scope MIRROR_PROFILE_CONCAT(mirror_perf_scope_, __LINE__){ MIRROR_PROFILE_CONCAT(mirror_perf_zone_, __LINE__) }; \
+	MIRROR_PROFILE_ZONE(name)
+#define MIRROR_PERF_FRAME() ::Mirror::PerfMonitor::instance().frame()
+#endif
@@ -0,0 +1,326 @@
+#pragma once
+
+#include "types.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <string>
+
+#if !defined(MIRROR_PROFILER_STEADY_CLOCK) && (defined(__x86_64__) || defined(_M_X64))
+#define MIRROR_PROFILER_TSC 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+namespace Mirror {
+
+// Zone profiler: scopes record begin/end timestamps into a per-thread single-producer ring buffer, and frame()
+// drains every buffer on the calling thread to aggregate per-zone frame times and optionally capture a trace.
+// Recording never locks or allocates after a thread's first zone; when a buffer is full new events are dropped
+// and counted. A thread's buffer is recycled for the next new thread once it exits. Use the MIRROR_PROFILE_* macros, which compile away with MIRROR_NO_PROFILER.
+class Profiler {
+public:
+	static constexpr u32 NONE = std::numeric_limits<u32>::max();
+	static constexpr usize BUFFER_CAPACITY = 1 << 16;
+
+	// One per instrumented site, constant initialized; id is assigned by the collector on first sight
+	struct Zone {
+		const char* name;
+		const char* file;
+		u32 line;
+		u32 id = NONE;
+	};
+	struct Event {
+		const Zone* zone;
+		u64 begin, end;
+		u32 depth;
+		u32 thread;
+	};
+	struct ZoneStats {
+		const Zone* zone;
+		u32 count;
+		u32 max_depth;
+		f64 total_ms;
+		f64 max_ms;
+	};
+	struct Frame {
+		u64 index = 0;
+		f64 duration_ms = 0;
+		u64 dropped = 0; // events lost to full buffers since the previous frame
+		std::vector<ZoneStats> zones; // only zones recorded this frame, in first-seen order
+	};
+
+private:
+	struct ThreadBuffer {
+		std::unique_ptr<Event[]> events = std::make_unique<Event[]>(BUFFER_CAPACITY);
+		alignas(64) std::atomic<u64> write{ 0 };
+		std::atomic<u64> dropped{ 0 };
+		u32 depth = 0;
+		u32 index = 0; // of the thread currently recording into it
+		alignas(64) std::atomic<u64> read{ 0 };
+
+		void push(const Event& event) noexcept {
+			const u64 w = write.load(std::memory_order_relaxed);
+			if (w - read.load(std::memory_order_acquire) >= BUFFER_CAPACITY) {
+				dropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			events[w & (BUFFER_CAPACITY - 1)] = event;
+			write.store(w + 1, std::memory_order_release);
+		}
+	};
+
+public:
+	class Scope {
+	public:
+		explicit Scope(Zone& zone) noexcept : zone_(zone), buffer_(threadBuffer()), begin_(now()) {
+			++buffer_.depth;
+		}
+		~Scope() noexcept {
+			const u64 end = now();
+			buffer_.push({ &zone_, begin_, end, --buffer_.depth, buffer_.index });
+		}
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		Zone& zone_;
+		ThreadBuffer& buffer_;
+		u64 begin_;
+	};
+
+	// Never destroyed, so threads exiting during static destruction, like the JobSystem's, can still retire
+	[[nodiscard]] static Profiler& instance() {
+		static Profiler& profiler = *new Profiler;
+		return profiler;
+	}
+
+	// Raw timestamp: TSC ticks on x86-64, steady_clock nanoseconds elsewhere
+	[[nodiscard]] static u64 now() noexcept {
+#if defined(MIRROR_PROFILER_TSC)
+		return __rdtsc();
+#else
+		return (u64)std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+	}
+	[[nodiscard]] f64 toNanoseconds(const u64 ticks) const noexcept {
+		return (f64)ticks * ns_per_tick_.load(std::memory_order_relaxed);
+	}
+
+	// Zone for a name only known at runtime, such as a system's. Events and stats keep zone pointers beyond the
+	// caller's lifetime, so the profiler owns it; the same name and site always give the same zone.
+	[[nodiscard]] Zone& namedZone(const std::string_view name, const char* file, const u32 line) {
+		std::scoped_lock lock{ mutex_ };
+		for (const std::unique_ptr<NamedZone>& named : named_zones_) {
+			if (named->name == name && named->zone.file == file && named->zone.line == line) return named->zone;
+		}
+		named_zones_.push_back(std::make_unique<NamedZone>());
+		NamedZone& named = *named_zones_.back();
+		named.name = name;
+		named.zone = { named.name.c_str(), file, line };
+		return named.zone;
+	}
+
+	// Names the calling thread in traces
+	void setThreadName(const std::string_view name) {
+		ThreadBuffer& buffer = threadBuffer();
+		std::scoped_lock lock{ mutex_ };
+		thread_names_[buffer.index] = name;
+	}
+	// Buffers allocated so far: one per live thread that has recorded, plus exited threads' ones awaiting reuse
+	[[nodiscard]] usize bufferCount() const {
+		std::scoped_lock lock{ mutex_ };
+		return buffers_.size();
+	}
+
+	// Ends the current frame: drains every thread's buffer and aggregates the zones that completed since the last call.
+	// Call from one thread only, usually the main loop.
+	const Frame& frame() {
+		const u64 frame_end = now();
+		calibrate();
+		last_frame_.index = frame_index_++;
+		last_frame_.duration_ms = toNanoseconds(frame_end - frame_begin_) / 1e6;
+		last_frame_.dropped = 0;
+		last_frame_.zones.clear();
+		frame_begin_ = frame_end;
+
+		std::scoped_lock lock{ mutex_ };
+		for (const std::unique_ptr<ThreadBuffer>& buffer : buffers_) {
+			const u64 read = buffer->read.load(std::memory_order_relaxed);
+			const u64 write = buffer->write.load(std::memory_order_acquire);
+			for (u64 n = read; n < write; ++n) collect(buffer->events[n & (BUFFER_CAPACITY - 1)]);
+			buffer->read.store(write, std::memory_order_release);
+			last_frame_.dropped += buffer->dropped.exchange(0, std::memory_order_relaxed);
+		}
+		for (const u32 id : frame_zones_) {
+			ZoneStats& stats = zone_stats_[id];
+			last_frame_.zones.push_back({ stats.zone, stats.count, stats.max_depth, stats.total_ms, stats.max_ms });
+			stats = { stats.zone, 0, 0, 0, 0 };
+		}
+		frame_zones_.clear();
+		return last_frame_;
+	}
+	[[nodiscard]] const Frame& lastFrame() const noexcept { return last_frame_; }
+
+	// Events drained by frame() between start and stop are kept for writeChromeTrace()
+	void startCapture() {
+		captured_.clear();
+		capture_begin_ = now();
+		capturing_ = true;
+	}
+	void stopCapture() noexcept {
+		capturing_ = false;
+	}
+	[[nodiscard]] std::span<const Event> captured() const noexcept { return captured_; }
+
+	// Chrome trace event format, loadable in chrome://tracing and Perfetto
+	bool writeChromeTrace(const std::string& path) const {
+		std::ofstream file{ path };
+		file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+		{
+			std::scoped_lock lock{ mutex_ };
+			for (u32 thread = 0; thread < thread_names_.size(); ++thread) {
+				file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread << ",\"args\":{\"name\":\""
+					<< (thread_names_[thread].empty() ? "Thread " + std::to_string(thread) : jsonString(thread_names_[thread])) << "\"}},\n";
+			}
+		}
+		for (usize n = 0; n < captured_.size(); ++n) {
+			const Event& event = captured_[n];
+			const f64 begin_us = event.begin >= capture_begin_ ? toNanoseconds(event.begin - capture_begin_) / 1e3 : 0;
+			file << "{\"name\":\"" << jsonString(event.zone->name) << "\",\"cat\":\"zone\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+				<< ",\"ts\":" << begin_us << ",\"dur\":" << toNanoseconds(event.end - event.begin) / 1e3
+				<< ",\"args\":{\"file\":\"" << jsonPath(event.zone->file) << "\",\"line\":" << event.zone->line << "}}"
+				<< (n + 1 < captured_.size() ? ",\n" : "\n");
+		}
+		file << "]}\n";
+		return (bool)file;
+	}
+
+private:
+	Profiler() {
+		// Calibrate ticks against steady_clock over a short spin, refined on every frame()
+		calibration_ticks_ = now();
+		calibration_time_ = std::chrono::steady_clock::now();
+		while (std::chrono::steady_clock::now() - calibration_time_ < std::chrono::milliseconds(1)) {}
+		calibrate();
+		frame_begin_ = now();
+	}
+
+	[[nodiscard]] static ThreadBuffer& threadBuffer() {
+		// Hands the buffer back when the thread exits; events still in it are drained by the next frame() as usual
+		struct Registration {
+			ThreadBuffer* buffer = instance().registerThread();
+			~Registration() { instance().retireThread(*buffer); }
+		};
+		thread_local Registration registration;
+		return *registration.buffer;
+	}
+	ThreadBuffer* registerThread() {
+		std::scoped_lock lock{ mutex_ };
+		if (free_buffers_.empty()) {
+			buffers_.push_back(std::make_unique<ThreadBuffer>());
+			free_buffers_.push_back(buffers_.back().get());
+		}
+		ThreadBuffer* buffer = free_buffers_.back();
+		free_buffers_.pop_back();
+		buffer->index = (u32)thread_names_.size();
+		thread_names_.emplace_back();
+		return buffer;
+	}
+	void retireThread(ThreadBuffer& buffer) {
+		std::scoped_lock lock{ mutex_ };
+		buffer.depth = 0;
+		free_buffers_.push_back(&buffer);
+	}
+
+	void calibrate() noexcept {
+#if defined(MIRROR_PROFILER_TSC)
+		const u64 ticks = now() - calibration_ticks_;
+		const auto elapsed = std::chrono::steady_clock::now() - calibration_time_;
+		if (ticks > 0) ns_per_tick_.store((f64)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / (f64)ticks, std::memory_order_relaxed);
+#endif
+	}
+
+	void collect(const Event& event) {
+		Zone& zone = *const_cast<Zone*>(event.zone);
+		if (zone.id == NONE) {
+			zone.id = (u32)zone_stats_.size();
+			zone_stats_.push_back({ &zone, 0, 0, 0, 0 });
+		}
+		ZoneStats& stats = zone_stats_[zone.id];
+		if (stats.count == 0) frame_zones_.push_back(zone.id);
+		const f64 ms = toNanoseconds(event.end - event.begin) / 1e6;
+		++stats.count;
+		stats.max_depth = std::max(stats.max_depth, event.depth);
+		stats.total_ms += ms;
+		stats.max_ms = std::max(stats.max_ms, ms);
+		if (capturing_) captured_.push_back(event);
+	}
+
+	// Backslashes in Windows paths would be JSON escapes
+	[[nodiscard]] static std::string jsonPath(const char* path) {
+		std::string escaped;
+		for (const char* c = path; *c; ++c) escaped += *c == '\\' ? '/' : *c;
+		return escaped;
+	}
+	// Names are arbitrary text: escape quotes and backslashes, and drop control characters
+	[[nodiscard]] static std::string jsonString(const std::string_view text) {
+		std::string escaped;
+		for (const char c : text) {
+			if (c == '"' || c == '\\') escaped += '\\';
+			if ((unsigned char)c >= 0x20) escaped += c;
+		}
+		return escaped;
+	}
+
+	mutable std::mutex mutex_;
+	std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+	std::vector<ThreadBuffer*> free_buffers_; // of exited threads
+	std::vector<std::string> thread_names_; // by thread index, every thread that ever recorded
+	struct NamedZone {
+		std::string name;
+		Zone zone{ nullptr, nullptr, 0 };
+	};
+	std::vector<std::unique_ptr<NamedZone>> named_zones_;
+
+	std::atomic<f64> ns_per_tick_{ 1 };
+	u64 calibration_ticks_ = 0;
+	std::chrono::steady_clock::time_point calibration_time_;
+
+	u64 frame_index_ = 0;
+	u64 frame_begin_ = 0;
+	Frame last_frame_;
+	std::vector<ZoneStats> zone_stats_; // by Zone::id
+	std::vector<u32> frame_zones_;
+
+	bool capturing_ = false;
+	u64 capture_begin_ = 0;
+	std::vector<Event> captured_;
+};
+
+}
+
+#define MIRROR_PROFILE_CONCAT_INNER(a, b) a##b
+#define MIRROR_PROFILE_CONCAT(a, b) MIRROR_PROFILE_CONCAT_INNER(a, b)
+
+#if defined(MIRROR_NO_PROFILER)
+#define MIRROR_PROFILE_ZONE(name) ((void)0)
+#define MIRROR_PROFILE_FUNCTION() ((void)0)
+#define MIRROR_PROFILE_FRAME() ((void)0)
+#define MIRROR_PROFILE_THREAD(name) ((void)0)
+#else
+// Times the rest of the enclosing scope under a string literal name
+#define MIRROR_PROFILE_ZONE(name) \
+	static constinit ::Mirror::Profiler::Zone MIRROR_PROFILE_CONCAT(mirror_profile_zone_, __LINE__){ name, __FILE__, __LINE__ }; \
+	const ::Mirror::Profiler::Scope MIRROR_PROFILE_CONCAT(mirror_profile_scope_, __LINE__){ MIRROR_PROFILE_CONCAT(mirror_profile_zone_, __LINE__) }
+#define MIRROR_PROFILE_FUNCTION() MIRROR_PROFILE_ZONE(__func__)
+#define MIRROR_PROFILE_FRAME() ::Mirror::Profiler::instance().frame()
+#define MIRROR_PROFILE_THREAD(name) ::Mirror::Profiler::instance().setThreadName(name)
+#endif
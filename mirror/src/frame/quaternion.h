@@ -2,6 +2,9 @@
 
 #include "types.h"
 
+#include "vector.h"
+#include "matrix.h"
+
 namespace Mirror {
 
 template<typename T>
@@ -28,20 +31,35 @@ struct Quaternion {
 			axis.z * sinr,
 		};
 	}
+	// Rotation matrix of a unit quaternion, the sandwich product q * v * q*. This homogeneous form scales by |q|^2 when q
+	// isn't unit, and operator*(Vec3) then disagrees with it, so both assert unit length in debug builds.
+	[[nodiscard]] constexpr Mat3<T> matrix() const noexcept {
+		assert(unit());
+		const T rr = r * r, ii = i * i, jj = j * j, kk = k * k;
+		const T ij = i * j, ik = i * k, jk = j * k;
+		const T ri = r * i, rj = r * j, rk = r * k;
+		return {
+			{ (rr + ii) - (jj + kk), 2 * (ij + rk), 2 * (ik - rj) },
+			{ 2 * (ij - rk), (rr + jj) - (ii + kk), 2 * (jk + ri) },
+			{ 2 * (ik + rj), 2 * (jk - ri), (rr + kk) - (ii + jj) },
+		};
+	}
+	// Rotates by a unit quaternion using v + 2r(u x v) + 2u x (u x v) instead of two Hamilton products
 	[[nodiscard]] constexpr Vec3<T> operator*(const Vec3<T>& v) const noexcept {
-		Quaternion vec(0, v.x, v.y, v.z);
-		Quaternion result = *this * vec * conjugate();
-		return { result.i, result.j, result.k };
+		assert(unit());
+		const Vec3<T> u{ i, j, k };
+		const Vec3<T> t = u.cross(v) * 2;
+		return v + t * r + u.cross(t);
 	}
 	[[nodiscard]] constexpr Mat3<T> operator*(const Mat3<T>& v) const noexcept {
-		return { *this * v.x, *this * v.y, *this * v.z, };
+		return matrix() * v;
 	}
 
 	[[nodiscard]] constexpr Quaternion operator+(const Quaternion& other) const noexcept {
-		return (r + other.r, i + other.i, j + other.j, k + other.k);
+		return { r + other.r, i + other.i, j + other.j, k + other.k };
 	}
 	[[nodiscard]] constexpr Quaternion operator-(const Quaternion& other) const noexcept {
-		return (r - other.r, i - other.i, j - other.j, k - other.k);
+		return { r - other.r, i - other.i, j - other.j, k - other.k };
 	}
 	[[nodiscard]] constexpr Quaternion operator*(const Quaternion& other) const noexcept { 
 		return {
@@ -70,26 +88,23 @@ struct Quaternion {
 		return *this;
 	}
 	constexpr Quaternion& operator*=(const Quaternion& other) noexcept {
-		r = r * other.r - i * other.i - j * other.j - k * other.k;
-		i = r * other.i + i * other.r + j * other.k - k * other.j;
-		j = r * other.j - i * other.k + j * other.r + k * other.i;
-		k = r * other.k + i * other.j - j * other.i + k * other.r;
+		*this = *this * other;
 		return *this;
 	}
 
 	[[nodiscard]] constexpr Quaternion operator+(const T scalar) const noexcept {
-		return (r + scalar, i, j, k);
+		return { r + scalar, i, j, k };
 	}
 	[[nodiscard]] constexpr Quaternion operator-(const T scalar) const noexcept {
-		return (r - scalar, i, j, k);
+		return { r - scalar, i, j, k };
 	}
 
 	[[nodiscard]] constexpr Quaternion operator*(const T scalar) const noexcept {
-		return (r * scalar, i * scalar, j * scalar, k * scalar);
+		return { r * scalar, i * scalar, j * scalar, k * scalar };
 	}
 	[[nodiscard]] constexpr Quaternion operator/(const T scalar) const noexcept {
 		assert(scalar != 0);
-		return (r / scalar, i / scalar, j / scalar, k / scalar);
+		return { r / scalar, i / scalar, j / scalar, k / scalar };
 	}
 
 	constexpr Quaternion& operator+=(const T scalar) noexcept {
@@ -141,11 +156,16 @@ struct Quaternion {
 	[[nodiscard]] constexpr T absSquared() const noexcept {
 		return dot(*this);
 	}
+	// Within rounding of unit length, as rotations must be
+	[[nodiscard]] constexpr bool unit() const noexcept {
+		const T length = absSquared();
+		return length > T(0.999) && length < T(1.001);
+	}
 	[[nodiscard]] constexpr T abs() const noexcept {
 		return std::sqrt(absSquared());
 	}
 	[[nodiscard]] constexpr Quaternion normalized() const noexcept {
-		assert(r != 0 && i != 0 && j != 0 && k != 0);
+		assert(r != 0 || i != 0 || j != 0 || k != 0);
 		return *this / abs();
 	}
 	constexpr Quaternion& normalize() noexcept {
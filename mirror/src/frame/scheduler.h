@@ -0,0 +1,126 @@
+#pragma once
+
+#include "types.h"
+#include "clock.h"
+
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+namespace Mirror {
+
+// Waits for deadlines by sleeping while the remaining time comfortably exceeds the observed sleep overshoot,
+// then spinning for the rest. The overshoot estimate (mean + one standard deviation of past 1 ms sleeps) adapts
+// to the OS scheduler, so the spin stays short. On Windows the timer resolution should be raised to 1 ms.
+struct FrameLimiter {
+	f64 estimate_sec = 0.002;
+	f64 mean_sec = 0.002;
+	f64 m2 = 0;
+	u64 samples = 1;
+
+	// Time source and 1 ms sleep, replaceable so tests can run the limiter on a simulated clock
+	std::chrono::steady_clock::time_point (*clock_now)() noexcept = []() noexcept { return std::chrono::steady_clock::now(); };
+	void (*sleep_1ms)() noexcept = []() noexcept { std::this_thread::sleep_for(std::chrono::milliseconds(1)); };
+
+	void waitUntil(const std::chrono::steady_clock::time_point deadline) noexcept {
+		using namespace std::chrono;
+		while (true) {
+			const f64 remaining = duration<f64>(deadline - clock_now()).count();
+			if (remaining <= estimate_sec) break;
+
+			const auto start = clock_now();
+			sleep_1ms();
+			// Capped so a rare preemption doesn't inflate the estimate into spinning most of the frame
+			const f64 observed = std::min(duration<f64>(clock_now() - start).count(), 0.004);
+
+			// Welford's running mean and variance, restarted now and then so the estimate follows load changes
+			if (samples >= 1000) {
+				samples = 1;
+				m2 = 0;
+			}
+			++samples;
+			const f64 d = observed - mean_sec;
+			mean_sec += d / (f64)samples;
+			m2 += d * (observed - mean_sec);
+			estimate_sec = mean_sec + std::sqrt(m2 / (f64)(samples - 1));
+		}
+		while (clock_now() < deadline) spinPause();
+	}
+
+	static void spinPause() noexcept {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+		_mm_pause();
+#elif defined(__aarch64__)
+		asm volatile("yield");
+#endif
+	}
+};
+
+// Fixed-timestep loop driver on top of Clock. Each frame:
+//
+//	const u32 steps = scheduler.beginFrame();
+//	for (u32 n = 0; n < steps; ++n) simulate(scheduler.step_sec);
+//	render(scheduler.alpha()); // blend previous and current simulation state
+//	scheduler.endFrame();      // frame limiter
+//
+// Simulation cost is independent of frame rate. When frames take longer than max_steps steps the extra time is
+// dropped instead of accumulating (spiral of death), so the simulation slows down rather than falling further behind.
+struct FrameScheduler {
+	f64 step_sec = 1.0 / 60.0;
+	u32 max_steps = 8;
+	f64 target_frame_sec = 0; // 0 disables the limiter
+	f64 fixed_delta_sec = 0; // when set, every frame advances by exactly this much: deterministic steps for automated runs
+
+	Clock clock;
+	FrameLimiter limiter;
+	f64 accumulator_sec = 0;
+	f64 dropped_sec = 0; // total time discarded by the clamp
+	u64 frame = 0;
+	u64 steps = 0;
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now();
+
+	// Updates the clock and returns the number of fixed steps to simulate this frame; the clock keeps measuring real
+	// frame times for stats even with fixed_delta_sec
+	u32 beginFrame() noexcept {
+		clock.update();
+		return advance(fixed_delta_sec > 0 ? fixed_delta_sec : clock.deltaSec());
+	}
+	// The accumulator logic of beginFrame() for a given elapsed time
+	u32 advance(const f64 delta_sec) noexcept {
+		assert(step_sec > 0 && max_steps > 0);
+		++frame;
+		accumulator_sec += std::max(delta_sec, 0.0);
+		const f64 limit = step_sec * max_steps;
+		if (accumulator_sec > limit) {
+			dropped_sec += accumulator_sec - limit;
+			accumulator_sec = limit;
+		}
+		const u32 count = std::min((u32)(accumulator_sec / step_sec), max_steps);
+		accumulator_sec -= count * step_sec;
+		steps += count;
+		return count;
+	}
+	// How far rendering is between the last simulated state and the next one, in [0, 1)
+	[[nodiscard]] f64 alpha() const noexcept {
+		return std::clamp(accumulator_sec / step_sec, 0.0, 1.0);
+	}
+
+	// Waits out the rest of the target frame time. Deadlines advance by whole frames so the rate doesn't drift,
+	// and reset after a late frame instead of rushing to catch up.
+	void endFrame() noexcept {
+		if (target_frame_sec <= 0) return;
+		const auto now = limiter.clock_now();
+		deadline += std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<f64>(target_frame_sec));
+		if (deadline < now) {
+			deadline = now;
+			return;
+		}
+		limiter.waitUntil(deadline);
+	}
+};
+
+}
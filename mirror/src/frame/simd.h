@@ -0,0 +1,389 @@
+#pragma once
+
+#include "types.h"
+
+#include <bit>
+
+#if !defined(MIRROR_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define MIRROR_SIMD_SSE 1
+#include <immintrin.h>
+#elif !defined(MIRROR_NO_SIMD) && ((defined(__ARM_NEON) && defined(__aarch64__)) || defined(_M_ARM64))
+#define MIRROR_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace Mirror::Simd {
+
+// Thin wrapper over the native 4-wide f32 register. Only used from runtime paths,
+// constant evaluation always takes the scalar code in the math types.
+#if defined(MIRROR_SIMD_SSE)
+
+constexpr bool ENABLED = true;
+using F32x4 = __m128;
+
+[[nodiscard]] inline F32x4 load(const f32* p) noexcept { return _mm_loadu_ps(p); }
+inline void store(f32* p, const F32x4 v) noexcept { _mm_storeu_ps(p, v); }
+[[nodiscard]] inline F32x4 set(const f32 x, const f32 y, const f32 z, const f32 w) noexcept { return _mm_setr_ps(x, y, z, w); }
+[[nodiscard]] inline F32x4 splat(const f32 s) noexcept { return _mm_set1_ps(s); }
+
+[[nodiscard]] inline F32x4 add(const F32x4 a, const F32x4 b) noexcept { return _mm_add_ps(a, b); }
+[[nodiscard]] inline F32x4 sub(const F32x4 a, const F32x4 b) noexcept { return _mm_sub_ps(a, b); }
+[[nodiscard]] inline F32x4 mul(const F32x4 a, const F32x4 b) noexcept { return _mm_mul_ps(a, b); }
+[[nodiscard]] inline F32x4 div(const F32x4 a, const F32x4 b) noexcept { return _mm_div_ps(a, b); }
+
+// Comparisons produce all-ones lanes where true; mask() packs the lane sign bits into the low bits
+[[nodiscard]] inline F32x4 less(const F32x4 a, const F32x4 b) noexcept { return _mm_cmplt_ps(a, b); }
+[[nodiscard]] inline F32x4 bitOr(const F32x4 a, const F32x4 b) noexcept { return _mm_or_ps(a, b); }
+[[nodiscard]] inline u32 mask(const F32x4 v) noexcept { return (u32)_mm_movemask_ps(v); }
+
+template<int X, int Y, int Z, int W>
+[[nodiscard]] inline F32x4 shuffle(const F32x4 v) noexcept {
+	return _mm_shuffle_ps(v, v, _MM_SHUFFLE(W, Z, Y, X));
+}
+// { a[X], a[Y], b[Z], b[W] }
+template<int X, int Y, int Z, int W>
+[[nodiscard]] inline F32x4 shuffle(const F32x4 a, const F32x4 b) noexcept {
+	return _mm_shuffle_ps(a, b, _MM_SHUFFLE(W, Z, Y, X));
+}
+
+[[nodiscard]] inline f32 hsum(const F32x4 v) noexcept {
+	F32x4 shuf = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+	F32x4 sums = _mm_add_ps(v, shuf);
+	shuf = _mm_movehl_ps(shuf, sums);
+	return _mm_cvtss_f32(_mm_add_ss(sums, shuf));
+}
+
+inline void transpose(F32x4& a, F32x4& b, F32x4& c, F32x4& d) noexcept {
+	_MM_TRANSPOSE4_PS(a, b, c, d);
+}
+
+#elif defined(MIRROR_SIMD_NEON)
+
+constexpr bool ENABLED = true;
+using F32x4 = float32x4_t;
+
+[[nodiscard]] inline F32x4 load(const f32* p) noexcept { return vld1q_f32(p); }
+inline void store(f32* p, const F32x4 v) noexcept { vst1q_f32(p, v); }
+[[nodiscard]] inline F32x4 set(const f32 x, const f32 y, const f32 z, const f32 w) noexcept {
+	const f32 v[4]{ x, y, z, w };
+	return vld1q_f32(v);
+}
+[[nodiscard]] inline F32x4 splat(const f32 s) noexcept { return vdupq_n_f32(s); }
+
+[[nodiscard]] inline F32x4 add(const F32x4 a, const F32x4 b) noexcept { return vaddq_f32(a, b); }
+[[nodiscard]] inline F32x4 sub(const F32x4 a, const F32x4 b) noexcept { return vsubq_f32(a, b); }
+[[nodiscard]] inline F32x4 mul(const F32x4 a, const F32x4 b) noexcept { return vmulq_f32(a, b); }
+[[nodiscard]] inline F32x4 div(const F32x4 a, const F32x4 b) noexcept { return vdivq_f32(a, b); }
+
+[[nodiscard]] inline F32x4 less(const F32x4 a, const F32x4 b) noexcept { return vreinterpretq_f32_u32(vcltq_f32(a, b)); }
+[[nodiscard]] inline F32x4 bitOr(const F32x4 a, const F32x4 b) noexcept {
+	return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+}
+[[nodiscard]] inline u32 mask(const F32x4 v) noexcept {
+	const int32_t shifts[4]{ 0, 1, 2, 3 };
+	const uint32x4_t signs = vshrq_n_u32(vreinterpretq_u32_f32(v), 31);
+	return vaddvq_u32(vshlq_u32(signs, vld1q_s32(shifts)));
+}
+
+template<int X, int Y, int Z, int W>
+[[nodiscard]] inline F32x4 shuffle(const F32x4 a, const F32x4 b) noexcept {
+	F32x4 r = vdupq_n_f32(vgetq_lane_f32(a, X));
+	r = vsetq_lane_f32(vgetq_lane_f32(a, Y), r, 1);
+	r = vsetq_lane_f32(vgetq_lane_f32(b, Z), r, 2);
+	return vsetq_lane_f32(vgetq_lane_f32(b, W), r, 3);
+}
+template<int X, int Y, int Z, int W>
+[[nodiscard]] inline F32x4 shuffle(const F32x4 v) noexcept {
+	return shuffle<X, Y, Z, W>(v, v);
+}
+
+[[nodiscard]] inline f32 hsum(const F32x4 v) noexcept {
+	const float32x2_t pairs = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+	return vget_lane_f32(vpadd_f32(pairs, pairs), 0);
+}
+
+inline void transpose(F32x4& a, F32x4& b, F32x4& c, F32x4& d) noexcept {
+	const float32x4x2_t ab = vtrnq_f32(a, b);
+	const float32x4x2_t cd = vtrnq_f32(c, d);
+	a = vcombine_f32(vget_low_f32(ab.val[0]), vget_low_f32(cd.val[0]));
+	b = vcombine_f32(vget_low_f32(ab.val[1]), vget_low_f32(cd.val[1]));
+	c = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+	d = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+}
+
+#else
+
+// Portable stand-in so the vectorized paths still compile; the math types skip them when !ENABLED
+constexpr bool ENABLED = false;
+struct F32x4 { f32 v[4]; };
+
+[[nodiscard]] inline F32x4 load(const f32* p) noexcept { return { p[0], p[1], p[2], p[3] }; }
+inline void store(f32* p, const F32x4 v) noexcept { for (i32 n = 0; n < 4; ++n) p[n] = v.v[n]; }
+[[nodiscard]] inline F32x4 set(const f32 x, const f32 y, const f32 z, const f32 w) noexcept { return { x, y, z, w }; }
+[[nodiscard]] inline F32x4 splat(const f32 s) noexcept { return { s, s, s, s }; }
+
+[[nodiscard]] inline F32x4 add(const F32x4 a, const F32x4 b) noexcept {
+	return { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] };
+}
+[[nodiscard]] inline F32x4 sub(const F32x4 a, const F32x4 b) noexcept {
+	return { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] };
+}
+[[nodiscard]] inline F32x4 mul(const F32x4 a, const F32x4 b) noexcept {
+	return { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] };
+}
+[[nodiscard]] inline F32x4 div(const F32x4 a, const F32x4 b) noexcept {
+	return { a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3] };
+}
+
+[[nodiscard]] inline F32x4 less(const F32x4 a, const F32x4 b) noexcept {
+	F32x4 r;
+	for (i32 n = 0; n < 4; ++n) r.v[n] = std::bit_cast<f32>(a.v[n] < b.v[n] ? ~0u : 0u);
+	return r;
+}
+[[nodiscard]] inline F32x4 bitOr(const F32x4 a, const F32x4 b) noexcept {
+	F32x4 r;
+	for (i32 n = 0; n < 4; ++n) r.v[n] = std::bit_cast<f32>(std::bit_cast<u32>(a.v[n]) | std::bit_cast<u32>(b.v[n]));
+	return r;
+}
+[[nodiscard]] inline u32 mask(const F32x4 v) noexcept {
+	u32 bits = 0;
+	for (i32 n = 0; n < 4; ++n) bits |= (std::bit_cast<u32>(v.v[n]) >> 31) << n;
+	return bits;
+}
+
+template<int X, int Y, int Z, int W>
+[[nodiscard]] inline F32x4 shuffle(const F32x4 a, const F32x4 b) noexcept {
+	return { a.v[X], a.v[Y], b.v[Z], b.v[W] };
+}
+template<int X, int Y, int Z, int W>
+[[nodiscard]] inline F32x4 shuffle(const F32x4 v) noexcept {
+	return shuffle<X, Y, Z, W>(v, v);
+}
+
+[[nodiscard]] inline f32 hsum(const F32x4 v) noexcept {
+	return (v.v[0] + v.v[1]) + (v.v[2] + v.v[3]);
+}
+
+inline void transpose(F32x4& a, F32x4& b, F32x4& c, F32x4& d) noexcept {
+	const F32x4 ta = a, tb = b, tc = c, td = d;
+	a = { ta.v[0], tb.v[0], tc.v[0], td.v[0] };
+	b = { ta.v[1], tb.v[1], tc.v[1], td.v[1] };
+	c = { ta.v[2], tb.v[2], tc.v[2], td.v[2] };
+	d = { ta.v[3], tb.v[3], tc.v[3], td.v[3] };
+}
+
+#endif
+
+[[nodiscard]] inline f32 dot(const F32x4 a, const F32x4 b) noexcept {
+	return hsum(mul(a, b));
+}
+
+// c0 * v.x + c1 * v.y + c2 * v.z + c3 * v.w, accumulated in the same order as the scalar path
+[[nodiscard]] inline F32x4 combine(const F32x4 c0, const F32x4 c1, const F32x4 c2, const F32x4 c3, const F32x4 v) noexcept {
+	F32x4 r = mul(c0, shuffle<0, 0, 0, 0>(v));
+	r = add(r, mul(c1, shuffle<1, 1, 1, 1>(v)));
+	r = add(r, mul(c2, shuffle<2, 2, 2, 2>(v)));
+	return add(r, mul(c3, shuffle<3, 3, 3, 3>(v)));
+}
+
+[[nodiscard]] inline f32 determinant(const F32x4 a, const F32x4 b, const F32x4 c, const F32x4 d) noexcept {
+	// 2x2 minors of the first two and last two columns, paired up by Laplace expansion
+	const F32x4 lo0 = sub(
+		mul(shuffle<0, 0, 0, 1>(a), shuffle<1, 2, 3, 2>(b)),
+		mul(shuffle<0, 0, 0, 1>(b), shuffle<1, 2, 3, 2>(a))
+	);
+	const F32x4 hi0 = sub(
+		mul(shuffle<2, 1, 1, 0>(c), shuffle<3, 3, 2, 3>(d)),
+		mul(shuffle<2, 1, 1, 0>(d), shuffle<3, 3, 2, 3>(c))
+	);
+	const F32x4 lo1 = sub(
+		mul(shuffle<1, 2, 1, 2>(a), shuffle<3, 3, 3, 3>(b)),
+		mul(shuffle<1, 2, 1, 2>(b), shuffle<3, 3, 3, 3>(a))
+	);
+	const F32x4 hi1 = sub(
+		mul(shuffle<0, 0, 0, 0>(c), shuffle<2, 1, 2, 1>(d)),
+		mul(shuffle<0, 0, 0, 0>(d), shuffle<2, 1, 2, 1>(c))
+	);
+	return hsum(mul(mul(lo0, hi0), set(1, -1, 1, 1))) + hsum(mul(mul(lo1, hi1), set(-1, 1, 0, 0)));
+}
+
+namespace Detail {
+
+// 2x2 matrices packed as { m00, m01, m10, m11 }, used by the block-wise 4x4 inverse
+[[nodiscard]] inline F32x4 mat2Mul(const F32x4 a, const F32x4 b) noexcept {
+	return add(mul(a, shuffle<0, 3, 0, 3>(b)), mul(shuffle<1, 0, 3, 2>(a), shuffle<2, 1, 2, 1>(b)));
+}
+// adj(a) * b
+[[nodiscard]] inline F32x4 mat2AdjMul(const F32x4 a, const F32x4 b) noexcept {
+	return sub(mul(shuffle<3, 3, 0, 0>(a), b), mul(shuffle<1, 1, 2, 2>(a), shuffle<2, 3, 0, 1>(b)));
+}
+// a * adj(b)
+[[nodiscard]] inline F32x4 mat2MulAdj(const F32x4 a, const F32x4 b) noexcept {
+	return sub(mul(a, shuffle<3, 0, 3, 0>(b)), mul(shuffle<1, 0, 3, 2>(a), shuffle<2, 1, 2, 1>(b)));
+}
+
+}
+
+// General inverse through 2x2 blocks, see "Fast 4x4 matrix inverse with SSE SIMD, explained" (Eric Zhang).
+// The block formulas hold for either storage order, so columns go in and come out in place.
+inline void inverse(F32x4& c0, F32x4& c1, F32x4& c2, F32x4& c3) noexcept {
+	using namespace Detail;
+	const F32x4 a = shuffle<0, 1, 0, 1>(c0, c1);
+	const F32x4 b = shuffle<2, 3, 2, 3>(c0, c1);
+	const F32x4 c = shuffle<0, 1, 0, 1>(c2, c3);
+	const F32x4 d = shuffle<2, 3, 2, 3>(c2, c3);
+
+	const F32x4 block_dets = sub(
+		mul(shuffle<0, 2, 0, 2>(c0, c2), shuffle<1, 3, 1, 3>(c1, c3)),
+		mul(shuffle<1, 3, 1, 3>(c0, c2), shuffle<0, 2, 0, 2>(c1, c3))
+	);
+	const F32x4 det_a = shuffle<0, 0, 0, 0>(block_dets);
+	const F32x4 det_b = shuffle<1, 1, 1, 1>(block_dets);
+	const F32x4 det_c = shuffle<2, 2, 2, 2>(block_dets);
+	const F32x4 det_d = shuffle<3, 3, 3, 3>(block_dets);
+
+	const F32x4 d_c = mat2AdjMul(d, c);
+	const F32x4 a_b = mat2AdjMul(a, b);
+	F32x4 x = sub(mul(det_d, a), mat2Mul(b, d_c));
+	F32x4 w = sub(mul(det_a, d), mat2Mul(c, a_b));
+	F32x4 y = sub(mul(det_b, c), mat2MulAdj(d, a_b));
+	F32x4 z = sub(mul(det_c, b), mat2MulAdj(a, d_c));
+
+	const f32 trace = hsum(mul(a_b, shuffle<0, 2, 1, 3>(d_c)));
+	const F32x4 det = sub(add(mul(det_a, det_d), mul(det_b, det_c)), splat(trace));
+	const F32x4 inv_det = div(set(1, -1, -1, 1), det);
+	x = mul(x, inv_det);
+	y = mul(y, inv_det);
+	z = mul(z, inv_det);
+	w = mul(w, inv_det);
+
+	c0 = shuffle<3, 1, 3, 1>(x, y);
+	c1 = shuffle<2, 0, 2, 0>(x, y);
+	c2 = shuffle<3, 1, 3, 1>(z, w);
+	c3 = shuffle<2, 0, 2, 0>(z, w);
+}
+
+// Inverse of [ R t ; 0 1 ] with orthonormal R: [ R^T -R^T t ; 0 1 ]
+inline void rigidInverse(F32x4& c0, F32x4& c1, F32x4& c2, F32x4& c3) noexcept {
+	const F32x4 t = c3;
+	c3 = set(0, 0, 0, 1);
+	transpose(c0, c1, c2, c3);
+	c3 = sub(set(0, 0, 0, 1), combine(c0, c1, c2, splat(0), t));
+}
+
+// 8-wide f32 lanes for batch kernels. Native on AVX2 builds, otherwise a pair of F32x4.
+#if defined(MIRROR_SIMD_SSE) && defined(__AVX2__)
+#define MIRROR_SIMD_AVX2 1
+
+using F32x8 = __m256;
+
+[[nodiscard]] inline F32x8 load8(const f32* p) noexcept { return _mm256_loadu_ps(p); }
+inline void store(f32* p, const F32x8 v) noexcept { _mm256_storeu_ps(p, v); }
+[[nodiscard]] inline F32x8 splat8(const f32 s) noexcept { return _mm256_set1_ps(s); }
+[[nodiscard]] inline F32x8 gather8(const f32* base, const i32 stride) noexcept {
+	const __m256i index = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(stride));
+	return _mm256_i32gather_ps(base, index, sizeof(f32));
+}
+
+[[nodiscard]] inline F32x8 add(const F32x8 a, const F32x8 b) noexcept { return _mm256_add_ps(a, b); }
+[[nodiscard]] inline F32x8 sub(const F32x8 a, const F32x8 b) noexcept { return _mm256_sub_ps(a, b); }
+[[nodiscard]] inline F32x8 mul(const F32x8 a, const F32x8 b) noexcept { return _mm256_mul_ps(a, b); }
+[[nodiscard]] inline F32x8 less(const F32x8 a, const F32x8 b) noexcept { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+[[nodiscard]] inline F32x8 bitOr(const F32x8 a, const F32x8 b) noexcept { return _mm256_or_ps(a, b); }
+[[nodiscard]] inline u32 mask(const F32x8 v) noexcept { return (u32)_mm256_movemask_ps(v); }
+
+inline void transpose(F32x8 (&v)[8]) noexcept {
+	const F32x8 t0 = _mm256_unpacklo_ps(v[0], v[1]);
+	const F32x8 t1 = _mm256_unpackhi_ps(v[0], v[1]);
+	const F32x8 t2 = _mm256_unpacklo_ps(v[2], v[3]);
+	const F32x8 t3 = _mm256_unpackhi_ps(v[2], v[3]);
+	const F32x8 t4 = _mm256_unpacklo_ps(v[4], v[5]);
+	const F32x8 t5 = _mm256_unpackhi_ps(v[4], v[5]);
+	const F32x8 t6 = _mm256_unpacklo_ps(v[6], v[7]);
+	const F32x8 t7 = _mm256_unpackhi_ps(v[6], v[7]);
+	const F32x8 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+	const F32x8 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+	const F32x8 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+	const F32x8 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+	const F32x8 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+	const F32x8 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+	const F32x8 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+	const F32x8 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+	v[0] = _mm256_permute2f128_ps(s0, s4, 0x20);
+	v[1] = _mm256_permute2f128_ps(s1, s5, 0x20);
+	v[2] = _mm256_permute2f128_ps(s2, s6, 0x20);
+	v[3] = _mm256_permute2f128_ps(s3, s7, 0x20);
+	v[4] = _mm256_permute2f128_ps(s0, s4, 0x31);
+	v[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+	v[6] = _mm256_permute2f128_ps(s2, s6, 0x31);
+	v[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+}
+
+#else
+
+struct F32x8 { F32x4 lo, hi; };
+
+[[nodiscard]] inline F32x8 load8(const f32* p) noexcept { return { load(p), load(p + 4) }; }
+inline void store(f32* p, const F32x8 v) noexcept {
+	store(p, v.lo);
+	store(p + 4, v.hi);
+}
+[[nodiscard]] inline F32x8 splat8(const f32 s) noexcept { return { splat(s), splat(s) }; }
+[[nodiscard]] inline F32x8 gather8(const f32* base, const i32 stride) noexcept {
+	return {
+		set(base[0], base[stride], base[2 * stride], base[3 * stride]),
+		set(base[4 * stride], base[5 * stride], base[6 * stride], base[7 * stride])
+	};
+}
+
+[[nodiscard]] inline F32x8 add(const F32x8 a, const F32x8 b) noexcept { return { add(a.lo, b.lo), add(a.hi, b.hi) }; }
+[[nodiscard]] inline F32x8 sub(const F32x8 a, const F32x8 b) noexcept { return { sub(a.lo, b.lo), sub(a.hi, b.hi) }; }
+[[nodiscard]] inline F32x8 mul(const F32x8 a, const F32x8 b) noexcept { return { mul(a.lo, b.lo), mul(a.hi, b.hi) }; }
+[[nodiscard]] inline F32x8 less(const F32x8 a, const F32x8 b) noexcept { return { less(a.lo, b.lo), less(a.hi, b.hi) }; }
+[[nodiscard]] inline F32x8 bitOr(const F32x8 a, const F32x8 b) noexcept { return { bitOr(a.lo, b.lo), bitOr(a.hi, b.hi) }; }
+[[nodiscard]] inline u32 mask(const F32x8 v) noexcept { return mask(v.lo) | (mask(v.hi) << 4); }
+
+inline void transpose(F32x8 (&v)[8]) noexcept {
+	F32x4 a[4]{ v[0].lo, v[1].lo, v[2].lo, v[3].lo };
+	F32x4 b[4]{ v[4].lo, v[5].lo, v[6].lo, v[7].lo };
+	F32x4 c[4]{ v[0].hi, v[1].hi, v[2].hi, v[3].hi };
+	F32x4 d[4]{ v[4].hi, v[5].hi, v[6].hi, v[7].hi };
+	transpose(a[0], a[1], a[2], a[3]);
+	transpose(b[0], b[1], b[2], b[3]);
+	transpose(c[0], c[1], c[2], c[3]);
+	transpose(d[0], d[1], d[2], d[3]);
+	for (i32 n = 0; n < 4; ++n) {
+		v[n] = { a[n], b[n] };
+		v[n + 4] = { c[n], d[n] };
+	}
+}
+
+#endif
+
+// Hardware f32 <-> f16 conversion of 8 values, round to nearest even. F16C ships with every AVX2 CPU.
+#if defined(MIRROR_SIMD_SSE) && (defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__)))
+#define MIRROR_SIMD_HALF 1
+
+inline void toHalf8(const f32* in, u16* out) noexcept {
+	_mm_storeu_si128((__m128i*)out, _mm256_cvtps_ph(_mm256_loadu_ps(in), _MM_FROUND_TO_NEAREST_INT));
+}
+inline void fromHalf8(const u16* in, f32* out) noexcept {
+	_mm256_storeu_ps(out, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)in)));
+}
+
+#elif defined(MIRROR_SIMD_NEON)
+#define MIRROR_SIMD_HALF 1
+
+inline void toHalf8(const f32* in, u16* out) noexcept {
+	const float16x8_t h = vcombine_f16(vcvt_f16_f32(vld1q_f32(in)), vcvt_f16_f32(vld1q_f32(in + 4)));
+	vst1q_u16(out, vreinterpretq_u16_f16(h));
+}
+inline void fromHalf8(const u16* in, f32* out) noexcept {
+	const float16x8_t h = vreinterpretq_f16_u16(vld1q_u16(in));
+	vst1q_f32(out, vcvt_f32_f16(vget_low_f16(h)));
+	vst1q_f32(out + 4, vcvt_high_f32_f16(h));
+}
+
+#endif
+
+}
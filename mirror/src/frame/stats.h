@@ -0,0 +1,237 @@
+#pragma once
+
+#include "types.h"
+#include "profiler.h"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <memory>
+
+namespace Mirror {
+
+// HDR-style histogram of nanosecond durations. Every power of two is split into SUB_BUCKETS linear buckets, so any
+// value from 1 ns to ~68 s is kept to within 1/64 relative precision in a fixed table. One thread adds and removes
+// values with relaxed stores while any thread may read.
+class DurationHistogram {
+public:
+	static constexpr u32 SUB_BITS = 6;
+	static constexpr u64 SUB_BUCKETS = u64{ 1 } << SUB_BITS;
+	static constexpr u32 MAX_BITS = 36;
+	static constexpr u64 MAX_VALUE = (u64{ 1 } << MAX_BITS) - 1; // larger values are clamped
+	static constexpr usize BUCKET_COUNT = (MAX_BITS - SUB_BITS + 1) * SUB_BUCKETS;
+
+	[[nodiscard]] static constexpr usize bucket(u64 ns) noexcept {
+		ns = std::min(ns, MAX_VALUE);
+		if (ns < SUB_BUCKETS) return (usize)ns;
+		const u32 shift = (u32)std::bit_width(ns) - 1 - SUB_BITS;
+		return (usize)((shift + 1) * SUB_BUCKETS + (ns >> shift) - SUB_BUCKETS);
+	}
+	// Smallest value in the bucket
+	[[nodiscard]] static constexpr u64 bucketLow(const usize index) noexcept {
+		if (index < SUB_BUCKETS) return index;
+		const u64 shift = index / SUB_BUCKETS - 1;
+		return (SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+	}
+	[[nodiscard]] static constexpr u64 bucketWidth(const usize index) noexcept {
+		return index < SUB_BUCKETS ? 1 : u64{ 1 } << (index / SUB_BUCKETS - 1);
+	}
+
+	void add(const u64 ns) noexcept { adjust(bucket(ns), 1); }
+	void remove(const u64 ns) noexcept { adjust(bucket(ns), -1); }
+	void clear() noexcept {
+		for (usize n = 0; n < BUCKET_COUNT; ++n) counts_[n].store(0, std::memory_order_relaxed);
+		count_.store(0, std::memory_order_relaxed);
+	}
+
+	[[nodiscard]] u64 count() const noexcept { return count_.load(std::memory_order_relaxed); }
+
+	// Nearest-rank percentiles for ascending fractions ps in [0, 1], as bucket midpoints; 0 when empty
+	void percentiles(const std::span<const f64> ps, const std::span<u64> out) const noexcept {
+		assert(ps.size() == out.size() && std::ranges::is_sorted(ps));
+		std::ranges::fill(out, 0);
+		const u64 total = count();
+		if (total == 0) return;
+		usize p = 0;
+		u64 seen = 0;
+		u64 last = 0;
+		for (usize n = 0; n < BUCKET_COUNT && p < ps.size(); ++n) {
+			const u32 c = counts_[n].load(std::memory_order_relaxed);
+			if (c == 0) continue;
+			seen += c;
+			last = bucketLow(n) + bucketWidth(n) / 2;
+			for (; p < ps.size() && seen >= std::max<u64>((u64)std::ceil(ps[p] * (f64)total), 1); ++p) out[p] = last;
+		}
+		// A concurrent update can leave the buckets short of count(), the remaining ranks are the largest value seen
+		for (; p < ps.size(); ++p) out[p] = last;
+	}
+
+private:
+	void adjust(const usize index, const i32 delta) noexcept {
+		counts_[index].store(counts_[index].load(std::memory_order_relaxed) + (u32)delta, std::memory_order_relaxed);
+		count_.store(count_.load(std::memory_order_relaxed) + (u64)(i64)delta, std::memory_order_relaxed);
+	}
+
+	std::unique_ptr<std::atomic<u32>[]> counts_ = std::make_unique<std::atomic<u32>[]>(BUCKET_COUNT);
+	std::atomic<u64> count_{ 0 };
+};
+
+// Frame time statistics for spotting stutters that averages hide. Every frame time lands in a histogram over the last
+// window_frames frames and in one over everything since reset(); profiler zones get the same per zone. Feed frame
+// times by pointing Clock::stats here and zones with recordZones(). Recording is lock-free and allocation-free but
+// must stay on one thread, snapshot() may be called from any thread and sees a recent, possibly mid-frame, state.
+class FrameStats {
+public:
+	static constexpr usize MAX_ZONES = 32; // profiler zones with higher ids aren't tracked
+
+	struct Config {
+		u32 window_frames = 600; // 10 s at 60 Hz
+		f64 hitch_ms = 1000.0 / 30.0; // frames, or zone times, longer than this count as hitches
+	};
+	struct Summary {
+		u64 count = 0;
+		u64 hitches = 0;
+		f64 mean_ms = 0;
+		f64 p50_ms = 0;
+		f64 p95_ms = 0;
+		f64 p99_ms = 0;
+		f64 max_ms = 0;
+	};
+	struct ZoneSummary {
+		const char* name = nullptr;
+		Summary window; // over the last window_frames frames the zone ran in
+		Summary total;
+	};
+	struct Snapshot {
+		u64 frames = 0;
+		Summary window;
+		Summary total;
+		u32 zone_count = 0;
+		std::array<ZoneSummary, MAX_ZONES> zones; // first zone_count entries, by profiler zone id
+	};
+
+	FrameStats() : FrameStats(Config{}) {}
+	explicit FrameStats(const Config& config) : config_(config), tracks_(std::make_unique<Track[]>(MAX_ZONES + 1)) {
+		assert(config.window_frames > 0);
+		hitch_ns_ = (u64)(config.hitch_ms * 1e6);
+		for (usize n = 0; n <= MAX_ZONES; ++n) tracks_[n].samples = std::make_unique<std::atomic<u64>[]>(config.window_frames);
+	}
+
+	void record(const std::chrono::nanoseconds frame_time) noexcept {
+		record(tracks_[0], (u64)std::max<i64>(frame_time.count(), 0));
+	}
+	// Per-zone totals of a profiler frame, typically Profiler::instance().lastFrame()
+	void recordZones(const Profiler::Frame& frame) noexcept {
+		for (const Profiler::ZoneStats& stats : frame.zones) {
+			if (stats.zone->id >= MAX_ZONES) continue;
+			Track& track = tracks_[stats.zone->id + 1];
+			track.zone.store(stats.zone, std::memory_order_release);
+			record(track, (u64)(stats.total_ms * 1e6));
+		}
+	}
+	// Recording thread only
+	void reset() noexcept {
+		for (usize n = 0; n <= MAX_ZONES; ++n) {
+			Track& track = tracks_[n];
+			track.zone.store(nullptr, std::memory_order_relaxed);
+			track.window.clear();
+			track.total.clear();
+			for (u32 s = 0; s < config_.window_frames; ++s) track.samples[s].store(0, std::memory_order_relaxed);
+			track.next = 0;
+			track.window_sum.store(0, std::memory_order_relaxed);
+			track.total_sum.store(0, std::memory_order_relaxed);
+			track.window_hitches.store(0, std::memory_order_relaxed);
+			track.total_hitches.store(0, std::memory_order_relaxed);
+			track.total_max.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	[[nodiscard]] Snapshot snapshot() const noexcept {
+		Snapshot snapshot;
+		const Track& frames = tracks_[0];
+		snapshot.frames = frames.total.count();
+		snapshot.window = summarize(frames, true);
+		snapshot.total = summarize(frames, false);
+		for (usize n = 1; n <= MAX_ZONES; ++n) {
+			const Track& track = tracks_[n];
+			const Profiler::Zone* zone = track.zone.load(std::memory_order_acquire);
+			if (zone == nullptr) continue;
+			snapshot.zones[snapshot.zone_count++] = { zone->name, summarize(track, true), summarize(track, false) };
+		}
+		return snapshot;
+	}
+
+	[[nodiscard]] const Config& config() const noexcept { return config_; }
+
+private:
+	struct Track {
+		DurationHistogram window;
+		DurationHistogram total;
+		std::unique_ptr<std::atomic<u64>[]> samples; // ring of the values in the window
+		u32 next = 0;
+		std::atomic<u64> window_sum{ 0 };
+		std::atomic<u64> total_sum{ 0 };
+		std::atomic<u64> window_hitches{ 0 };
+		std::atomic<u64> total_hitches{ 0 };
+		std::atomic<u64> total_max{ 0 };
+		std::atomic<const Profiler::Zone*> zone{ nullptr };
+	};
+
+	// Single writer, so plain load/store pairs instead of read-modify-write
+	static void bump(std::atomic<u64>& value, const u64 delta) noexcept {
+		value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+	}
+
+	void record(Track& track, const u64 ns) noexcept {
+		const u64 hitch = ns > hitch_ns_ ? 1 : 0;
+		if (track.window.count() == config_.window_frames) {
+			const u64 evicted = track.samples[track.next].load(std::memory_order_relaxed);
+			track.window.remove(evicted);
+			bump(track.window_sum, 0 - evicted);
+			if (evicted > hitch_ns_) bump(track.window_hitches, 0 - u64{ 1 });
+		}
+		track.samples[track.next].store(ns, std::memory_order_relaxed);
+		track.next = track.next + 1 == config_.window_frames ? 0 : track.next + 1;
+		track.window.add(ns);
+		track.total.add(ns);
+		bump(track.window_sum, ns);
+		bump(track.total_sum, ns);
+		bump(track.window_hitches, hitch);
+		bump(track.total_hitches, hitch);
+		if (ns > track.total_max.load(std::memory_order_relaxed)) track.total_max.store(ns, std::memory_order_relaxed);
+	}
+
+	[[nodiscard]] Summary summarize(const Track& track, const bool window) const noexcept {
+		const DurationHistogram& histogram = window ? track.window : track.total;
+		Summary summary;
+		summary.count = histogram.count();
+		if (summary.count == 0) return summary;
+
+		// The window's exact maximum comes from its samples, the histogram only knows it to a bucket
+		u64 max = 0;
+		if (window) {
+			for (u32 n = 0; n < config_.window_frames; ++n) max = std::max(max, track.samples[n].load(std::memory_order_relaxed));
+		} else {
+			max = track.total_max.load(std::memory_order_relaxed);
+		}
+		static constexpr std::array<f64, 3> PERCENTILES{ 0.5, 0.95, 0.99 };
+		std::array<u64, 3> values;
+		histogram.percentiles(PERCENTILES, values);
+
+		const u64 sum = (window ? track.window_sum : track.total_sum).load(std::memory_order_relaxed);
+		summary.hitches = (window ? track.window_hitches : track.total_hitches).load(std::memory_order_relaxed);
+		summary.mean_ms = (f64)sum / (f64)summary.count / 1e6;
+		summary.p50_ms = (f64)std::min(values[0], max) / 1e6;
+		summary.p95_ms = (f64)std::min(values[1], max) / 1e6;
+		summary.p99_ms = (f64)std::min(values[2], max) / 1e6;
+		summary.max_ms = (f64)max / 1e6;
+		return summary;
+	}
+
+	Config config_;
+	u64 hitch_ns_ = 0;
+	std::unique_ptr<Track[]> tracks_; // frame times, then zones by id
+};
+
+}
@@ -0,0 +1,265 @@
+#pragma once
+
+#include "types.h"
+#include "jobs.h"
+#include "profiler.h"
+#include "memory.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+
+namespace Mirror {
+
+// Dense ids for the resource types systems declare access to
+[[nodiscard]] inline u32 nextResourceId() noexcept {
+	static std::atomic<u32> next{ 0 };
+	return next.fetch_add(1, std::memory_order_relaxed);
+}
+template<typename T>
+[[nodiscard]] u32 resourceId() noexcept {
+	static const u32 id = nextResourceId();
+	return id;
+}
+
+// Runs registered systems as a dependency graph on a JobSystem. Each system declares the resources it reads and
+// writes; a system depends on the last earlier-registered writer of everything it reads, and on the earlier readers
+// (or the last writer) of everything it writes, so conflicting systems keep their registration order and everything
+// else runs concurrently without locks. The graph is rebuilt only after systems are added or their access changes.
+//
+// Each run() times every system, records it as a profiler zone and reports the critical path: the chain of
+// dependent systems with the largest total time, which bounds the frame however many cores there are.
+class SystemScheduler {
+public:
+	static constexpr u32 NONE = std::numeric_limits<u32>::max();
+
+	struct Report {
+		u64 frame = 0;
+		f64 wall_ms = 0; // run() start to finish
+		f64 work_ms = 0; // sum of system times
+		f64 critical_path_ms = 0;
+		std::vector<u32> critical_path; // system ids, first to last
+	};
+
+	// Returned by add() to declare the system's access
+	class Builder {
+	public:
+		template<typename... Resources>
+		Builder& reads() {
+			(scheduler_.declare(id_, resourceId<Resources>(), false), ...);
+			return *this;
+		}
+		template<typename... Resources>
+		Builder& writes() {
+			(scheduler_.declare(id_, resourceId<Resources>(), true), ...);
+			return *this;
+		}
+		// For systems that must run on the thread calling run(), such as anything touching the window
+		Builder& onMainThread() {
+			scheduler_.systems_[id_]->main_thread = true;
+			return *this;
+		}
+		[[nodiscard]] u32 id() const noexcept { return id_; }
+
+	private:
+		friend class SystemScheduler;
+		Builder(SystemScheduler& scheduler, const u32 id) noexcept : scheduler_(scheduler), id_(id) {}
+
+		SystemScheduler& scheduler_;
+		u32 id_;
+	};
+
+	Builder add(const std::string_view name, std::function<void()> fn) {
+		systems_.push_back(std::make_unique<System>());
+		System& system = *systems_.back();
+		system.name = name;
+		system.fn = std::move(fn);
+		system.zone = &Profiler::instance().namedZone(system.name, __FILE__, __LINE__);
+#if defined(MIRROR_MEMORY_TRACKING)
+		system.memory_tag = MemoryTracker::tag(system.name);
+#endif
+		system.task = { this, (u32)systems_.size() - 1 };
+		graph_dirty_ = true;
+		return { *this, (u32)systems_.size() - 1 };
+	}
+
+	// Runs every system once, returns when all have finished
+	void run(JobSystem& jobs) {
+		MIRROR_PROFILE_ZONE("SystemScheduler::run");
+		if (graph_dirty_) build();
+		const auto frame_begin = std::chrono::steady_clock::now();
+		jobs_ = &jobs;
+		for (const std::unique_ptr<System>& system : systems_) system->pending.store(system->dependencies.size(), std::memory_order_relaxed);
+
+		// Main-thread systems count towards the counter like jobs, so one wait covers both
+		for (const u32 root : roots_) dispatch(root);
+		for (u32 idle = 0; !counter_.done();) {
+			if (const u32 id = popMainThread(); id != NONE) {
+				execute(id);
+				counter_.pending.fetch_sub(1, std::memory_order_acq_rel);
+				idle = 0;
+			} else if (jobs.tryRunOne()) {
+				idle = 0;
+			} else if (++idle < 64) {
+				FrameLimiter::spinPause();
+			} else {
+				std::this_thread::yield();
+			}
+		}
+		report(std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - frame_begin).count());
+	}
+
+	[[nodiscard]] usize size() const noexcept { return systems_.size(); }
+	[[nodiscard]] const std::string& name(const u32 id) const noexcept { return systems_[id]->name; }
+	// Systems id waits for, after the graph was built by run()
+	[[nodiscard]] std::span<const u32> dependencies(const u32 id) const noexcept { return systems_[id]->dependencies; }
+	// Time of the system in the last run()
+	[[nodiscard]] f64 lastMs(const u32 id) const noexcept { return systems_[id]->last_ms; }
+	[[nodiscard]] const Report& lastReport() const noexcept { return report_; }
+
+private:
+	struct Task {
+		SystemScheduler* scheduler;
+		u32 id;
+
+		void operator()() const { scheduler->execute(id); }
+	};
+	struct System {
+		std::string name;
+		std::function<void()> fn;
+		std::vector<u32> reads;
+		std::vector<u32> writes;
+		bool main_thread = false;
+		Profiler::Zone* zone = nullptr;
+		u32 memory_tag = 0;
+		Task task{};
+
+		std::vector<u32> dependencies;
+		std::vector<u32> dependents;
+		std::atomic<usize> pending{ 0 };
+		f64 last_ms = 0;
+	};
+
+	void declare(const u32 id, const u32 resource, const bool write) {
+		std::vector<u32>& list = write ? systems_[id]->writes : systems_[id]->reads;
+		if (std::ranges::find(list, resource) == list.end()) list.push_back(resource);
+		graph_dirty_ = true;
+	}
+
+	void build() {
+		u32 resource_count = 0;
+		for (const std::unique_ptr<System>& system : systems_) {
+			for (const u32 resource : system->reads) resource_count = std::max(resource_count, resource + 1);
+			for (const u32 resource : system->writes) resource_count = std::max(resource_count, resource + 1);
+			system->dependencies.clear();
+			system->dependents.clear();
+		}
+		std::vector<u32> last_writer(resource_count, NONE);
+		std::vector<std::vector<u32>> readers(resource_count);
+		for (u32 id = 0; id < systems_.size(); ++id) {
+			System& system = *systems_[id];
+			for (const u32 resource : system.reads) {
+				if (last_writer[resource] != NONE) system.dependencies.push_back(last_writer[resource]);
+				readers[resource].push_back(id);
+			}
+			for (const u32 resource : system.writes) {
+				// Readers since the last write already wait for that writer
+				bool after_readers = false;
+				for (const u32 reader : readers[resource]) {
+					if (reader == id) continue;
+					system.dependencies.push_back(reader);
+					after_readers = true;
+				}
+				if (!after_readers && last_writer[resource] != NONE) system.dependencies.push_back(last_writer[resource]);
+				last_writer[resource] = id;
+				readers[resource].clear();
+			}
+			std::ranges::sort(system.dependencies);
+			const auto [first, last] = std::ranges::unique(system.dependencies);
+			system.dependencies.erase(first, last);
+			for (const u32 dependency : system.dependencies) systems_[dependency]->dependents.push_back(id);
+		}
+		roots_.clear();
+		for (u32 id = 0; id < systems_.size(); ++id) {
+			if (systems_[id]->dependencies.empty()) roots_.push_back(id);
+		}
+		main_thread_ready_.reserve(systems_.size());
+		graph_dirty_ = false;
+	}
+
+	void dispatch(const u32 id) {
+		System& system = *systems_[id];
+		if (system.main_thread) {
+			counter_.pending.fetch_add(1, std::memory_order_relaxed);
+			std::scoped_lock lock{ main_thread_mutex_ };
+			main_thread_ready_.push_back(id);
+		} else {
+			jobs_->run(counter_, system.task);
+		}
+	}
+	[[nodiscard]] u32 popMainThread() {
+		std::scoped_lock lock{ main_thread_mutex_ };
+		if (main_thread_ready_.empty()) return NONE;
+		const u32 id = main_thread_ready_.back();
+		main_thread_ready_.pop_back();
+		return id;
+	}
+
+	void execute(const u32 id) {
+		System& system = *systems_[id];
+		const auto begin = std::chrono::steady_clock::now();
+		{
+#if !defined(MIRROR_NO_PROFILER)
+			const Profiler::Scope scope{ *system.zone };
+#endif
+#if defined(MIRROR_MEMORY_TRACKING)
+			const MemoryTracker::Scope memory{ system.memory_tag };
+#endif
+			system.fn();
+		}
+		const auto end = std::chrono::steady_clock::now();
+		system.last_ms = std::chrono::duration<f64, std::milli>(end - begin).count();
+		for (const u32 dependent : system.dependents) {
+			if (systems_[dependent]->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) dispatch(dependent);
+		}
+	}
+
+	// Longest chain by system time, ids ascend along every edge so one forward pass suffices
+	void report(const f64 wall_ms) {
+		report_.frame++;
+		report_.wall_ms = wall_ms;
+		report_.work_ms = 0;
+		report_.critical_path.clear();
+		ScratchScope scratch;
+		ArenaVector<f64> path_ms(systems_.size(), 0.0, scratch.arena());
+		ArenaVector<u32> path_previous(systems_.size(), NONE, scratch.arena());
+		u32 last = NONE;
+		for (u32 id = 0; id < systems_.size(); ++id) {
+			const System& system = *systems_[id];
+			report_.work_ms += system.last_ms;
+			for (const u32 dependency : system.dependencies) {
+				if (path_previous[id] == NONE || path_ms[dependency] > path_ms[path_previous[id]]) path_previous[id] = dependency;
+			}
+			path_ms[id] = system.last_ms + (path_previous[id] == NONE ? 0 : path_ms[path_previous[id]]);
+			if (last == NONE || path_ms[id] > path_ms[last]) last = id;
+		}
+		report_.critical_path_ms = last == NONE ? 0 : path_ms[last];
+		for (u32 id = last; id != NONE; id = path_previous[id]) report_.critical_path.push_back(id);
+		std::ranges::reverse(report_.critical_path);
+	}
+
+	std::vector<std::unique_ptr<System>> systems_; // stable addresses for jobs
+	std::vector<u32> roots_;
+	bool graph_dirty_ = false;
+
+	JobSystem* jobs_ = nullptr;
+	JobSystem::Counter counter_;
+	std::mutex main_thread_mutex_;
+	std::vector<u32> main_thread_ready_;
+
+	Report report_;
+};
+
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "types.h"
+#include "simd.h"
+#include "parallel.h"
 #include "matrix.h"
 #include "vector.h"
 #include "complex.h"
@@ -15,16 +17,43 @@ struct Transform3D {
 	Quaternion<T> rotation = { 1 };
 
 	[[nodiscard]] constexpr Mat4<T> matrix() const noexcept {
-		Mat3<T> m3{ 1 };
-		m3.x.x = scale.x;
-		m3.y.y = scale.y;
-		m3.z.z = scale.z;
-		m3 = rotation * m3;
-		Mat4<T> m4{ m3 };
-		m4.w.x = position.x;
-		m4.w.y = position.y;
-		m4.w.z = position.z;
-		return m4;
+		const Mat3<T> m3 = rotation.matrix();
+		return {
+			{ m3.x * scale.x, 0 },
+			{ m3.y * scale.y, 0 },
+			{ m3.z * scale.z, 0 },
+			{ position, 1 },
+		};
+	}
+
+	// Inverse of matrix() from the components: S^-1 R^-1 T^-1, assumes a unit rotation and non-zero scale
+	[[nodiscard]] constexpr Mat4<T> inverseMatrix() const noexcept {
+		assert(scale.x != 0 && scale.y != 0 && scale.z != 0);
+		const Mat3<T> r = rotation.conjugate().matrix();
+		const Vec3<T> inv_scale = Vec3<T>{ 1 } / scale;
+		const Mat3<T> m3{ r.x * inv_scale, r.y * inv_scale, r.z * inv_scale };
+		return {
+			{ m3.x, 0 },
+			{ m3.y, 0 },
+			{ m3.z, 0 },
+			{ -(m3 * position), 1 },
+		};
+	}
+
+	// Batched matrix() over parallel arrays, split into contiguous chunks when thread_count > 1. Rotations must be unit,
+	// asserted for every element up front since the 8-wide path doesn't go through Quaternion::matrix().
+	static void matrices(
+		const std::span<const Vec3<T>> positions,
+		const std::span<const Vec3<T>> scales,
+		const std::span<const Quaternion<T>> rotations,
+		const std::span<Mat4<T>> out,
+		const usize thread_count = 1
+	) noexcept {
+		assert(positions.size() == out.size() && scales.size() == out.size() && rotations.size() == out.size());
+		assert(std::ranges::all_of(rotations, [](const Quaternion<T>& rotation) { return rotation.unit(); }));
+		parallelChunks(out.size(), thread_count, 4096, [&](usize, const usize begin, const usize end) {
+			matricesRange(positions.data() + begin, scales.data() + begin, rotations.data() + begin, out.data() + begin, end - begin);
+		});
 	}
 
 	constexpr void translate(const Vec3<T>& delta) noexcept {
@@ -36,36 +65,206 @@ struct Transform3D {
 	constexpr void rotateInternal(const Quaternion<T>& delta) noexcept {
 		rotation = rotation * delta;
 	}
+
+private:
+	static void matricesRange(const Vec3<T>* positions, const Vec3<T>* scales, const Quaternion<T>* rotations, Mat4<T>* out, const usize count) noexcept {
+		usize n = 0;
+		if constexpr (std::is_same_v<T, f32>) {
+			// 8 objects per iteration: Quaternion::matrix() is evaluated lane-wise, then transposed back into Mat4 layout
+			using namespace Simd;
+			const F32x8 two = splat8(2);
+			for (; n + 8 <= count; n += 8) {
+				const F32x8 r = gather8(&rotations[n].r, 4);
+				const F32x8 i = gather8(&rotations[n].i, 4);
+				const F32x8 j = gather8(&rotations[n].j, 4);
+				const F32x8 k = gather8(&rotations[n].k, 4);
+				const F32x8 sx = gather8(&scales[n].x, 3);
+				const F32x8 sy = gather8(&scales[n].y, 3);
+				const F32x8 sz = gather8(&scales[n].z, 3);
+
+				const F32x8 rr = mul(r, r), ii = mul(i, i), jj = mul(j, j), kk = mul(k, k);
+				const F32x8 ij = mul(i, j), ik = mul(i, k), jk = mul(j, k);
+				const F32x8 ri = mul(r, i), rj = mul(r, j), rk = mul(r, k);
+				const F32x8 zero = splat8(0);
+
+				F32x8 lo[8]{
+					mul(sub(add(rr, ii), add(jj, kk)), sx),
+					mul(mul(two, add(ij, rk)), sx),
+					mul(mul(two, sub(ik, rj)), sx),
+					zero,
+					mul(mul(two, sub(ij, rk)), sy),
+					mul(sub(add(rr, jj), add(ii, kk)), sy),
+					mul(mul(two, add(jk, ri)), sy),
+					zero,
+				};
+				F32x8 hi[8]{
+					mul(mul(two, add(ik, rj)), sz),
+					mul(mul(two, sub(jk, ri)), sz),
+					mul(sub(add(rr, kk), add(ii, jj)), sz),
+					zero,
+					gather8(&positions[n].x, 3),
+					gather8(&positions[n].y, 3),
+					gather8(&positions[n].z, 3),
+					splat8(1),
+				};
+				transpose(lo);
+				transpose(hi);
+				for (usize lane = 0; lane < 8; ++lane) {
+					store(&out[n + lane].x.x, lo[lane]);
+					store(&out[n + lane].z.x, hi[lane]);
+				}
+			}
+		}
+		for (; n < count; ++n) {
+			out[n] = Transform3D{ positions[n], scales[n], rotations[n] }.matrix();
+		}
+	}
 };
 
 using Transform3Df = Transform3D<f32>;
 
+// 2D affine transform as a 3x2 matrix: linear part in columns x and y, translation in w
+template<typename T>
+struct Affine2D {
+	Vec2<T> x{ 1, 0 };
+	Vec2<T> y{ 0, 1 };
+	Vec2<T> w{ 0, 0 };
+
+	[[nodiscard]] constexpr Vec2<T> operator*(const Vec2<T>& point) const noexcept {
+		return x * point.x + y * point.y + w;
+	}
+	[[nodiscard]] constexpr Affine2D operator*(const Affine2D& other) const noexcept {
+		return {
+			x * other.x.x + y * other.x.y,
+			x * other.y.x + y * other.y.y,
+			*this * other.w,
+		};
+	}
+	[[nodiscard]] constexpr Affine2D inverted() const noexcept {
+		const T det = x.x * y.y - y.x * x.y;
+		assert(det != 0);
+		const Vec2<T> ix{ y.y / det, -x.y / det };
+		const Vec2<T> iy{ -y.x / det, x.x / det };
+		return { ix, iy, -(ix * w.x + iy * w.y) };
+	}
+	[[nodiscard]] constexpr Mat4<T> matrix(const T depth = 0) const noexcept {
+		return {
+			{ x, 0, 0 },
+			{ y, 0, 0 },
+			{ 0, 0, 1, 0 },
+			{ w, depth, 1 },
+		};
+	}
+};
+
+using Affine2Df = Affine2D<f32>;
+
+// Per-sprite vertex shader input, 32 bytes against 64 for a Mat4: a quad corner c lands at
+// basis_x * c.x + basis_y * c.y + position.xy with depth position.z. color is R8G8B8A8 (packUnorm4x8).
+struct SpriteInstance {
+	f32 basis_x[2];
+	f32 basis_y[2];
+	f32 position[3];
+	u32 color;
+};
+
+// The rotation is kept as a unit Complex rotor, so building matrices needs no trigonometry
 template<typename T>
 struct Transform2D {
 	Vec3<T> position = { 0 };
 	Vec2<T> scale = { 1 };
-	T radians = 0;
+	Complex<T> rotation = { 1, 0 };
 
+	[[nodiscard]] constexpr Affine2D<T> affine() const noexcept {
+		return {
+			{ rotation.r * scale.x, rotation.i * scale.x },
+			{ -rotation.i * scale.y, rotation.r * scale.y },
+			{ position.x, position.y },
+		};
+	}
 	[[nodiscard]] constexpr Mat4<T> matrix() const noexcept {
-		Mat2<T> m2{ 1 };
-		m2.x.x = scale.x;
-		m2.y.y = scale.y;
-		m2 = { cos(radians), sin(radians), -sin(radians), cos(radians) } * m2;
-		Mat4<T> m4{ m2 };
-		m4.w.x = position.x;
-		m4.w.y = position.y;
-		m4.w.z = position.z;
-		return m4;
+		return affine().matrix(position.z);
+	}
+	[[nodiscard]] T angle() const noexcept {
+		return std::atan2(rotation.i, rotation.r);
 	}
 
 	constexpr void translate(const Vec2<T>& delta) noexcept {
 		position += delta;
 	}
 	constexpr void rotate(const T angle_radians) noexcept {
-		radians += angle_radians;
+		rotate(Complex<T>::fromAngle(angle_radians));
+	}
+	// Rotates by a precomputed rotor, renormalizing so repeated steps don't drift in scale
+	constexpr void rotate(const Complex<T>& delta) noexcept {
+		rotation = (delta * rotation).normalized();
+	}
+
+	// Writes instance data for every sprite, 8 at a time; colors may be empty for opaque white
+	static void instances(
+		const std::span<const Vec3<T>> positions,
+		const std::span<const Vec2<T>> scales,
+		const std::span<const Complex<T>> rotations,
+		const std::span<const u32> colors,
+		const std::span<SpriteInstance> out,
+		const usize thread_count = 1
+	) noexcept requires std::is_same_v<T, f32> {
+		assert(positions.size() == out.size() && scales.size() == out.size() && rotations.size() == out.size());
+		assert(colors.empty() || colors.size() == out.size());
+		parallelChunks(out.size(), thread_count, 8192, [&](usize, const usize begin, const usize end) {
+			instancesRange(
+				positions.data() + begin, scales.data() + begin, rotations.data() + begin,
+				colors.empty() ? nullptr : colors.data() + begin, out.data() + begin, end - begin
+			);
+		});
+	}
+
+private:
+	static void instancesRange(
+		const Vec3<T>* positions, const Vec2<T>* scales, const Complex<T>* rotations, const u32* colors,
+		SpriteInstance* out, const usize count
+	) noexcept {
+		usize n = 0;
+		// 8 sprites per iteration computed lane-wise, the 8x8 transpose then yields one SpriteInstance per row
+		using namespace Simd;
+		for (; n + 8 <= count; n += 8) {
+			const F32x8 r = gather8(&rotations[n].r, 2);
+			const F32x8 i = gather8(&rotations[n].i, 2);
+			const F32x8 sx = gather8(&scales[n].x, 2);
+			const F32x8 sy = gather8(&scales[n].y, 2);
+			alignas(32) f32 color_bits[8];
+			if (colors) {
+				std::memcpy(color_bits, colors + n, sizeof(color_bits));
+			} else {
+				std::ranges::fill(color_bits, std::bit_cast<f32>(0xFFFFFFFFu));
+			}
+			F32x8 rows[8]{
+				mul(r, sx),
+				mul(i, sx),
+				mul(sub(splat8(0), i), sy),
+				mul(r, sy),
+				gather8(&positions[n].x, 3),
+				gather8(&positions[n].y, 3),
+				gather8(&positions[n].z, 3),
+				load8(color_bits),
+			};
+			transpose(rows);
+			for (usize lane = 0; lane < 8; ++lane) store((f32*)&out[n + lane], rows[lane]);
+		}
+		for (; n < count; ++n) {
+			const Affine2D<T> a = Transform2D{ positions[n], scales[n], rotations[n] }.affine();
+			out[n] = {
+				{ a.x.x, a.x.y },
+				{ a.y.x, a.y.y },
+				{ positions[n].x, positions[n].y, positions[n].z },
+				colors ? colors[n] : 0xFFFFFFFFu,
+			};
+		}
 	}
 };
 
 using Transform2Df = Transform2D<f32>;
 
+static_assert(sizeof(SpriteInstance) == 32);
+
 }
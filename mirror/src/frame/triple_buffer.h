@@ -0,0 +1,46 @@
+#pragma once
+
+#include "types.h"
+
+#include <array>
+#include <atomic>
+
+namespace Mirror {
+
+// Lock-free handoff of whole values from one writer thread to one reader thread. The writer fills back() and
+// publish()es it, the reader acquire()s the latest publication into front(); the third slot sits between them, so
+// neither side ever waits for the other. A publication the reader hasn't taken yet is replaced by the next one, so the
+// reader is never more than one value behind however slow it is. Each slot is owned by exactly one side at a time.
+template<typename T>
+class TripleBuffer {
+public:
+	// Writer only
+	[[nodiscard]] T& back() noexcept { return slots_[back_]; }
+	// Hands back() to the reader and takes another slot as back(), holding whatever was last written to it. True if
+	// this replaced a publication the reader never acquired.
+	bool publish() noexcept {
+		const u8 previous = middle_.exchange(back_ | FRESH, std::memory_order_acq_rel);
+		back_ = previous & INDEX;
+		return (previous & FRESH) != 0;
+	}
+
+	// Reader only: moves front() to the latest publication, false if there was none since the last call
+	bool acquire() noexcept {
+		if ((middle_.load(std::memory_order_relaxed) & FRESH) == 0) return false;
+		front_ = middle_.exchange(front_, std::memory_order_acq_rel) & INDEX;
+		return true;
+	}
+	// Reader only
+	[[nodiscard]] T& front() noexcept { return slots_[front_]; }
+
+private:
+	static constexpr u8 INDEX = 3;
+	static constexpr u8 FRESH = 4;
+
+	std::array<T, 3> slots_{};
+	u8 back_ = 0;
+	u8 front_ = 1;
+	alignas(64) std::atomic<u8> middle_{ 2 };
+};
+
+}
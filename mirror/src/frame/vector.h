@@ -2,6 +2,8 @@
 
 #include "types.h"
 
+#include "simd.h"
+
 namespace Mirror {
 
 template<typename T, iptr N>
@@ -264,6 +266,9 @@ struct Vector<T, 3> {
 	[[nodiscard]] constexpr T dot(const Vector<T, 3>& other) const noexcept {
 		return x * other.x + y * other.y + z * other.z;
 	}
+	[[nodiscard]] constexpr Vector<T, 3> cross(const Vector<T, 3>& other) const noexcept {
+		return { y * other.z - z * other.y, z * other.x - x * other.z, x * other.y - y * other.x };
+	}
 	[[nodiscard]] constexpr T lengthSquared() const noexcept {
 		return dot(*this);
 	}
@@ -415,6 +420,11 @@ struct Vector<T, 4> {
 	}
 
 	[[nodiscard]] constexpr T dot(const Vector<T, 4>& other) const noexcept {
+		if constexpr (Simd::ENABLED && std::is_same_v<T, f32>) {
+			if !consteval {
+				return Simd::dot(Simd::load(&x), Simd::load(&other.x));
+			}
+		}
 		return x * other.x + y * other.y + z * other.z + w * other.w;
 	}
 	[[nodiscard]] constexpr T lengthSquared() const noexcept {
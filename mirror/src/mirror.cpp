@@ -1,8 +1,68 @@
 #include "mirror.h"
 
+#include <cstdlib>
+
 namespace Mirror {
 
 
 
 }
 
+#if defined(MIRROR_HEAP_HOOKS)
+
+// Global allocation hooks feeding HeapMonitor and, with MIRROR_MEMORY_TRACKING, MemoryTracker. The array and
+// nothrow forms default to these, so only the plain and aligned forms and their deletes need replacing.
+
+namespace {
+
+#if defined(MIRROR_MEMORY_TRACKING)
+// Tracked blocks start with a header padded to the alignment, so the size and tag sit just before the user pointer
+[[nodiscard]] constexpr usize headerSize(const usize align) noexcept {
+	return std::max(align, Mirror::MemoryTracker::HEADER_SIZE);
+}
+#else
+[[nodiscard]] constexpr usize headerSize(usize) noexcept {
+	return 0;
+}
+#endif
+
+[[nodiscard]] void* heapAllocate(const usize size, const usize align) {
+	Mirror::HeapMonitor::onAllocate(size);
+	const usize header = headerSize(align);
+#if defined(_MSC_VER)
+	std::byte* data = static_cast<std::byte*>(align <= alignof(std::max_align_t) ? std::malloc(size + header) : _aligned_malloc(size + header, align));
+#else
+	std::byte* data = static_cast<std::byte*>(align <= alignof(std::max_align_t) ? std::malloc(size + header) : std::aligned_alloc(align, (size + header + align - 1) & ~(align - 1)));
+#endif
+	if (data == nullptr) throw std::bad_alloc{};
+#if defined(MIRROR_MEMORY_TRACKING)
+	Mirror::MemoryTracker::onAllocate(data + header - Mirror::MemoryTracker::HEADER_SIZE, size);
+#endif
+	return data + header;
+}
+
+void heapFree(void* user, const usize align) noexcept {
+	if (user == nullptr) return;
+	std::byte* data = static_cast<std::byte*>(user) - headerSize(align);
+#if defined(MIRROR_MEMORY_TRACKING)
+	Mirror::MemoryTracker::onFree(static_cast<std::byte*>(user) - Mirror::MemoryTracker::HEADER_SIZE);
+#endif
+#if defined(_MSC_VER)
+	if (align <= alignof(std::max_align_t)) std::free(data);
+	else _aligned_free(data);
+#else
+	std::free(data);
+#endif
+}
+
+}
+
+void* operator new(const usize size) { return heapAllocate(std::max<usize>(size, 1), alignof(std::max_align_t)); }
+void* operator new(const usize size, const std::align_val_t align) { return heapAllocate(std::max<usize>(size, 1), (usize)align); }
+
+void operator delete(void* data) noexcept { heapFree(data, alignof(std::max_align_t)); }
+void operator delete(void* data, usize) noexcept { heapFree(data, alignof(std::max_align_t)); }
+void operator delete(void* data, const std::align_val_t align) noexcept { heapFree(data, (usize)align); }
+void operator delete(void* data, usize, const std::align_val_t align) noexcept { heapFree(data, (usize)align); }
+
+#endif
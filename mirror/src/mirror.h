@@ -7,15 +7,81 @@ namespace Mirror {
 
 class Mirror {
 public:
+	using Headless = Reflect::Renderer::Headless;
+
 	Mirror(const Vec2<i32> window_size, const std::string_view window_name) : 
-		renderer_(window_size, window_name) {}
+		jobs_(JobSystem::instance()), renderer_(window_size, window_name) {
+		addSystems();
+	}
+	// The full update pipeline without a window, and without a GPU unless Headless::vulkan is set, for tests, soak
+	// runs and benchmarks on CI machines. Pair it with FrameScheduler::fixed_delta_sec for runs that step identically
+	// every time.
+	explicit Mirror(const Headless headless) :
+		jobs_(JobSystem::instance()), renderer_(headless) {
+		addSystems();
+	}
 
 	void update() {
-		renderer_.update();
+		{
+			MIRROR_PERF_ZONE("Mirror::update");
+			systems_.run(jobs_);
+		}
+		MIRROR_PROFILE_FRAME();
+		MIRROR_PERF_FRAME();
+#if !defined(MIRROR_NO_PROFILER)
+		stats_.recordZones(Profiler::instance().lastFrame());
+#endif
+		frame_arena_.flip();
+
+		const u64 allocations = HeapMonitor::allocations();
+		last_frame_allocations_ = allocations - heap_mark_;
+		heap_mark_ = allocations;
+#if defined(MIRROR_MEMORY_TRACKING)
+		MemoryTracker::endFrame();
+#endif
+#if defined(MIRROR_HEAP_CHECKS)
+		// Containers reach their working size during warm-up; a steady-state frame that still allocates is a regression.
+		// Only checked in builds with MIRROR_HEAP_CHECKS and without NDEBUG; others just count.
+		assert((frame_arena_.frame() <= HEAP_WARMUP_FRAMES || last_frame_allocations_ == 0) && "heap allocation in a steady-state frame");
+#endif
 	}
 
+	// Shared worker pool, started with the engine so update() never pays for thread creation
+	[[nodiscard]] JobSystem& jobs() noexcept { return jobs_; }
+	// Systems run by update(); register gameplay systems here with the resources they read and write
+	[[nodiscard]] SystemScheduler& systems() noexcept { return systems_; }
+	// Frame and zone time statistics; attach to the loop's Clock to record frame times
+	[[nodiscard]] FrameStats& stats() noexcept { return stats_; }
+	[[nodiscard]] bool headless() const noexcept { return renderer_.headless(); }
+	// Systems that submit draws to its queues declare writes<Reflect::Renderer>(); they run after the renderer, so
+	// what they submit is drawn by the next update(). renderer().setThreaded(true) moves recording and submission to a
+	// render thread that works on frame N while update() simulates frame N + 1.
+	[[nodiscard]] Reflect::Renderer& renderer() noexcept { return renderer_; }
+	[[nodiscard]] const Reflect::Renderer& renderer() const noexcept { return renderer_; }
+	// update() calls so far
+	[[nodiscard]] u64 frame() const noexcept { return frame_arena_.frame(); }
+	// Per-frame scratch memory, valid until the end of the next update()
+	[[nodiscard]] FrameArena& frameArena() noexcept { return frame_arena_; }
+	// General-heap allocations between the last two update() calls, always 0 without MIRROR_HEAP_CHECKS or
+	// MIRROR_MEMORY_TRACKING; MemoryTracker::snapshot() breaks them down by subsystem. update() asserts it stays 0
+	// after warm-up only with MIRROR_HEAP_CHECKS in a build without NDEBUG.
+	[[nodiscard]] u64 lastFrameAllocations() const noexcept { return last_frame_allocations_; }
+	// Frames in which containers may still grow to their working size
+	static constexpr u64 HEAP_WARMUP_FRAMES = 120;
+
 private:
+
+	void addSystems() {
+		systems_.add("Renderer", [this]() { renderer_.update(); }).writes<Reflect::Renderer>().onMainThread();
+	}
+
+	JobSystem& jobs_;
 	Reflect::Renderer renderer_;
+	SystemScheduler systems_;
+	FrameStats stats_;
+	FrameArena frame_arena_;
+	u64 heap_mark_ = 0;
+	u64 last_frame_allocations_ = 0;
 };
 
 }
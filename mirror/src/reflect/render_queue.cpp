@@ -0,0 +1,84 @@
+#include "render_queue.h"
+
+namespace Mirror::Reflect {
+
+RenderQueue::RenderQueue(const u32 instance_size, const u32 capacity) : instance_size_(instance_size) {
+	assert(instance_size > 0);
+	if (capacity > 0) {
+		capacity_ = capacity;
+		instances_ = std::make_unique_for_overwrite<std::byte[]>(capacity_ * instance_size_);
+		draws_.reserve(capacity_);
+	}
+}
+
+void RenderQueue::grow() {
+	const usize capacity = std::max<usize>(capacity_ * 2, 1024);
+	std::unique_ptr<std::byte[]> instances = std::make_unique_for_overwrite<std::byte[]>(capacity * instance_size_);
+	if (capacity_ > 0) std::memcpy(instances.get(), instances_.get(), draws_.size() * instance_size_);
+	instances_ = std::move(instances);
+	draws_.reserve(capacity);
+	capacity_ = capacity;
+}
+
+void RenderQueue::sort() {
+	MIRROR_PROFILE_ZONE("RenderQueue::sort");
+	constexpr u32 DIGIT_BITS = 8;
+	constexpr u32 PASSES = 64 / DIGIT_BITS;
+	constexpr u32 BUCKETS = 1 << DIGIT_BITS;
+
+	const usize count = draws_.size();
+	if (count < 2) return;
+	scratch_.resize(count);
+
+	// Every pass's histogram in one read of the keys
+	std::array<std::array<u32, BUCKETS>, PASSES> histograms{};
+	for (const Draw& draw : draws_) {
+		for (u32 pass = 0; pass < PASSES; ++pass) ++histograms[pass][(draw.key >> (pass * DIGIT_BITS)) & (BUCKETS - 1)];
+	}
+
+	Draw* source = draws_.data();
+	Draw* destination = scratch_.data();
+	for (u32 pass = 0; pass < PASSES; ++pass) {
+		const u32 shift = pass * DIGIT_BITS;
+		std::array<u32, BUCKETS>& offsets = histograms[pass];
+		// A digit every key shares leaves the order unchanged; with few layers and pipelines most high passes skip
+		if (offsets[(source[0].key >> shift) & (BUCKETS - 1)] == count) continue;
+
+		u32 sum = 0;
+		for (u32& offset : offsets) sum += std::exchange(offset, sum);
+		for (usize n = 0; n < count; ++n) destination[offsets[(source[n].key >> shift) & (BUCKETS - 1)]++] = source[n];
+		std::swap(source, destination);
+	}
+	if (source != draws_.data()) draws_.swap(scratch_);
+}
+
+std::span<const RenderQueue::Batch> RenderQueue::batch(std::byte* const destination) {
+	MIRROR_PROFILE_ZONE("RenderQueue::batch");
+	batches_.clear();
+	const std::byte* const instances = instances_.get();
+	for (usize n = 0; n < draws_.size(); ++n) {
+		const Draw& draw = draws_[n];
+		std::memcpy(destination + n * instance_size_, instances + (usize)draw.index * instance_size_, instance_size_);
+		const DrawKey key{ draw.key };
+		if (batches_.empty() || batches_.back().key.state() != key.state()) batches_.push_back({ key, (u32)n, 0 });
+		++batches_.back().instance_count;
+	}
+	return batches_;
+}
+
+Vk::UploadRing::Allocation RenderQueue::batch(Vk::UploadRing& ring) {
+	if (draws_.empty()) {
+		batches_.clear();
+		return {};
+	}
+	const Vk::UploadRing::Allocation allocation = ring.allocate(draws_.size() * instance_size_);
+	if (!allocation) {
+		batches_.clear();
+		dropped_ += draws_.size();
+		return {};
+	}
+	batch(allocation.data);
+	return allocation;
+}
+
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "frame/frame.h"
+#include "vk/vk_resources.h"
+
+namespace Mirror::Reflect {
+
+// 64-bit sort key, most significant field first: layer, pipeline, material, depth. Sorting by it groups draws by
+// state, cheapest changes innermost, and orders them by depth within each state. Meshes fold their mesh into the
+// material id, since instances of different meshes can't share a draw.
+struct DrawKey {
+	static constexpr u32 LAYER_BITS = 8;
+	static constexpr u32 PIPELINE_BITS = 12;
+	static constexpr u32 MATERIAL_BITS = 20;
+	static constexpr u32 DEPTH_BITS = 24;
+	static_assert(LAYER_BITS + PIPELINE_BITS + MATERIAL_BITS + DEPTH_BITS == 64);
+
+	enum struct Order : u8 {
+		FRONT_TO_BACK, // opaque: nearest first, for early depth rejection
+		BACK_TO_FRONT, // blended: farthest first
+	};
+
+	u64 value = 0;
+
+	// depth is view distance, any non-negative value; ids must fit their fields
+	[[nodiscard]] static constexpr DrawKey make(const u32 layer, const u32 pipeline, const u32 material, const f32 depth = 0, const Order order = Order::FRONT_TO_BACK) noexcept {
+		assert(layer < (1u << LAYER_BITS) && pipeline < (1u << PIPELINE_BITS) && material < (1u << MATERIAL_BITS));
+		return { (u64)layer << (PIPELINE_BITS + MATERIAL_BITS + DEPTH_BITS)
+			| (u64)pipeline << (MATERIAL_BITS + DEPTH_BITS)
+			| (u64)material << DEPTH_BITS
+			| quantizeDepth(depth, order) };
+	}
+	// The bits of a non-negative f32 sort like its value, so the top 24 of its 31 keep the order without knowing the
+	// depth range: 8 exponent bits and 16 of mantissa, a relative precision of 2^-16 at any distance
+	[[nodiscard]] static constexpr u32 quantizeDepth(const f32 depth, const Order order) noexcept {
+		const u32 bits = depth > 0 ? std::bit_cast<u32>(depth) >> (31 - DEPTH_BITS) : 0;
+		return order == Order::FRONT_TO_BACK ? bits : ~bits & ((1u << DEPTH_BITS) - 1);
+	}
+
+	[[nodiscard]] constexpr u32 layer() const noexcept { return (u32)(value >> (PIPELINE_BITS + MATERIAL_BITS + DEPTH_BITS)); }
+	[[nodiscard]] constexpr u32 pipeline() const noexcept { return (u32)(value >> (MATERIAL_BITS + DEPTH_BITS)) & ((1u << PIPELINE_BITS) - 1); }
+	[[nodiscard]] constexpr u32 material() const noexcept { return (u32)(value >> DEPTH_BITS) & ((1u << MATERIAL_BITS) - 1); }
+	[[nodiscard]] constexpr u32 depth() const noexcept { return (u32)value & ((1u << DEPTH_BITS) - 1); }
+	// Layer, pipeline and material: draws with the same state can be instanced together
+	[[nodiscard]] constexpr u64 state() const noexcept { return value >> DEPTH_BITS; }
+
+	[[nodiscard]] constexpr auto operator<=>(const DrawKey&) const noexcept = default;
+};
+
+// Per-instance data of the mesh pipelines; sprites use SpriteInstance, written by Transform2D::instances()
+struct MeshInstance {
+	Affine3x4f transform;
+};
+static_assert(sizeof(MeshInstance) == 48);
+
+// Collects a frame's draws of one instance format and turns them into as few draw calls as possible. submit() records
+// a key and copies the instance data, sort() orders the keys with a stable LSD radix sort, and batch() gathers the
+// instance data in sorted order, straight into the upload ring, merging each run of equal state into one instanced
+// draw. Storage grows to the largest frame seen and is reused after that.
+class RenderQueue {
+public:
+	struct Batch {
+		DrawKey key; // of the first instance; layer, pipeline and material hold for the whole batch
+		u32 first_instance = 0; // index into the batched instance data
+		u32 instance_count = 0;
+	};
+
+	explicit RenderQueue(u32 instance_size, u32 capacity = 0);
+
+	void submit(const DrawKey key, const void* instance) {
+		if (draws_.size() == capacity_) grow();
+		std::memcpy(instances_.get() + draws_.size() * instance_size_, instance, instance_size_);
+		draws_.push_back({ key.value, (u32)draws_.size() });
+	}
+	template<typename T>
+	void submit(const DrawKey key, const T& instance) {
+		static_assert(std::is_trivially_copyable_v<T>);
+		assert(sizeof(T) == instance_size_);
+		submit(key, (const void*)&instance);
+	}
+
+	// Orders the draws by key; draws with equal keys keep their submission order
+	void sort();
+	// Writes the instance data in draw order to destination, size() * instanceSize() bytes, and merges runs of equal
+	// state into batches. Call after sort().
+	std::span<const Batch> batch(std::byte* destination);
+	// The same into ring, returning where the instance data went: bind the ring's buffer at its offset as the
+	// per-instance vertex buffer and issue each batch with its first_instance. Empty, with no batches and every draw
+	// counted as dropped, when the ring is full.
+	Vk::UploadRing::Allocation batch(Vk::UploadRing& ring);
+	// Empties the queue for the next frame; batches() stays valid until the next batch()
+	void clear() noexcept { draws_.clear(); }
+
+	[[nodiscard]] usize size() const noexcept { return draws_.size(); }
+	[[nodiscard]] bool empty() const noexcept { return draws_.empty(); }
+	[[nodiscard]] u32 instanceSize() const noexcept { return instance_size_; }
+	// Key of the n-th draw, in sorted order after sort()
+	[[nodiscard]] DrawKey key(const usize n) const noexcept { return { draws_[n].key }; }
+	// From the last batch() call
+	[[nodiscard]] std::span<const Batch> batches() const noexcept { return batches_; }
+	// Draws lost to a full upload ring
+	[[nodiscard]] u64 dropped() const noexcept { return dropped_; }
+
+private:
+	struct Draw {
+		u64 key;
+		u32 index; // into instances_, in submission order
+	};
+
+	u32 instance_size_;
+	usize capacity_ = 0;
+	std::unique_ptr<std::byte[]> instances_;
+	std::vector<Draw> draws_;
+	std::vector<Draw> scratch_; // the radix sort's second buffer
+	std::vector<Batch> batches_;
+	u64 dropped_ = 0;
+
+	void grow();
+};
+
+}
@@ -2,8 +2,175 @@
 
 namespace Mirror::Reflect {
 
-void Renderer::render() {
-	
+Renderer::~Renderer() noexcept {
+	try {
+		setThreaded(false);
+	} catch (...) {
+		// A render thread error nobody collected; the thread has stopped either way
+	}
+}
+
+void Renderer::update() {
+	MIRROR_PROFILE_ZONE("Renderer::update");
+	if (threaded()) rethrowRenderError();
+	RenderSnapshot& snapshot = snapshots.back();
+	snapshot.frame = frame_count++;
+	snapshot.view_projection = camera;
+	++latency_stats.published;
+
+	if (threaded()) {
+		if (snapshots.publish()) ++latency_stats.dropped;
+		publications.fetch_add(1, std::memory_order_release);
+		publications.notify_one();
+	} else {
+		draw(snapshot);
+	}
+
+	// Whichever slot comes back was rendered, or dropped, at least one publication ago
+	RenderSnapshot& next = snapshots.back();
+	next.sprites.clear();
+	next.meshes.clear();
+	next.begun = std::chrono::steady_clock::now();
+}
+
+void Renderer::setThreaded(const bool threaded) {
+	if (threaded == this->threaded()) return;
+	if (threaded) {
+		stopping.store(false, std::memory_order_relaxed);
+		render_thread = std::thread{ [this]() { renderLoop(); } };
+		return;
+	}
+	flush();
+	stopping.store(true, std::memory_order_relaxed);
+	publications.fetch_add(1, std::memory_order_release);
+	publications.notify_one();
+	render_thread.join();
+}
+
+void Renderer::flush() {
+	if (!threaded()) return;
+	// frame_count is the last published frame + 1, and RENDER_FAILED is past any of them
+	for (u64 rendered = rendered_frames.load(std::memory_order_acquire); rendered < frame_count; rendered = rendered_frames.load(std::memory_order_acquire)) {
+		rendered_frames.wait(rendered, std::memory_order_acquire);
+	}
+	rethrowRenderError();
+}
+
+void Renderer::rethrowRenderError() {
+	if (rendered_frames.load(std::memory_order_acquire) != RENDER_FAILED) return;
+	// The render thread has returned; carry on unthreaded, frames published since the failure dropped
+	render_thread.join();
+	rendered_frames.store(frame_count, std::memory_order_relaxed);
+	std::rethrow_exception(std::exchange(render_error, nullptr));
+}
+
+void Renderer::renderLoop() {
+	MIRROR_PROFILE_THREAD("Render");
+	try {
+		for (;;) {
+			// Read before looking for a snapshot, so one published after the look changes it and the wait returns at once
+			const u64 seen = publications.load(std::memory_order_acquire);
+			if (stopping.load(std::memory_order_relaxed)) return;
+			if (snapshots.acquire()) {
+				draw(snapshots.front());
+				rendered_frames.notify_all();
+				continue;
+			}
+			publications.wait(seen, std::memory_order_acquire);
+		}
+	} catch (...) {
+		// Rethrown on the simulation thread by the next update() or flush(), which this wakes
+		render_error = std::current_exception();
+		rendered_frames.store(RENDER_FAILED, std::memory_order_release);
+		rendered_frames.notify_all();
+	}
+}
+
+void Renderer::draw(RenderSnapshot& snapshot) {
+	MIRROR_PROFILE_ZONE("Renderer::draw");
+	if (gpu) render(snapshot);
+	const f64 latency = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - snapshot.begun).count();
+	latency_stats.last_ms = latency;
+	latency_stats.max_ms = std::max(latency_stats.max_ms, latency);
+	latency_stats.total_ms += latency;
+	++latency_stats.rendered;
+	rendered_frames.store(snapshot.frame + 1, std::memory_order_release);
+}
+
+void Renderer::render(RenderSnapshot& snapshot) {
+	const VkCommandBuffer commands = gpu->frames.begin();
+
+	const FrameUniforms uniforms{ snapshot.view_projection, snapshot.frame, gpu->frames.count() };
+	const Vk::UploadRing::Allocation upload = gpu->upload.upload(std::span{ &uniforms, 1 });
+	if (upload) {
+		const VkBufferCopy copy{ upload.offset, 0, sizeof(FrameUniforms) };
+		vkCmdCopyBuffer(commands, gpu->upload.buffer(), gpu->frame_uniforms.buffer(), 1, &copy);
+		// Visible to this frame's shaders, and ordered before the next frame's copy overwrites it
+		const VkMemoryBarrier barrier{
+			.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+			.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+			.dstAccessMask = VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+		};
+		vkCmdPipelineBarrier(commands, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+			0, 1, &barrier, 0, nullptr, 0, nullptr);
+	}
+
+	// No pipelines are created yet, so rather than being drawn each batch copies its instances into device-local memory,
+	// recorded the way the draws will be: disjoint ranges of the sorted batches in secondary buffers on worker threads
+	struct Upload {
+		const RenderQueue* queue = nullptr;
+		VkDeviceSize source = 0; // ring offset
+		VkDeviceSize destination = 0; // instance buffer offset
+	};
+	std::array<Upload, 2> uploads;
+	usize upload_count = 0;
+	VkDeviceSize destination = 0;
+	last_draws = {};
+	for (RenderQueue* queue : { &snapshot.sprites, &snapshot.meshes }) {
+		queue->sort();
+		const Vk::UploadRing::Allocation allocation = queue->batch(gpu->upload);
+		if (!allocation) continue;
+		uploads[upload_count++] = { queue, allocation.offset, destination };
+		destination = (destination + allocation.size + Vk::UploadRing::ALIGNMENT - 1) & ~(Vk::UploadRing::ALIGNMENT - 1);
+		last_draws.instances += (u32)queue->size();
+		last_draws.batches += (u32)queue->batches().size();
+	}
+	if (last_draws.batches > 0) {
+		// The previous frame's vertex fetches finish before its instances are overwritten
+		vkCmdPipelineBarrier(commands, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+		last_draws.chunks = gpu->recorder.record(commands, gpu->frames.index(), last_draws.batches, RECORD_CHUNK,
+			[&](const VkCommandBuffer secondary, const usize begin, const usize end) {
+				// Batch indices run through the sprite batches, then the mesh batches
+				usize base = 0;
+				for (usize n = 0; n < upload_count; ++n) {
+					const Upload& upload = uploads[n];
+					const std::span<const RenderQueue::Batch> batches = upload.queue->batches();
+					const VkDeviceSize size = upload.queue->instanceSize();
+					const usize first = std::max(begin, base) - base;
+					const usize last = std::min(end, base + batches.size()) - std::min(end, base);
+					for (usize b = first; b < last; ++b) {
+						const VkBufferCopy copy{
+							upload.source + batches[b].first_instance * size,
+							upload.destination + batches[b].first_instance * size,
+							batches[b].instance_count * size,
+						};
+						vkCmdCopyBuffer(secondary, gpu->upload.buffer(), gpu->instances.buffer(), 1, &copy);
+					}
+					base += batches.size();
+				}
+			});
+		// Visible to vertex input, and ordered before the next frame's copies
+		const VkMemoryBarrier barrier{
+			.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+			.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+			.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+		};
+		vkCmdPipelineBarrier(commands, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+			0, 1, &barrier, 0, nullptr, 0, nullptr);
+	}
+
+	gpu->frames.end();
 }
 
 }
@@ -2,23 +2,144 @@
 
 #include "frame/frame.h"
 #include "window.h"
+#include "render_queue.h"
 #include "vk/vk_resources.h"
 
 namespace Mirror::Reflect {
 
+// Everything rendering needs from one simulated frame. The simulation writes it and hands it over whole, then never
+// touches it again, so a render thread reads it without locks while the next frame is simulated. Rendering only
+// reorders the queues, by sorting them.
+struct RenderSnapshot {
+	u64 frame = 0; // Renderer::frameCount() when it was published
+	Mat4f view_projection{ 1 };
+	RenderQueue sprites{ sizeof(SpriteInstance) };
+	RenderQueue meshes{ sizeof(MeshInstance) };
+	std::chrono::steady_clock::time_point begun; // when the simulation started writing it
+};
+
+// Turns snapshots into GPU frames, either inline in update() or, once threaded, on its own thread: update() then only
+// publishes the snapshot into a TripleBuffer, and the render thread records and submits the latest one while the next
+// frame is simulated.
 class Renderer {
 public:
-	Renderer(const Vec2<i32> window_size, const std::string_view window_name = "Mirror") :
-		window(window_size, window_name) {};
+	static constexpr VkDeviceSize UPLOAD_RING_SIZE = 8 << 20; // per-frame uniforms and instance data for every frame in flight
+	static constexpr usize RECORD_CHUNK = 256; // batches per secondary command buffer at least, below that threads cost more than they save
+
+	// No window or surface. By default a null backend with no GPU work either, so everything else runs on machines
+	// without a display; with vulkan the frames are recorded and submitted offscreen, which works on software drivers.
+	struct Headless {
+		bool vulkan = false;
+	};
+
+	// Per-frame constants, uploaded through the ring and copied into device-local memory every frame
+	struct FrameUniforms {
+		Mat4f view_projection{ 1 };
+		u64 frame = 0;
+		u64 frames_in_flight = 0;
+	};
 
-	void update() {
-		render();
+	// Instanced draws produced by the last update()
+	struct DrawStats {
+		u32 instances = 0;
+		u32 batches = 0;
+		u32 chunks = 0; // secondary command buffers, recorded in parallel
+	};
+
+	// Age of each rendered snapshot when its frame was submitted, measured from when the simulation started writing
+	// it, right after the previous update(), so around when that frame's input was read. Inline it is one simulated
+	// frame plus rendering. Threaded the render thread always takes the latest snapshot and drops older ones rather than
+	// queuing them, which bounds it by one simulated frame plus two rendered ones.
+	struct Latency {
+		u64 published = 0;
+		u64 rendered = 0;
+		u64 dropped = 0; // replaced by a newer snapshot before the render thread got to them
+		f64 last_ms = 0;
+		f64 max_ms = 0;
+		f64 total_ms = 0;
+
+		[[nodiscard]] f64 meanMs() const noexcept { return rendered ? total_ms / (f64)rendered : 0; }
+	};
+
+	Renderer(const Vec2<i32> window_size, const std::string_view window_name = "Mirror") :
+		window(std::in_place, window_size, window_name), gpu(std::make_unique<Gpu>()) {
+		snapshots.back().begun = std::chrono::steady_clock::now();
 	}
+	explicit Renderer(const Headless headless) :
+		gpu(headless.vulkan ? std::make_unique<Gpu>() : nullptr) {
+		snapshots.back().begun = std::chrono::steady_clock::now();
+	}
+	// Stops the render thread first
+	~Renderer() noexcept;
+
+	Renderer(const Renderer&) = delete;
+	Renderer& operator=(const Renderer&) = delete;
+
+	// Renders the snapshot written since the last call, or publishes it to the render thread, and starts the next one.
+	// Rethrows an exception the render thread stopped on, leaving the renderer unthreaded.
+	void update();
+
+	// Starts or stops the render thread; stopping renders whatever was published first
+	void setThreaded(bool threaded);
+	[[nodiscard]] bool threaded() const noexcept { return render_thread.joinable(); }
+	// Blocks until the render thread has rendered the last published snapshot, rethrowing as update() does. The stats
+	// below are written by the render thread, so while threaded read them only after this.
+	void flush();
+
+	[[nodiscard]] bool headless() const noexcept { return !window.has_value(); }
+	// False for the null backend
+	[[nodiscard]] bool vulkan() const noexcept { return gpu != nullptr; }
+	// update() calls so far, rendered or not
+	[[nodiscard]] u64 frameCount() const noexcept { return frame_count; }
+	// CPU cost of submitting frames, nullptr for the null backend; flush() first while threaded
+	[[nodiscard]] const Vk::FramesInFlight::Timings* gpuTimings() const noexcept { return gpu ? &gpu->frames.timings() : nullptr; }
+	[[nodiscard]] const Vk::Context* context() const noexcept { return gpu ? &gpu->context : nullptr; }
+
+	// The snapshot for the next update(), which sorts, batches and uploads its draws; the null backend discards them.
+	// Simulation thread only.
+	[[nodiscard]] RenderSnapshot& snapshot() noexcept { return snapshots.back(); }
+	[[nodiscard]] RenderQueue& sprites() noexcept { return snapshots.back().sprites; }
+	[[nodiscard]] RenderQueue& meshes() noexcept { return snapshots.back().meshes; }
+	// Kept from frame to frame until set again
+	void setCamera(const Mat4f& view_projection) noexcept { camera = view_projection; }
+	// Of the last rendered snapshot
+	[[nodiscard]] const DrawStats& lastDraws() const noexcept { return last_draws; }
+	[[nodiscard]] const Latency& latency() const noexcept { return latency_stats; }
 
 private:
-	Window window;
+	// Declared in dependency order, so frames waits for the GPU before the buffers it used are destroyed
+	struct Gpu {
+		Vk::Context context;
+		Vk::UploadRing upload{ context, UPLOAD_RING_SIZE };
+		Vk::Buffer frame_uniforms{ context, sizeof(FrameUniforms), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, Vk::MemoryUsage::DEVICE };
+		// Device-local copy of a frame's instance data; no frame uploads more than the ring holds
+		Vk::Buffer instances{ context, UPLOAD_RING_SIZE, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, Vk::MemoryUsage::DEVICE };
+		Vk::ParallelRecorder recorder{ context, (u32)JobSystem::instance().threadCount() };
+		Vk::FramesInFlight frames{ context, &upload };
+	};
+
+	std::optional<Window> window;
+	std::unique_ptr<Gpu> gpu;
+	TripleBuffer<RenderSnapshot> snapshots;
+	Mat4f camera{ 1 };
+	DrawStats last_draws;
+	Latency latency_stats; // published and dropped written by update(), the rest by whichever thread renders
+	u64 frame_count = 0;
+
+	std::thread render_thread;
+	std::atomic<u64> publications{ 0 }; // bumped by every publish and by stopping, what the render thread waits on
+	std::atomic<u64> rendered_frames{ 0 }; // RenderSnapshot::frame + 1 of the last snapshot rendered, or RENDER_FAILED
+	std::atomic<bool> stopping{ false };
+	std::exception_ptr render_error; // written by the render thread before RENDER_FAILED
+
+	static constexpr u64 RENDER_FAILED = ~u64{ 0 };
 
-	void render();
+	void renderLoop();
+	// Joins a render thread that stopped on an exception and rethrows it
+	void rethrowRenderError();
+	// Renders snapshot, on the calling thread, and records its latency
+	void draw(RenderSnapshot& snapshot);
+	void render(RenderSnapshot& snapshot);
 };
 
 }
@@ -0,0 +1,504 @@
+#include "vk_memory.h"
+
+namespace Mirror::Reflect::Vk {
+
+Tlsf::Tlsf(const VkDeviceSize capacity) : capacity_(capacity) {
+	assert(capacity > 0);
+	heads_.fill(NONE);
+	nodes_.push_back({ .size = capacity });
+	insertFree(0);
+}
+
+void Tlsf::mapping(const VkDeviceSize size, u32& fl, u32& sl) noexcept {
+	if (size < SL_COUNT) {
+		fl = 0;
+		sl = (u32)size;
+		return;
+	}
+	const u32 log = (u32)std::bit_width(size) - 1;
+	fl = log - SL_LOG + 1;
+	sl = (u32)(size >> (log - SL_LOG)) - SL_COUNT;
+}
+
+u32 Tlsf::findFree(const VkDeviceSize size) const noexcept {
+	// Rounded up to the next class boundary, so any range in the class found is large enough
+	VkDeviceSize rounded = size;
+	if (size >= SL_COUNT) rounded += (VkDeviceSize{ 1 } << (std::bit_width(size) - 1 - SL_LOG)) - 1;
+	u32 fl, sl;
+	mapping(rounded, fl, sl);
+	if (fl >= FL_COUNT) return NONE;
+
+	u32 sl_map = sl_bitmaps_[fl] & (~0u << sl);
+	if (sl_map == 0) {
+		const u64 fl_map = fl + 1 < 64 ? fl_bitmap_ & (~u64{ 0 } << (fl + 1)) : 0;
+		if (fl_map == 0) return NONE;
+		fl = (u32)std::countr_zero(fl_map);
+		sl_map = sl_bitmaps_[fl];
+	}
+	return heads_[fl * SL_COUNT + (u32)std::countr_zero(sl_map)];
+}
+
+u32 Tlsf::newNode() {
+	if (!spare_nodes_.empty()) {
+		const u32 node = spare_nodes_.back();
+		spare_nodes_.pop_back();
+		return node;
+	}
+	nodes_.emplace_back();
+	// free() recycles nodes without allocating
+	spare_nodes_.reserve(nodes_.capacity());
+	return (u32)nodes_.size() - 1;
+}
+
+void Tlsf::insertFree(const u32 index) noexcept {
+	Node& node = nodes_[index];
+	u32 fl, sl;
+	mapping(node.size, fl, sl);
+	u32& head = heads_[fl * SL_COUNT + sl];
+	node.free = true;
+	node.prev_free = NONE;
+	node.next_free = head;
+	if (head != NONE) nodes_[head].prev_free = index;
+	head = index;
+	sl_bitmaps_[fl] |= 1u << sl;
+	fl_bitmap_ |= u64{ 1 } << fl;
+	++free_count_;
+}
+
+void Tlsf::removeFree(const u32 index) noexcept {
+	Node& node = nodes_[index];
+	u32 fl, sl;
+	mapping(node.size, fl, sl);
+	if (node.prev_free != NONE) nodes_[node.prev_free].next_free = node.next_free;
+	else heads_[fl * SL_COUNT + sl] = node.next_free;
+	if (node.next_free != NONE) nodes_[node.next_free].prev_free = node.prev_free;
+	if (heads_[fl * SL_COUNT + sl] == NONE) {
+		sl_bitmaps_[fl] &= ~(1u << sl);
+		if (sl_bitmaps_[fl] == 0) fl_bitmap_ &= ~(u64{ 1 } << fl);
+	}
+	node.free = false;
+	--free_count_;
+}
+
+Tlsf::Allocation Tlsf::allocate(const VkDeviceSize size, const VkDeviceSize align) {
+	assert(size > 0 && std::has_single_bit(align));
+	if (size > capacity_) return {};
+	// Ranges usually start aligned already, so try without padding first; then with the worst case, which any range
+	// found can absorb
+	u32 index = findFree(size);
+	if (index != NONE && ((nodes_[index].offset + align - 1) & ~(align - 1)) + size > nodes_[index].offset + nodes_[index].size) index = NONE;
+	if (index == NONE && align - 1 <= capacity_ - size) index = findFree(size + align - 1);
+	if (index == NONE) return {};
+	removeFree(index);
+
+	const VkDeviceSize aligned = (nodes_[index].offset + align - 1) & ~(align - 1);
+	// The previous range is in use, or it would have coalesced, so the padding becomes a free range of its own
+	if (const VkDeviceSize padding = aligned - nodes_[index].offset; padding > 0) {
+		const u32 front = newNode();
+		Node& node = nodes_[index];
+		nodes_[front] = { .offset = node.offset, .size = padding, .prev = node.prev, .next = index };
+		if (node.prev != NONE) nodes_[node.prev].next = front;
+		node.prev = front;
+		node.offset = aligned;
+		node.size -= padding;
+		insertFree(front);
+	}
+	if (nodes_[index].size > size) {
+		const u32 back = newNode();
+		Node& node = nodes_[index];
+		nodes_[back] = { .offset = node.offset + size, .size = node.size - size, .prev = index, .next = node.next };
+		if (node.next != NONE) nodes_[node.next].prev = back;
+		node.next = back;
+		node.size = size;
+		insertFree(back);
+	}
+	used_ += size;
+	++allocation_count_;
+	return { aligned, size, index };
+}
+
+void Tlsf::free(u32 index) noexcept {
+	assert(index < nodes_.size() && !nodes_[index].free && nodes_[index].size > 0);
+	used_ -= nodes_[index].size;
+	--allocation_count_;
+
+	if (const u32 prev = nodes_[index].prev; prev != NONE && nodes_[prev].free) {
+		removeFree(prev);
+		const Node& node = nodes_[index];
+		nodes_[prev].size += node.size;
+		nodes_[prev].next = node.next;
+		if (node.next != NONE) nodes_[node.next].prev = prev;
+		nodes_[index] = {};
+		spare_nodes_.push_back(index);
+		index = prev;
+	}
+	if (const u32 next = nodes_[index].next; next != NONE && nodes_[next].free) {
+		removeFree(next);
+		const Node& node = nodes_[next];
+		nodes_[index].size += node.size;
+		nodes_[index].next = node.next;
+		if (node.next != NONE) nodes_[node.next].prev = index;
+		nodes_[next] = {};
+		spare_nodes_.push_back(next);
+	}
+	insertFree(index);
+}
+
+VkDeviceSize Tlsf::largestFree() const noexcept {
+	if (fl_bitmap_ == 0) return 0;
+	const u32 fl = 63 - (u32)std::countl_zero(fl_bitmap_);
+	const u32 sl = 31 - (u32)std::countl_zero(sl_bitmaps_[fl]);
+	VkDeviceSize largest = 0;
+	for (u32 node = heads_[fl * SL_COUNT + sl]; node != NONE; node = nodes_[node].next_free) largest = std::max(largest, nodes_[node].size);
+	return largest;
+}
+
+f64 Tlsf::fragmentation() const noexcept {
+	const VkDeviceSize free = freeBytes();
+	return free > 0 ? 1.0 - (f64)largestFree() / (f64)free : 0.0;
+}
+
+MemoryAllocator::MemoryAllocator(MemoryBackend& backend) : MemoryAllocator(backend, Config{}) {}
+
+MemoryAllocator::MemoryAllocator(MemoryBackend& backend, const Config& config) :
+	backend_(backend), config_(config), properties_(backend.memoryProperties()) {
+	assert(config.block_size > 0 && config.budget_fraction > 0);
+}
+
+MemoryAllocator::~MemoryAllocator() noexcept {
+	for (const Record& record : records_) {
+		if (record.live && record.block == NONE) backend_.freeMemory(record.memory);
+	}
+	for (const std::unique_ptr<Block>& block : blocks_) {
+		if (block) backend_.freeMemory(block->memory);
+	}
+}
+
+VkDeviceSize MemoryAllocator::budget(const u32 heap) const noexcept {
+	return (VkDeviceSize)((f64)properties_.memoryHeaps[heap].size * config_.budget_fraction);
+}
+
+VkDeviceSize MemoryAllocator::blockSize(const u32 heap) const noexcept {
+	// Small heaps, such as a 256 MB BAR window, get proportionally smaller blocks
+	return std::max<VkDeviceSize>(std::min(config_.block_size, budget(heap) / 8), 1);
+}
+
+VkMemoryPropertyFlags MemoryAllocator::memoryFlags(const u32 memory_type) const noexcept {
+	assert(memory_type < properties_.memoryTypeCount);
+	return properties_.memoryTypes[memory_type].propertyFlags;
+}
+
+u32 MemoryAllocator::candidates(const u32 type_bits, const MemoryUsage usage, std::array<u32, VK_MAX_MEMORY_TYPES>& types) const noexcept {
+	VkMemoryPropertyFlags required = 0, preferred = 0, avoided = VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+	switch (usage) {
+	case MemoryUsage::DEVICE:
+		required = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+		avoided |= VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT; // keep mappable device memory for uploads
+		break;
+	case MemoryUsage::UPLOAD:
+		required = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+		preferred = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+		avoided |= VK_MEMORY_PROPERTY_HOST_CACHED_BIT; // write-combined is faster for streaming writes
+		break;
+	case MemoryUsage::READBACK:
+		required = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+		preferred = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+		avoided |= VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+		break;
+	}
+
+	std::array<i32, VK_MAX_MEMORY_TYPES> scores;
+	u32 count = 0;
+	for (u32 type = 0; type < properties_.memoryTypeCount; ++type) {
+		const VkMemoryPropertyFlags flags = properties_.memoryTypes[type].propertyFlags;
+		if (!(type_bits & (1u << type)) || (flags & VK_MEMORY_PROPERTY_PROTECTED_BIT)) continue;
+		// GPU-only data may spill into system memory, which is slower but still works
+		const bool fits = (flags & required) == required;
+		if (!fits && usage != MemoryUsage::DEVICE) continue;
+		const i32 score = (fits ? 64 : 0) + 2 * std::popcount(flags & preferred) - std::popcount(flags & avoided);
+		// Insertion sort by score, keeping the driver's order among equals
+		u32 n = count++;
+		for (; n > 0 && scores[n - 1] < score; --n) {
+			scores[n] = scores[n - 1];
+			types[n] = types[n - 1];
+		}
+		scores[n] = score;
+		types[n] = type;
+	}
+	return count;
+}
+
+u32 MemoryAllocator::memoryType(const u32 type_bits, const MemoryUsage usage) const noexcept {
+	std::array<u32, VK_MAX_MEMORY_TYPES> types;
+	return candidates(type_bits, usage, types) > 0 ? types[0] : NONE;
+}
+
+u32 MemoryAllocator::newRecord() {
+	if (!spare_records_.empty()) {
+		const u32 index = spare_records_.back();
+		spare_records_.pop_back();
+		return index;
+	}
+	records_.emplace_back();
+	// free() recycles records without allocating
+	spare_records_.reserve(records_.capacity());
+	return (u32)records_.size() - 1;
+}
+
+bool MemoryAllocator::allocateIn(const u32 memory_type, const VkMemoryRequirements& requirements, Record& record) {
+	const u32 heap = properties_.memoryTypes[memory_type].heapIndex;
+	const bool host_visible = properties_.memoryTypes[memory_type].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+	const VkDeviceSize block_size = blockSize(heap);
+	record.memory_type = memory_type;
+
+	auto allocateMemory = [&](const VkDeviceSize size, std::byte*& mapped) -> VkDeviceMemory {
+		if (reserved_[heap] + size > budget(heap)) return VK_NULL_HANDLE;
+		const VkDeviceMemory memory = backend_.allocateMemory(memory_type, size);
+		if (memory == VK_NULL_HANDLE) return VK_NULL_HANDLE;
+		try {
+			mapped = host_visible ? backend_.mapMemory(memory) : nullptr;
+		} catch (...) {
+			backend_.freeMemory(memory);
+			throw;
+		}
+		reserved_[heap] += size;
+		return memory;
+	};
+
+	auto allocateDedicated = [&]() {
+		record.memory = allocateMemory(requirements.size, record.mapped);
+		record.block = NONE;
+		record.offset = 0;
+		record.size = requirements.size;
+		return record.memory != VK_NULL_HANDLE;
+	};
+	if (requirements.size > block_size / 2) return allocateDedicated();
+
+	auto allocateInBlock = [&](const u32 block) {
+		const Tlsf::Allocation allocation = blocks_[block]->tlsf.allocate(requirements.size, record.alignment);
+		if (!allocation) return false;
+		record.block = block;
+		record.node = allocation.node;
+		record.offset = allocation.offset;
+		record.size = allocation.size;
+		return true;
+	};
+	for (u32 block = 0; block < blocks_.size(); ++block) {
+		if (blocks_[block] && blocks_[block]->memory_type == memory_type && allocateInBlock(block)) return true;
+	}
+
+	std::byte* mapped = nullptr;
+	const VkDeviceMemory memory = allocateMemory(block_size, mapped);
+	if (memory == VK_NULL_HANDLE) return false;
+	auto slot = std::ranges::find_if(blocks_, [](const std::unique_ptr<Block>& block) { return block == nullptr; });
+	if (slot == blocks_.end()) slot = blocks_.insert(blocks_.end(), nullptr);
+	*slot = std::make_unique<Block>(memory, mapped, memory_type, Tlsf{ block_size });
+	if (allocateInBlock((u32)(slot - blocks_.begin()))) return true;
+	// Not expected, as offset 0 of a fresh block meets any alignment, but never keep an empty block over it
+	reserved_[heap] -= block_size;
+	backend_.freeMemory(memory);
+	slot->reset();
+	return allocateDedicated();
+}
+
+MemoryAllocator::Allocation MemoryAllocator::allocate(const VkMemoryRequirements& requirements, const MemoryUsage usage, const bool movable) {
+	assert(requirements.size > 0);
+	std::scoped_lock lock{ mutex_ };
+	std::array<u32, VK_MAX_MEMORY_TYPES> types;
+	const u32 count = candidates(requirements.memoryTypeBits, usage, types);
+
+	const u32 index = newRecord();
+	Record& record = records_[index];
+	record = { .alignment = std::max<VkDeviceSize>(requirements.alignment, 1), .movable = movable };
+	for (u32 n = 0; n < count; ++n) {
+		if (allocateIn(types[n], requirements, record)) {
+			record.live = true;
+			return { index };
+		}
+	}
+	spare_records_.push_back(index);
+	throw Error::VULKAN;
+}
+
+void MemoryAllocator::releaseBlockIfEmpty(const u32 block) noexcept {
+	const Block& released = *blocks_[block];
+	if (!released.tlsf.empty()) return;
+	// The last block of a memory type stays, so a type whose usage hovers around one block doesn't churn
+	const bool last = std::ranges::none_of(blocks_, [&](const std::unique_ptr<Block>& other) {
+		return other && other.get() != &released && other->memory_type == released.memory_type;
+	});
+	if (last) return;
+	reserved_[properties_.memoryTypes[released.memory_type].heapIndex] -= released.tlsf.capacity();
+	backend_.freeMemory(released.memory);
+	blocks_[block].reset();
+}
+
+void MemoryAllocator::free(const Allocation allocation) noexcept {
+	if (!allocation) return;
+	std::scoped_lock lock{ mutex_ };
+	Record& record = records_[allocation.index];
+	assert(record.live && "freed twice or never allocated");
+	if (record.block != NONE) {
+		blocks_[record.block]->tlsf.free(record.node);
+		releaseBlockIfEmpty(record.block);
+	} else {
+		reserved_[properties_.memoryTypes[record.memory_type].heapIndex] -= record.size;
+		backend_.freeMemory(record.memory);
+	}
+	record = {};
+	spare_records_.push_back(allocation.index);
+}
+
+MemoryAllocator::Info MemoryAllocator::info(const Allocation allocation) const noexcept {
+	std::scoped_lock lock{ mutex_ };
+	const Record& record = records_[allocation.index];
+	assert(record.live);
+	if (record.block == NONE) return { record.memory, 0, record.size, record.mapped, record.memory_type, true };
+	const Block& block = *blocks_[record.block];
+	return { block.memory, record.offset, record.size, block.mapped ? block.mapped + record.offset : nullptr, record.memory_type, false };
+}
+
+std::vector<MemoryAllocator::Move> MemoryAllocator::beginDefragmentation(const VkDeviceSize max_bytes) {
+	std::scoped_lock lock{ mutex_ };
+	std::vector<Move> moves;
+	VkDeviceSize moved = 0;
+
+	std::vector<u32> order;
+	std::vector<u32> contents;
+	for (u32 memory_type = 0; memory_type < properties_.memoryTypeCount; ++memory_type) {
+		order.clear();
+		for (u32 block = 0; block < blocks_.size(); ++block) {
+			if (blocks_[block] && blocks_[block]->memory_type == memory_type) order.push_back(block);
+		}
+		// Empty the least used blocks into the most used ones. A block is only worth copying out of when all of it
+		// can go, since a partly emptied block still holds its whole size.
+		std::ranges::sort(order, {}, [&](const u32 block) { return blocks_[block]->tlsf.used(); });
+		const usize type_moves = moves.size();
+		for (usize source = 0; source + 1 < order.size(); ++source) {
+			const u32 block = order[source];
+			// Blocks receiving moves are the ones being filled, as are all fuller ones
+			if (std::ranges::any_of(std::span{ moves }.subspan(type_moves), [&](const Move& move) { return move.block == block; })) break;
+			contents.clear();
+			VkDeviceSize bytes = 0;
+			bool movable = true;
+			for (u32 index = 0; index < records_.size(); ++index) {
+				const Record& record = records_[index];
+				if (!record.live || record.block != block) continue;
+				movable &= record.movable;
+				contents.push_back(index);
+				bytes += record.size;
+			}
+			if (!movable || contents.empty() || moved + bytes > max_bytes) continue;
+
+			const usize first_move = moves.size();
+			for (const u32 index : contents) {
+				const Record& record = records_[index];
+				for (usize target = order.size() - 1; target > source; --target) {
+					Block& destination = *blocks_[order[target]];
+					const Tlsf::Allocation allocation = destination.tlsf.allocate(record.size, record.alignment);
+					if (!allocation) continue;
+					const Block& from = *blocks_[block];
+					moves.push_back({
+						.allocation = { index },
+						.from = { from.memory, record.offset, record.size, from.mapped ? from.mapped + record.offset : nullptr, memory_type, false },
+						.to = { destination.memory, allocation.offset, allocation.size, destination.mapped ? destination.mapped + allocation.offset : nullptr, memory_type, false },
+						.block = order[target],
+						.node = allocation.node,
+					});
+					break;
+				}
+			}
+			if (moves.size() - first_move < contents.size()) {
+				// Doesn't fit: undo the reservations, and fuller blocks won't fit either
+				for (usize n = first_move; n < moves.size(); ++n) blocks_[moves[n].block]->tlsf.free(moves[n].node);
+				moves.resize(first_move);
+				break;
+			}
+			moved += bytes;
+			for (const u32 index : contents) records_[index].movable = false; // pinned until endDefragmentation()
+		}
+	}
+	return moves;
+}
+
+void MemoryAllocator::endDefragmentation(const std::span<const Move> moves) noexcept {
+	std::scoped_lock lock{ mutex_ };
+	for (const Move& move : moves) {
+		Record& record = records_[move.allocation.index];
+		assert(record.live && record.block != NONE);
+		blocks_[record.block]->tlsf.free(record.node);
+		const u32 source = record.block;
+		record.block = move.block;
+		record.node = move.node;
+		record.offset = move.to.offset;
+		record.movable = true;
+		releaseBlockIfEmpty(source);
+	}
+}
+
+MemoryAllocator::Stats MemoryAllocator::stats() const {
+	std::scoped_lock lock{ mutex_ };
+	Stats stats;
+	stats.heap_count = properties_.memoryHeapCount;
+	for (u32 heap = 0; heap < properties_.memoryHeapCount; ++heap) {
+		stats.heaps[heap].budget = budget(heap);
+		stats.heaps[heap].reserved = reserved_[heap];
+		stats.reserved += reserved_[heap];
+	}
+	for (const std::unique_ptr<Block>& block : blocks_) {
+		if (!block) continue;
+		HeapStats& heap = stats.heaps[properties_.memoryTypes[block->memory_type].heapIndex];
+		++heap.blocks;
+		heap.used += block->tlsf.used();
+		heap.allocations += block->tlsf.allocationCount();
+		stats.block_free += block->tlsf.freeBytes();
+		stats.largest_free = std::max(stats.largest_free, block->tlsf.largestFree());
+		++stats.device_allocations;
+	}
+	for (const Record& record : records_) {
+		if (!record.live || record.block != NONE) continue;
+		HeapStats& heap = stats.heaps[properties_.memoryTypes[record.memory_type].heapIndex];
+		++heap.dedicated;
+		++heap.allocations;
+		heap.used += record.size;
+		++stats.device_allocations;
+	}
+	for (u32 heap = 0; heap < stats.heap_count; ++heap) {
+		stats.used += stats.heaps[heap].used;
+		stats.allocations += stats.heaps[heap].allocations;
+	}
+	stats.fragmentation = stats.block_free > 0 ? 1.0 - (f64)stats.largest_free / (f64)stats.block_free : 0.0;
+	return stats;
+}
+
+LinearPool::LinearPool(MemoryAllocator& allocator, const MemoryUsage usage, const VkDeviceSize frame_capacity, const u32 frames, const u32 type_bits) :
+	// Whole multiples of the largest alignment, so every region starts aligned
+	allocator_(allocator), frame_capacity_((frame_capacity + 255) & ~VkDeviceSize{ 255 }), frames_(frames) {
+	assert(frame_capacity > 0 && frames > 0);
+	allocation_ = allocator.allocate({ frame_capacity_ * frames, 256, type_bits }, usage);
+	info_ = allocator.info(allocation_);
+}
+
+LinearPool::~LinearPool() noexcept {
+	allocator_.free(allocation_);
+}
+
+MemoryAllocator::Info LinearPool::allocate(const VkDeviceSize size, const VkDeviceSize align) {
+	assert(std::has_single_bit(align) && align <= 256);
+	const VkDeviceSize region = index_ * frame_capacity_;
+	const VkDeviceSize aligned = (offset_ + align - 1) & ~(align - 1);
+	if (aligned + size > frame_capacity_) {
+		++failures_;
+		return {};
+	}
+	offset_ = aligned + size;
+	peak_ = std::max(peak_, offset_);
+	return { info_.memory, info_.offset + region + aligned, size, info_.mapped ? info_.mapped + region + aligned : nullptr, info_.memory_type, info_.dedicated };
+}
+
+void LinearPool::nextFrame() noexcept {
+	index_ = (index_ + 1) % frames_;
+	offset_ = 0;
+}
+
+}
@@ -0,0 +1,253 @@
+#pragma once
+
+#include "frame/frame.h"
+
+#include <array>
+#include <mutex>
+
+#include <vulkan/vulkan.h>
+
+namespace Mirror::Reflect::Vk {
+
+// Two-level segregated fit over the offsets [0, capacity): constant-time allocate and free with immediate coalescing
+// of neighbours, and a request is always served from the smallest size class guaranteed to fit, which bounds
+// fragmentation. It keeps no pointers into the managed range, so it works for device memory the CPU can't touch.
+class Tlsf {
+public:
+	static constexpr u32 NONE = ~0u;
+
+	struct Allocation {
+		VkDeviceSize offset = 0;
+		VkDeviceSize size = 0;
+		u32 node = NONE;
+
+		[[nodiscard]] explicit operator bool() const noexcept { return node != NONE; }
+	};
+
+	explicit Tlsf(VkDeviceSize capacity);
+
+	// size bytes at a multiple of align, a power of two; empty when no free range is large enough
+	[[nodiscard]] Allocation allocate(VkDeviceSize size, VkDeviceSize align = 1);
+	void free(u32 node) noexcept;
+
+	[[nodiscard]] VkDeviceSize capacity() const noexcept { return capacity_; }
+	[[nodiscard]] VkDeviceSize used() const noexcept { return used_; }
+	[[nodiscard]] VkDeviceSize freeBytes() const noexcept { return capacity_ - used_; }
+	[[nodiscard]] u32 allocationCount() const noexcept { return allocation_count_; }
+	[[nodiscard]] u32 freeRangeCount() const noexcept { return free_count_; }
+	[[nodiscard]] bool empty() const noexcept { return allocation_count_ == 0; }
+	[[nodiscard]] VkDeviceSize largestFree() const noexcept;
+	// 0 when all free space is one range, approaching 1 as it splinters: 1 - largest free range / free bytes
+	[[nodiscard]] f64 fragmentation() const noexcept;
+
+private:
+	static constexpr u32 SL_LOG = 4;
+	static constexpr u32 SL_COUNT = 1 << SL_LOG;
+	static constexpr u32 FL_COUNT = 64 - SL_LOG + 1;
+
+	struct Node {
+		VkDeviceSize offset = 0;
+		VkDeviceSize size = 0;
+		u32 prev = NONE; // neighbours in address order
+		u32 next = NONE;
+		u32 prev_free = NONE; // neighbours in the size class list, while free
+		u32 next_free = NONE;
+		bool free = false;
+	};
+
+	VkDeviceSize capacity_;
+	VkDeviceSize used_ = 0;
+	u32 allocation_count_ = 0;
+	u32 free_count_ = 0;
+	std::vector<Node> nodes_;
+	std::vector<u32> spare_nodes_;
+	u64 fl_bitmap_ = 0;
+	std::array<u32, FL_COUNT> sl_bitmaps_{};
+	std::array<u32, FL_COUNT * SL_COUNT> heads_;
+
+	// Size class holding ranges of exactly size bytes
+	static void mapping(VkDeviceSize size, u32& fl, u32& sl) noexcept;
+	[[nodiscard]] u32 findFree(VkDeviceSize size) const noexcept;
+	[[nodiscard]] u32 newNode();
+	void insertFree(u32 node) noexcept;
+	void removeFree(u32 node) noexcept;
+};
+
+// Where MemoryAllocator gets its device memory: implemented by Context for a real device and by mocks in tests
+class MemoryBackend {
+public:
+	virtual ~MemoryBackend() = default;
+
+	[[nodiscard]] virtual const VkPhysicalDeviceMemoryProperties& memoryProperties() const noexcept = 0;
+	// VK_NULL_HANDLE when the heap is out of memory
+	[[nodiscard]] virtual VkDeviceMemory allocateMemory(u32 memory_type, VkDeviceSize size) = 0;
+	virtual void freeMemory(VkDeviceMemory memory) noexcept = 0;
+	// The whole allocation, mapped until it is freed
+	[[nodiscard]] virtual std::byte* mapMemory(VkDeviceMemory memory) = 0;
+};
+
+enum struct MemoryUsage : u8 {
+	DEVICE, // GPU only: device local, falling back to any memory once device-local heaps are over budget
+	UPLOAD, // CPU writes, GPU reads: host visible and coherent, device local where that exists (resizable BAR, UMA)
+	READBACK, // GPU writes, CPU reads: host visible and coherent, cached preferred
+};
+
+// Sub-allocates resources from large device memory blocks, so the number of vkAllocateMemory calls stays far below
+// driver limits: a Tlsf per block, a dedicated allocation for anything larger than half a block. Memory types are
+// picked by usage, skipping heaps whose blocks would exceed the budget; host-visible blocks stay mapped. Thread safe.
+class MemoryAllocator {
+public:
+	static constexpr u32 NONE = ~0u;
+
+	struct Config {
+		VkDeviceSize block_size = 64 << 20;
+		f64 budget_fraction = 0.8; // of each heap, leaving the rest to the driver and other processes
+	};
+
+	// Handle that stays valid across defragmentation; info() gives the current location
+	struct Allocation {
+		u32 index = NONE;
+
+		[[nodiscard]] explicit operator bool() const noexcept { return index != NONE; }
+		[[nodiscard]] bool operator==(const Allocation&) const noexcept = default;
+	};
+	struct Info {
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		VkDeviceSize offset = 0;
+		VkDeviceSize size = 0;
+		std::byte* mapped = nullptr; // at offset, nullptr unless host visible
+		u32 memory_type = NONE;
+		bool dedicated = false;
+	};
+	struct HeapStats {
+		VkDeviceSize budget = 0;
+		VkDeviceSize reserved = 0; // device memory allocated from this heap
+		VkDeviceSize used = 0; // by live allocations
+		u32 blocks = 0;
+		u32 dedicated = 0;
+		u32 allocations = 0;
+	};
+	struct Stats {
+		std::array<HeapStats, VK_MAX_MEMORY_HEAPS> heaps{};
+		u32 heap_count = 0;
+		VkDeviceSize reserved = 0;
+		VkDeviceSize used = 0;
+		VkDeviceSize block_free = 0; // unused space inside blocks
+		VkDeviceSize largest_free = 0; // largest range any block could still serve
+		u32 allocations = 0;
+		u32 device_allocations = 0; // live VkDeviceMemory objects, blocks and dedicated
+		f64 fragmentation = 0; // 1 - largest free range / free bytes, over all blocks
+	};
+	// A relocation proposed by beginDefragmentation(): copy size bytes from from to to on the GPU and rebind the
+	// resource before endDefragmentation()
+	struct Move {
+		Allocation allocation;
+		Info from;
+		Info to;
+		u32 block = NONE;
+		u32 node = NONE;
+	};
+
+	explicit MemoryAllocator(MemoryBackend& backend);
+	MemoryAllocator(MemoryBackend& backend, const Config& config);
+	~MemoryAllocator() noexcept;
+
+	MemoryAllocator(const MemoryAllocator&) = delete;
+	MemoryAllocator& operator=(const MemoryAllocator&) = delete;
+
+	// Throws Error::VULKAN when no allowed memory type has room within its budget. Only movable allocations are
+	// relocated by defragmentation; their owners must be able to rebind.
+	[[nodiscard]] Allocation allocate(const VkMemoryRequirements& requirements, MemoryUsage usage, bool movable = false);
+	void free(Allocation allocation) noexcept;
+	[[nodiscard]] Info info(Allocation allocation) const noexcept;
+	[[nodiscard]] VkMemoryPropertyFlags memoryFlags(u32 memory_type) const noexcept;
+
+	// Preferred memory type for usage among type_bits, ignoring budgets; NONE if there is none
+	[[nodiscard]] u32 memoryType(u32 type_bits, MemoryUsage usage) const noexcept;
+
+	// Plans moves of up to max_bytes of movable allocations out of the emptiest blocks into fuller blocks of the same
+	// memory type, reserving the destinations. Sources stay valid, and the moved allocations must not be freed,
+	// until endDefragmentation(), which releases the sources and any block left empty.
+	[[nodiscard]] std::vector<Move> beginDefragmentation(VkDeviceSize max_bytes = ~VkDeviceSize{ 0 });
+	void endDefragmentation(std::span<const Move> moves) noexcept;
+
+	[[nodiscard]] Stats stats() const;
+	[[nodiscard]] MemoryBackend& backend() const noexcept { return backend_; }
+
+private:
+	struct Block {
+		VkDeviceMemory memory;
+		std::byte* mapped;
+		u32 memory_type;
+		Tlsf tlsf;
+	};
+	struct Record {
+		VkDeviceMemory memory = VK_NULL_HANDLE; // dedicated only
+		std::byte* mapped = nullptr; // dedicated only
+		u32 block = NONE;
+		u32 node = NONE;
+		VkDeviceSize offset = 0;
+		VkDeviceSize size = 0;
+		VkDeviceSize alignment = 1;
+		u32 memory_type = NONE;
+		bool movable = false;
+		bool live = false;
+	};
+
+	MemoryBackend& backend_;
+	Config config_;
+	VkPhysicalDeviceMemoryProperties properties_;
+	std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> reserved_{};
+	std::vector<std::unique_ptr<Block>> blocks_; // nullptr for released blocks
+	std::vector<Record> records_;
+	std::vector<u32> spare_records_;
+	mutable std::mutex mutex_;
+
+	[[nodiscard]] VkDeviceSize budget(u32 heap) const noexcept;
+	[[nodiscard]] VkDeviceSize blockSize(u32 heap) const noexcept;
+	// Allowed memory types for usage, best first
+	[[nodiscard]] u32 candidates(u32 type_bits, MemoryUsage usage, std::array<u32, VK_MAX_MEMORY_TYPES>& types) const noexcept;
+	[[nodiscard]] bool allocateIn(u32 memory_type, const VkMemoryRequirements& requirements, Record& record);
+	[[nodiscard]] u32 newRecord();
+	void releaseBlockIfEmpty(u32 block) noexcept;
+};
+
+// Bump allocation for transient per-frame data: one region per frame in flight, recycled whole when that frame has
+// retired, so there is no per-allocation bookkeeping and nothing to free. The regions are a single allocation, placed
+// like any other (in a shared block unless it is over half a block), so per-frame churn stays inside it and never
+// fragments the allocator's blocks.
+class LinearPool {
+public:
+	LinearPool(MemoryAllocator& allocator, MemoryUsage usage, VkDeviceSize frame_capacity, u32 frames, u32 type_bits = ~0u);
+	~LinearPool() noexcept;
+
+	LinearPool(const LinearPool&) = delete;
+	LinearPool& operator=(const LinearPool&) = delete;
+
+	// Space in the current frame's region; memory is VK_NULL_HANDLE once the region is full
+	[[nodiscard]] MemoryAllocator::Info allocate(VkDeviceSize size, VkDeviceSize align);
+	// Moves to the next region and empties it; call once the frame that last used it has retired, right after
+	// FramesInFlight::begin()
+	void nextFrame() noexcept;
+
+	[[nodiscard]] u32 frame() const noexcept { return index_; }
+	[[nodiscard]] VkDeviceSize used() const noexcept { return offset_; }
+	[[nodiscard]] VkDeviceSize frameCapacity() const noexcept { return frame_capacity_; }
+	// Highest used() seen, for sizing frame_capacity
+	[[nodiscard]] VkDeviceSize peak() const noexcept { return peak_; }
+	// allocate() calls that found the region full
+	[[nodiscard]] u64 failures() const noexcept { return failures_; }
+
+private:
+	MemoryAllocator& allocator_;
+	MemoryAllocator::Allocation allocation_;
+	MemoryAllocator::Info info_;
+	VkDeviceSize frame_capacity_;
+	u32 frames_;
+	u32 index_ = 0;
+	VkDeviceSize offset_ = 0;
+	VkDeviceSize peak_ = 0;
+	u64 failures_ = 0;
+};
+
+}
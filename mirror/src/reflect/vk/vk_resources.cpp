@@ -2,7 +2,356 @@
 
 namespace Mirror::Reflect::Vk {
 
+namespace {
 
+// Real GPUs first; software drivers still run everything, just slowly
+[[nodiscard]] i32 deviceScore(const VkPhysicalDeviceType type) noexcept {
+	switch (type) {
+	case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU: return 4;
+	case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: return 3;
+	case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU: return 2;
+	case VK_PHYSICAL_DEVICE_TYPE_CPU: return 1;
+	default: return 0;
+	}
+}
+
+[[nodiscard]] f64 milliseconds(const std::chrono::steady_clock::duration duration) noexcept {
+	return std::chrono::duration<f64, std::milli>(duration).count();
+}
+
+}
+
+Context::Context(const std::span<const char* const> instance_extensions) {
+	try {
+		const VkApplicationInfo application{
+			.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
+			.pApplicationName = "Mirror",
+			.applicationVersion = 1,
+			.pEngineName = "Mirror",
+			.engineVersion = 1,
+			.apiVersion = VK_API_VERSION_1_2,
+		};
+		const VkInstanceCreateInfo instance_info{
+			.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+			.pApplicationInfo = &application,
+			.enabledExtensionCount = (u32)instance_extensions.size(),
+			.ppEnabledExtensionNames = instance_extensions.data(),
+		};
+		check(vkCreateInstance(&instance_info, nullptr, &instance_));
+
+		u32 device_count = 0;
+		check(vkEnumeratePhysicalDevices(instance_, &device_count, nullptr));
+		std::vector<VkPhysicalDevice> devices(device_count);
+		check(vkEnumeratePhysicalDevices(instance_, &device_count, devices.data()));
+
+		i32 best_score = -1;
+		for (const VkPhysicalDevice device : devices) {
+			u32 family_count = 0;
+			vkGetPhysicalDeviceQueueFamilyProperties(device, &family_count, nullptr);
+			std::vector<VkQueueFamilyProperties> families(family_count);
+			vkGetPhysicalDeviceQueueFamilyProperties(device, &family_count, families.data());
+			// Graphics queues always support transfers and, on every driver we care about, compute as well
+			const auto family = std::ranges::find_if(families, [](const VkQueueFamilyProperties& properties) {
+				return (properties.queueFlags & VK_QUEUE_GRAPHICS_BIT) && properties.queueCount > 0;
+			});
+			if (family == families.end()) continue;
+
+			VkPhysicalDeviceProperties properties;
+			vkGetPhysicalDeviceProperties(device, &properties);
+			if (deviceScore(properties.deviceType) <= best_score) continue;
+			best_score = deviceScore(properties.deviceType);
+			physical_device_ = device;
+			queue_family_ = (u32)(family - families.begin());
+			device_type_ = properties.deviceType;
+			device_name_ = properties.deviceName;
+		}
+		if (physical_device_ == VK_NULL_HANDLE) throw Error::VULKAN;
+		vkGetPhysicalDeviceMemoryProperties(physical_device_, &memory_properties_);
+
+		const f32 priority = 1.0f;
+		const VkDeviceQueueCreateInfo queue_info{
+			.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+			.queueFamilyIndex = queue_family_,
+			.queueCount = 1,
+			.pQueuePriorities = &priority,
+		};
+		const VkDeviceCreateInfo device_info{
+			.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+			.queueCreateInfoCount = 1,
+			.pQueueCreateInfos = &queue_info,
+		};
+		check(vkCreateDevice(physical_device_, &device_info, nullptr, &device_));
+		vkGetDeviceQueue(device_, queue_family_, 0, &queue_);
+		memory_ = std::make_unique<MemoryAllocator>(*this);
+	} catch (...) {
+		destroy();
+		throw;
+	}
+}
+
+Context::~Context() noexcept {
+	destroy();
+}
+
+void Context::destroy() noexcept {
+	memory_.reset();
+	if (device_) vkDestroyDevice(device_, nullptr);
+	if (instance_) vkDestroyInstance(instance_, nullptr);
+	device_ = VK_NULL_HANDLE;
+	instance_ = VK_NULL_HANDLE;
+}
+
+VkDeviceMemory Context::allocateMemory(const u32 memory_type, const VkDeviceSize size) {
+	const VkMemoryAllocateInfo memory_info{
+		.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+		.allocationSize = size,
+		.memoryTypeIndex = memory_type,
+	};
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+	const VkResult result = vkAllocateMemory(device_, &memory_info, nullptr, &memory);
+	// Out of memory lets the allocator try another heap; anything else is a bug
+	if (result == VK_ERROR_OUT_OF_DEVICE_MEMORY || result == VK_ERROR_OUT_OF_HOST_MEMORY) return VK_NULL_HANDLE;
+	check(result);
+	return memory;
+}
+
+void Context::freeMemory(const VkDeviceMemory memory) noexcept {
+	// Freeing implicitly unmaps
+	vkFreeMemory(device_, memory, nullptr);
+}
+
+std::byte* Context::mapMemory(const VkDeviceMemory memory) {
+	void* mapped = nullptr;
+	check(vkMapMemory(device_, memory, 0, VK_WHOLE_SIZE, 0, &mapped));
+	return static_cast<std::byte*>(mapped);
+}
+
+Buffer::Buffer(const Context& context, const VkDeviceSize size, const VkBufferUsageFlags usage, const MemoryUsage memory_usage) :
+	device_(context.device()), allocator_(&context.memory()), size_(size) {
+	try {
+		const VkBufferCreateInfo buffer_info{
+			.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+			.size = size,
+			.usage = usage,
+			.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+		};
+		check(vkCreateBuffer(device_, &buffer_info, nullptr, &buffer_));
+
+		VkMemoryRequirements requirements;
+		vkGetBufferMemoryRequirements(device_, buffer_, &requirements);
+		allocation_ = allocator_->allocate(requirements, memory_usage);
+		const MemoryAllocator::Info memory = allocator_->info(allocation_);
+		flags_ = allocator_->memoryFlags(memory.memory_type);
+		mapped_ = memory.mapped;
+		check(vkBindBufferMemory(device_, buffer_, memory.memory, memory.offset));
+	} catch (...) {
+		destroy();
+		throw;
+	}
+}
+
+Buffer::~Buffer() noexcept {
+	destroy();
+}
+
+Buffer::Buffer(Buffer&& other) noexcept :
+	device_(other.device_), allocator_(other.allocator_), buffer_(std::exchange(other.buffer_, VK_NULL_HANDLE)), allocation_(std::exchange(other.allocation_, {})),
+	size_(other.size_), flags_(other.flags_), mapped_(std::exchange(other.mapped_, nullptr)) {}
+
+Buffer& Buffer::operator=(Buffer&& other) noexcept {
+	if (this == &other) return *this;
+	destroy();
+	device_ = other.device_;
+	allocator_ = other.allocator_;
+	buffer_ = std::exchange(other.buffer_, VK_NULL_HANDLE);
+	allocation_ = std::exchange(other.allocation_, {});
+	size_ = other.size_;
+	flags_ = other.flags_;
+	mapped_ = std::exchange(other.mapped_, nullptr);
+	return *this;
+}
+
+void Buffer::destroy() noexcept {
+	if (buffer_) vkDestroyBuffer(device_, buffer_, nullptr);
+	if (allocation_) allocator_->free(allocation_);
+	buffer_ = VK_NULL_HANDLE;
+	allocation_ = {};
+	mapped_ = nullptr;
+}
+
+UploadRing::UploadRing(const Context& context, const VkDeviceSize capacity, const VkBufferUsageFlags usage) :
+	buffer_(context, capacity, usage, MemoryUsage::UPLOAD),
+	ring_(capacity) {
+	assert(capacity % ALIGNMENT == 0);
+}
+
+FramesInFlight::FramesInFlight(const Context& context, UploadRing* ring, const u32 count) :
+	context_(context), ring_(ring), frames_(count) {
+	assert(count > 0);
+	try {
+		for (Frame& frame : frames_) {
+			const VkCommandPoolCreateInfo pool_info{
+				.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+				.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+				.queueFamilyIndex = context.queueFamily(),
+			};
+			check(vkCreateCommandPool(context.device(), &pool_info, nullptr, &frame.pool));
+			const VkCommandBufferAllocateInfo commands_info{
+				.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+				.commandPool = frame.pool,
+				.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+				.commandBufferCount = 1,
+			};
+			check(vkAllocateCommandBuffers(context.device(), &commands_info, &frame.commands));
+			// Unsignaled: begin() only waits on slots that were submitted
+			const VkFenceCreateInfo fence_info{
+				.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+			};
+			check(vkCreateFence(context.device(), &fence_info, nullptr, &frame.fence));
+		}
+	} catch (...) {
+		destroy();
+		throw;
+	}
+}
+
+FramesInFlight::~FramesInFlight() noexcept {
+	destroy();
+}
+
+void FramesInFlight::destroy() noexcept {
+	const VkDevice device = context_.device();
+	vkDeviceWaitIdle(device);
+	for (Frame& frame : frames_) {
+		// Destroying a pool frees its command buffers
+		if (frame.pool) vkDestroyCommandPool(device, frame.pool, nullptr);
+		if (frame.fence) vkDestroyFence(device, frame.fence, nullptr);
+		frame = {};
+	}
+}
+
+VkCommandBuffer FramesInFlight::begin() {
+	MIRROR_PROFILE_ZONE("Vk::FramesInFlight::begin");
+	// A frame abandoned by an exception before end() is recorded over: the pool reset below discards its commands
+	const VkDevice device = context_.device();
+	Frame& frame = frames_[index_];
+
+	const auto start = std::chrono::steady_clock::now();
+	{
+		MIRROR_PROFILE_ZONE("Vk::FramesInFlight::wait");
+		if (frame.submitted) check(vkWaitForFences(device, 1, &frame.fence, VK_TRUE, ~u64{ 0 }));
+	}
+	const auto waited = std::chrono::steady_clock::now();
+
+	// Everything this frame uploaded, and everything before it, has been consumed
+	if (ring_) ring_->ring().release(frame.ring_position);
+	check(vkResetCommandPool(device, frame.pool, 0));
+	const VkCommandBufferBeginInfo begin_info{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+	};
+	check(vkBeginCommandBuffer(frame.commands, &begin_info));
+	recording_ = true;
+
+	timings_.wait_ms = milliseconds(waited - start);
+	timings_.total_wait_ms += timings_.wait_ms;
+	begin_cost_ = std::chrono::steady_clock::now() - waited;
+	return frame.commands;
+}
+
+void FramesInFlight::end() {
+	MIRROR_PROFILE_ZONE("Vk::FramesInFlight::submit");
+	assert(recording_);
+	const auto start = std::chrono::steady_clock::now();
+	Frame& frame = frames_[index_];
 
+	check(vkEndCommandBuffer(frame.commands));
+	const VkSubmitInfo submit{
+		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+		.commandBufferCount = 1,
+		.pCommandBuffers = &frame.commands,
+	};
+	// A failed submit leaves the fence unsignaled, so until one succeeds the slot counts as never submitted and begin()
+	// doesn't wait on it forever
+	frame.submitted = false;
+	check(vkResetFences(context_.device(), 1, &frame.fence));
+	check(vkQueueSubmit(context_.queue(), 1, &submit, frame.fence));
+	frame.submitted = true;
+	if (ring_) frame.ring_position = ring_->ring().head();
+	recording_ = false;
+	index_ = (index_ + 1) % count();
+
+	++timings_.frames;
+	timings_.submit_ms = milliseconds(begin_cost_ + (std::chrono::steady_clock::now() - start));
+	timings_.total_submit_ms += timings_.submit_ms;
+}
+
+void FramesInFlight::waitIdle() {
+	assert(!recording_);
+	for (const Frame& frame : frames_) {
+		if (frame.submitted) check(vkWaitForFences(context_.device(), 1, &frame.fence, VK_TRUE, ~u64{ 0 }));
+	}
+	if (ring_) ring_->ring().release(ring_->ring().head());
+}
+
+
+ParallelRecorder::ParallelRecorder(const Context& context, const u32 threads, const u32 frames) :
+	context_(context), threads_(std::max(threads, 1u)), frames_(frames), chunks_((usize)threads_ * frames) {
+	assert(frames > 0);
+	secondaries_.reserve(threads_);
+	try {
+		for (Chunk& chunk : chunks_) {
+			const VkCommandPoolCreateInfo pool_info{
+				.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+				.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+				.queueFamilyIndex = context.queueFamily(),
+			};
+			check(vkCreateCommandPool(context.device(), &pool_info, nullptr, &chunk.pool));
+			const VkCommandBufferAllocateInfo commands_info{
+				.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+				.commandPool = chunk.pool,
+				.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+				.commandBufferCount = 1,
+			};
+			check(vkAllocateCommandBuffers(context.device(), &commands_info, &chunk.commands));
+		}
+	} catch (...) {
+		destroy();
+		throw;
+	}
+}
+
+ParallelRecorder::~ParallelRecorder() noexcept {
+	destroy();
 }
 
+void ParallelRecorder::destroy() noexcept {
+	for (Chunk& chunk : chunks_) {
+		if (chunk.pool) vkDestroyCommandPool(context_.device(), chunk.pool, nullptr);
+		chunk = {};
+	}
+}
+
+VkResult ParallelRecorder::beginChunk(Chunk& chunk) const noexcept {
+	// Resetting here rather than up front keeps even the reset on the recording threads
+	if (const VkResult result = vkResetCommandPool(context_.device(), chunk.pool, 0); result != VK_SUCCESS) return result;
+	// Nothing to inherit outside a render pass, but secondaries must still say so
+	const VkCommandBufferInheritanceInfo inheritance{ .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO };
+	const VkCommandBufferBeginInfo begin_info{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+		.pInheritanceInfo = &inheritance,
+	};
+	return vkBeginCommandBuffer(chunk.commands, &begin_info);
+}
+
+void ParallelRecorder::execute(const VkCommandBuffer primary, const Chunk* const chunks, const u32 count) {
+	secondaries_.clear();
+	for (u32 n = 0; n < count; ++n) {
+		check(chunks[n].result);
+		secondaries_.push_back(chunks[n].commands);
+	}
+	vkCmdExecuteCommands(primary, count, secondaries_.data());
+}
+
+}
@@ -1,10 +1,298 @@
 #pragma once
 
+#include "frame/frame.h"
+#include "vk_memory.h"
+
+#include <string>
+
 #include <vulkan/vulkan.h>
 
 namespace Mirror::Reflect::Vk {
 
+inline void check(const VkResult result) {
+	if (result != VK_SUCCESS) throw Error::VULKAN;
+}
+
+// Instance, device and one queue for graphics, compute and transfer, plus the device's memory allocator. Needs no
+// surface, so it also runs offscreen on software drivers such as lavapipe or SwiftShader on machines without a GPU;
+// a real GPU is preferred when present.
+class Context final : public MemoryBackend {
+public:
+	static constexpr u32 NONE = ~0u;
 
+	explicit Context(std::span<const char* const> instance_extensions = {});
+	~Context() noexcept override;
 
-}
+	Context(const Context&) = delete;
+	Context& operator=(const Context&) = delete;
+
+	[[nodiscard]] VkInstance instance() const noexcept { return instance_; }
+	[[nodiscard]] VkPhysicalDevice physicalDevice() const noexcept { return physical_device_; }
+	[[nodiscard]] VkDevice device() const noexcept { return device_; }
+	[[nodiscard]] VkQueue queue() const noexcept { return queue_; }
+	[[nodiscard]] u32 queueFamily() const noexcept { return queue_family_; }
+	[[nodiscard]] const std::string& deviceName() const noexcept { return device_name_; }
+	// A CPU implementation: timings say nothing about GPU cost
+	[[nodiscard]] bool software() const noexcept { return device_type_ == VK_PHYSICAL_DEVICE_TYPE_CPU; }
+	// Internally synchronized, so shared by everything holding the context
+	[[nodiscard]] MemoryAllocator& memory() const noexcept { return *memory_; }
+
+	[[nodiscard]] const VkPhysicalDeviceMemoryProperties& memoryProperties() const noexcept override { return memory_properties_; }
+	[[nodiscard]] VkDeviceMemory allocateMemory(u32 memory_type, VkDeviceSize size) override;
+	void freeMemory(VkDeviceMemory memory) noexcept override;
+	[[nodiscard]] std::byte* mapMemory(VkDeviceMemory memory) override;
+
+private:
+	VkInstance instance_ = VK_NULL_HANDLE;
+	VkPhysicalDevice physical_device_ = VK_NULL_HANDLE;
+	VkDevice device_ = VK_NULL_HANDLE;
+	VkQueue queue_ = VK_NULL_HANDLE;
+	u32 queue_family_ = NONE;
+	VkPhysicalDeviceType device_type_ = VK_PHYSICAL_DEVICE_TYPE_OTHER;
+	std::string device_name_;
+	VkPhysicalDeviceMemoryProperties memory_properties_{};
+	std::unique_ptr<MemoryAllocator> memory_;
+
+	void destroy() noexcept;
+};
+
+// Buffer sub-allocated from the context's MemoryAllocator. Host-visible buffers stay mapped for their whole lifetime.
+class Buffer {
+public:
+	Buffer(const Context& context, VkDeviceSize size, VkBufferUsageFlags usage, MemoryUsage memory_usage);
+	~Buffer() noexcept;
+
+	Buffer(const Buffer&) = delete;
+	Buffer& operator=(const Buffer&) = delete;
+	Buffer(Buffer&& other) noexcept;
+	Buffer& operator=(Buffer&& other) noexcept;
+
+	[[nodiscard]] VkBuffer buffer() const noexcept { return buffer_; }
+	[[nodiscard]] VkDeviceSize size() const noexcept { return size_; }
+	[[nodiscard]] VkMemoryPropertyFlags memoryFlags() const noexcept { return flags_; }
+	// nullptr unless the memory is host visible
+	[[nodiscard]] std::byte* mapped() const noexcept { return mapped_; }
+
+private:
+	VkDevice device_ = VK_NULL_HANDLE;
+	MemoryAllocator* allocator_ = nullptr;
+	VkBuffer buffer_ = VK_NULL_HANDLE;
+	MemoryAllocator::Allocation allocation_;
+	VkDeviceSize size_ = 0;
+	VkMemoryPropertyFlags flags_ = 0;
+	std::byte* mapped_ = nullptr;
+
+	void destroy() noexcept;
+};
+
+// Ring arithmetic behind UploadRing, free of any Vulkan object. Positions grow monotonically and offsets are
+// positions modulo the capacity; allocations are carved in order and released in bulk by position once the GPU is
+// done with them. An allocation that would straddle the end skips to the start instead.
+class RingAllocator {
+public:
+	static constexpr VkDeviceSize NONE = ~VkDeviceSize{ 0 };
+
+	explicit RingAllocator(const VkDeviceSize capacity) noexcept : capacity_(capacity) {
+		assert(capacity > 0);
+	}
+
+	// Offset of size bytes at align, a power of two dividing the capacity; NONE while the space is still in use
+	[[nodiscard]] VkDeviceSize allocate(const VkDeviceSize size, const VkDeviceSize align) noexcept {
+		assert(std::has_single_bit(align) && capacity_ % align == 0);
+		VkDeviceSize position = (head_ + align - 1) & ~(align - 1);
+		VkDeviceSize offset = position % capacity_;
+		if (offset + size > capacity_) {
+			position += capacity_ - offset;
+			offset = 0;
+		}
+		// Nothing in use, so the skipped bytes before position are free as well
+		const VkDeviceSize tail = tail_ == head_ ? position : tail_;
+		if (size > capacity_ || position + size - tail > capacity_) {
+			++failures_;
+			return NONE;
+		}
+		tail_ = tail;
+		head_ = position + size;
+		return offset;
+	}
+	// Frees everything allocated before position, a head() taken earlier
+	void release(const VkDeviceSize position) noexcept {
+		assert(position <= head_);
+		tail_ = std::max(tail_, position);
+	}
+
+	// Position just past the last allocation
+	[[nodiscard]] VkDeviceSize head() const noexcept { return head_; }
+	// Bytes between the oldest unreleased allocation and the head, alignment and skipped ends included
+	[[nodiscard]] VkDeviceSize used() const noexcept { return head_ - tail_; }
+	[[nodiscard]] VkDeviceSize capacity() const noexcept { return capacity_; }
+	// allocate() calls that found the ring full
+	[[nodiscard]] u64 failures() const noexcept { return failures_; }
+
+private:
+	VkDeviceSize capacity_;
+	VkDeviceSize head_ = 0;
+	VkDeviceSize tail_ = 0;
+	u64 failures_ = 0;
+};
+
+// Persistently mapped, host-coherent ring for per-frame uniforms and instance data: write through data, then bind
+// buffer() at offset or copy from it. Space comes back when FramesInFlight retires the frame that used it, so the CPU
+// never waits on the GPU for upload memory; a full ring fails the allocation instead.
+class UploadRing {
+public:
+	static constexpr VkDeviceSize ALIGNMENT = 256; // the largest minUniformBufferOffsetAlignment and nonCoherentAtomSize allowed
+
+	struct Allocation {
+		std::byte* data = nullptr;
+		VkDeviceSize offset = 0;
+		VkDeviceSize size = 0;
+
+		[[nodiscard]] explicit operator bool() const noexcept { return data != nullptr; }
+	};
 
+	UploadRing(const Context& context, VkDeviceSize capacity,
+		VkBufferUsageFlags usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+
+	[[nodiscard]] Allocation allocate(const VkDeviceSize size, const VkDeviceSize align = ALIGNMENT) noexcept {
+		const VkDeviceSize offset = ring_.allocate(size, align);
+		if (offset == RingAllocator::NONE) return {};
+		return { buffer_.mapped() + offset, offset, size };
+	}
+	template<typename T>
+	[[nodiscard]] Allocation upload(const std::span<const T> values, const VkDeviceSize align = ALIGNMENT) noexcept {
+		static_assert(std::is_trivially_copyable_v<T>);
+		const Allocation allocation = allocate(values.size_bytes(), align);
+		if (allocation) std::memcpy(allocation.data, values.data(), values.size_bytes());
+		return allocation;
+	}
+
+	[[nodiscard]] VkBuffer buffer() const noexcept { return buffer_.buffer(); }
+	[[nodiscard]] RingAllocator& ring() noexcept { return ring_; }
+	[[nodiscard]] const RingAllocator& ring() const noexcept { return ring_; }
+
+private:
+	Buffer buffer_;
+	RingAllocator ring_;
+};
+
+// count frames in flight, each with its own command pool, primary command buffer and fence. begin() only waits for
+// the fence of the frame submitted count frames earlier, so the CPU records up to count frames ahead of the GPU, and
+// then recycles that frame's pool and upload ring space.
+class FramesInFlight {
+public:
+	static constexpr u32 DEFAULT_COUNT = 2;
+
+	// CPU time on the submitting thread, excluding the recording done between begin() and end()
+	struct Timings {
+		u64 frames = 0;
+		f64 wait_ms = 0; // last frame, blocked on its fence in begin()
+		f64 submit_ms = 0; // last frame, the rest of begin() and end(): pool reset, begin, end and vkQueueSubmit
+		f64 total_wait_ms = 0;
+		f64 total_submit_ms = 0;
+
+		[[nodiscard]] f64 meanWaitMs() const noexcept { return frames ? total_wait_ms / (f64)frames : 0; }
+		[[nodiscard]] f64 meanSubmitMs() const noexcept { return frames ? total_submit_ms / (f64)frames : 0; }
+	};
+
+	// ring, when given, is released as frames retire
+	FramesInFlight(const Context& context, UploadRing* ring = nullptr, u32 count = DEFAULT_COUNT);
+	// Waits for the GPU to finish every frame
+	~FramesInFlight() noexcept;
+
+	FramesInFlight(const FramesInFlight&) = delete;
+	FramesInFlight& operator=(const FramesInFlight&) = delete;
+
+	// Starts the next frame and returns its primary command buffer, ready for recording. A frame left unfinished by an
+	// exception is discarded.
+	[[nodiscard]] VkCommandBuffer begin();
+	// Ends and submits the frame; its fence signals when the GPU is done with it
+	void end();
+	// Blocks until every submitted frame has completed and releases all their upload space
+	void waitIdle();
+
+	[[nodiscard]] u32 count() const noexcept { return (u32)frames_.size(); }
+	// Frames submitted so far
+	[[nodiscard]] u64 frame() const noexcept { return timings_.frames; }
+	// Slot of the frame being recorded, in [0, count()), for per-frame resources that FramesInFlight doesn't own
+	[[nodiscard]] u32 index() const noexcept { return index_; }
+	[[nodiscard]] const Timings& timings() const noexcept { return timings_; }
+
+private:
+	struct Frame {
+		VkCommandPool pool = VK_NULL_HANDLE;
+		VkCommandBuffer commands = VK_NULL_HANDLE;
+		VkFence fence = VK_NULL_HANDLE;
+		VkDeviceSize ring_position = 0; // upload ring head when submitted
+		bool submitted = false; // the fence will signal
+	};
+
+	const Context& context_;
+	UploadRing* ring_;
+	std::vector<Frame> frames_;
+	u32 index_ = 0;
+	bool recording_ = false;
+	std::chrono::steady_clock::duration begin_cost_{};
+	Timings timings_;
+
+	void destroy() noexcept;
+};
+
+// Records a frame's commands on several threads. [0, count) is split into at most threads() contiguous chunks, each
+// recorded as a secondary command buffer on the shared JobSystem, and the secondaries are executed into the primary
+// buffer in chunk order. Every chunk slot has its own command pool per frame in flight, since a pool must not be used
+// from two threads at once. The split depends only on count, so the primary buffer comes out the same whichever
+// thread recorded which chunk.
+class ParallelRecorder {
+public:
+	ParallelRecorder(const Context& context, u32 threads, u32 frames = FramesInFlight::DEFAULT_COUNT);
+	~ParallelRecorder() noexcept;
+
+	ParallelRecorder(const ParallelRecorder&) = delete;
+	ParallelRecorder& operator=(const ParallelRecorder&) = delete;
+
+	// Calls fn(commands, begin, end) for chunks of at least min_chunk items and executes the results into primary,
+	// outside a render pass. frame is FramesInFlight::index(): its pools are reset, so the GPU must be done with what
+	// they recorded last time. Returns the number of chunks, 0 when count is.
+	template<typename Fn>
+	u32 record(const VkCommandBuffer primary, const u32 frame, const usize count, const usize min_chunk, const Fn& fn) {
+		MIRROR_PROFILE_ZONE("Vk::ParallelRecorder::record");
+		assert(frame < frames_);
+		if (count == 0) return 0;
+		Chunk* const chunks = chunks_.data() + (usize)frame * threads_;
+		// Errors are kept per chunk and thrown on this thread, since jobs can't throw
+		const usize used = parallelChunks(count, threads_, min_chunk, [&](const usize chunk, const usize begin, const usize end) {
+			assert(chunk < threads_);
+			Chunk& slot = chunks[chunk];
+			slot.result = beginChunk(slot);
+			if (slot.result != VK_SUCCESS) return;
+			fn(slot.commands, begin, end);
+			slot.result = vkEndCommandBuffer(slot.commands);
+		});
+		assert(used <= threads_);
+		execute(primary, chunks, (u32)used);
+		return (u32)used;
+	}
+
+	[[nodiscard]] u32 threads() const noexcept { return threads_; }
+	[[nodiscard]] u32 frames() const noexcept { return frames_; }
+
+private:
+	struct Chunk {
+		VkCommandPool pool = VK_NULL_HANDLE;
+		VkCommandBuffer commands = VK_NULL_HANDLE;
+		VkResult result = VK_SUCCESS;
+	};
+
+	const Context& context_;
+	u32 threads_;
+	u32 frames_;
+	std::vector<Chunk> chunks_; // frames_ rows of threads_
+	std::vector<VkCommandBuffer> secondaries_;
+
+	[[nodiscard]] VkResult beginChunk(Chunk& chunk) const noexcept;
+	void execute(VkCommandBuffer primary, const Chunk* chunks, u32 count);
+	void destroy() noexcept;
+};
+
+}
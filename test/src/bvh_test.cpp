@@ -0,0 +1,134 @@
+#include "test.h"
+
+#include <random>
+#include <chrono>
+
+namespace Test {
+
+namespace {
+
+f64 millisecondsSince(const std::chrono::steady_clock::time_point begin) {
+	return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+}
+
+void bvhTests() {
+	std::mt19937 rng{ 7890 };
+	std::uniform_real_distribution<f32> position{ -500.0f, 500.0f };
+	std::uniform_real_distribution<f32> size{ 0.5f, 4.0f };
+	std::uniform_real_distribution<f32> jitter{ -1.0f, 1.0f };
+
+	constexpr usize COUNT = 100000;
+	std::vector<Aabbf> bounds(COUNT);
+	for (Aabbf& box : bounds) {
+		const Vec3f center{ position(rng), position(rng), position(rng) };
+		const Vec3f half{ size(rng), size(rng), size(rng) };
+		box = { center - half, center + half };
+	}
+
+	Bvhf bvh;
+	auto begin = std::chrono::steady_clock::now();
+	bvh.build(bounds);
+	std::println("bvh: build {} objects in {} ms, {} nodes, cost {}", COUNT, millisecondsSince(begin), bvh.nodes().size(), bvh.cost());
+	CHECK(bvh.size() == COUNT);
+
+	auto checkQueries = [&]() {
+		for (i32 query = 0; query < 50; ++query) {
+			const Vec3f center{ position(rng), position(rng), position(rng) };
+			const Aabbf box{ center - 20.0f, center + 20.0f };
+			std::vector<u32> found;
+			bvh.overlaps(box, found);
+			std::vector<u32> expected;
+			for (u32 n = 0; n < COUNT; ++n) {
+				if (bounds[n].overlaps(box)) expected.push_back(n);
+			}
+			std::sort(found.begin(), found.end());
+			CHECK(found == expected);
+
+			bvh.nearest(center, 8, found);
+			std::vector<f32> distances(COUNT);
+			for (u32 n = 0; n < COUNT; ++n) distances[n] = bounds[n].distanceSquared(center);
+			std::vector<f32> sorted = distances;
+			std::nth_element(sorted.begin(), sorted.begin() + 7, sorted.end());
+			CHECK(found.size() == 8 && distances[found.back()] == sorted[7]);
+			CHECK(std::is_sorted(found.begin(), found.end(), [&](const u32 a, const u32 b) { return distances[a] < distances[b]; }));
+
+			const Rayf ray{ { position(rng), position(rng), -600 }, Vec3f{ jitter(rng) * 0.2f, jitter(rng) * 0.2f, 1 }.normalized() };
+			const Vec3f inv_direction{ 1 / ray.direction.x, 1 / ray.direction.y, 1 / ray.direction.z };
+			f32 closest = std::numeric_limits<f32>::max();
+			for (const Aabbf& b : bounds) {
+				if (const std::optional<f32> t = b.intersect(ray.origin, inv_direction, closest)) closest = *t;
+			}
+			const std::optional<Bvhf::Hit> hit = bvh.raycast(ray);
+			CHECK(hit.has_value() == (closest != std::numeric_limits<f32>::max()));
+			if (hit) CHECK(hit->distance == closest);
+		}
+	};
+	checkQueries();
+
+	// Move everything a little each frame; refits keep queries exact, and update() rebuilds once quality drops
+	usize rebuilds = 0;
+	f64 refit_ms = 0;
+	for (i32 frame = 0; frame < 20; ++frame) {
+		for (Aabbf& box : bounds) {
+			const Vec3f delta{ jitter(rng) * 5, jitter(rng) * 5, jitter(rng) * 5 };
+			box = { box.min + delta, box.max + delta };
+		}
+		begin = std::chrono::steady_clock::now();
+		rebuilds += bvh.update(bounds) ? 1 : 0;
+		refit_ms += millisecondsSince(begin);
+	}
+	std::println("bvh: update {} ms per frame, {} rebuilds in 20 frames, cost {}", refit_ms / 20, rebuilds, bvh.cost());
+	checkQueries();
+
+	std::vector<Rayf> rays(COUNT);
+	for (Rayf& ray : rays) {
+		ray = { { position(rng), position(rng), -600 }, Vec3f{ jitter(rng), jitter(rng), 2 }.normalized() };
+	}
+	std::vector<std::optional<Bvhf::Hit>> hits(COUNT);
+	begin = std::chrono::steady_clock::now();
+	bvh.raycast(rays, hits);
+	const f64 ray_ms = millisecondsSince(begin);
+	std::println("bvh: {} rays per ms, {} hits", (f64)COUNT / ray_ms, std::count_if(hits.begin(), hits.end(), [](const auto& hit) { return hit.has_value(); }));
+
+	std::vector<u32> found;
+	begin = std::chrono::steady_clock::now();
+	for (i32 query = 0; query < 10000; ++query) {
+		const Vec3f center{ position(rng), position(rng), position(rng) };
+		bvh.overlaps({ center - 10.0f, center + 10.0f }, found);
+	}
+	std::println("bvh: {} overlap queries per ms", 10000 / millisecondsSince(begin));
+
+	// Exponentially spaced objects make SAH peel off a few objects per level, 250 levels deep for these without the
+	// median fallback; depth stays within the traversal stacks
+	{
+		std::vector<Aabb<f64>> chain(1000);
+		for (usize n = 0; n < chain.size(); ++n) {
+			const f64 x = std::ldexp(1.0, (i32)n);
+			chain[n] = { { x, 0, 0 }, { x + 1, 1, 1 } };
+		}
+		Bvh<f64> deep;
+		deep.build(chain);
+		std::vector<u32> depths(deep.nodes().size(), 0);
+		u32 max_depth = 0;
+		for (usize n = 0; n < depths.size(); ++n) {
+			max_depth = std::max(max_depth, depths[n]);
+			if (deep.nodes()[n].count == 0) depths[n + 1] = depths[deep.nodes()[n].offset] = depths[n] + 1;
+		}
+		CHECK(max_depth < Bvh<f64>::MAX_DEPTH);
+		std::vector<u32> all;
+		deep.overlaps({ { 0, 0, 0 }, { std::numeric_limits<f64>::max(), 1, 1 } }, all);
+		CHECK(all.size() == chain.size());
+		const std::optional<Bvh<f64>::Hit> hit = deep.raycast({ { std::ldexp(1.5, 999), 0.5, 0.5 }, { -1, 0, 0 } });
+		CHECK(hit && hit->index == 999);
+	}
+
+	Bvhf empty;
+	empty.build({});
+	CHECK(!empty.raycast(rays[0]));
+	empty.nearest({ 0 }, 4, found);
+	CHECK(found.empty());
+}
+
+}
@@ -0,0 +1,32 @@
+#include "test.h"
+
+namespace Test {
+
+void cameraTests() {
+	Cameraf camera{ { 1, 2, -5 }, Quatf::fromAxisAngle({ 0, 1, 0 }, 0.3f) };
+	const Mat4f projection = Cameraf::perspective(0.1f, 100.0f, 16.0f / 9.0f, 0.8f);
+	const CameraMatricesf m = camera.matrices(projection);
+
+	CHECK(near(m.view_projection * m.inverse_view_projection, Mat4f{ 1 }, 1e-4f));
+	CHECK(near(m.inverse_projection * projection, Mat4f{ 1 }, 1e-4f));
+
+	for (const Vec3f p : { Vec3f{ 0, 0, 0 }, Vec3f{ 3, -1, 4 }, Vec3f{ -2, 5, 10 } }) {
+		const Vec4f clip = m.view_projection * Vec4f{ p, 1 };
+		const Vec3f ndc = Vec3f{ clip.x, clip.y, clip.z } / clip.w;
+		const Vec3f back = m.unproject(ndc);
+		CHECK(near(back.x, p.x, 1e-3f) && near(back.y, p.y, 1e-3f) && near(back.z, p.z, 1e-3f));
+
+		const Vec2f size{ 1920, 1080 };
+		const Vec2f screen{ (ndc.x + 1) / 2 * size.x, (ndc.y + 1) / 2 * size.y };
+		const Rayf ray = m.screenRay(screen, size);
+		const Vec3f to_point = p - ray.origin;
+		const Vec3f closest = ray.origin + ray.direction * to_point.dot(ray.direction);
+		CHECK((closest - p).length() < 1e-3f);
+	}
+
+	const Rayf center = m.screenRay({ 960, 540 }, { 1920, 1080 });
+	const Vec3f forward = camera.rotation * Vec3f{ 0, 0, 1 };
+	CHECK(near(center.direction.x, forward.x, 1e-5f) && near(center.direction.y, forward.y, 1e-5f) && near(center.direction.z, forward.z, 1e-5f));
+}
+
+}
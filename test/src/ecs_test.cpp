@@ -0,0 +1,182 @@
+#include "test.h"
+
+#include <string>
+
+namespace Test {
+
+namespace {
+
+struct Velocity {
+	Vec3f value;
+};
+struct Health {
+	i32 value;
+};
+struct Tag {};
+
+// Counts live instances to check constructors and destructors balance across archetype moves
+struct Tracked {
+	static inline i32 live = 0;
+	std::string name;
+
+	explicit Tracked(std::string name) : name(std::move(name)) { ++live; }
+	Tracked(Tracked&& other) noexcept : name(std::move(other.name)) { ++live; }
+	Tracked& operator=(Tracked&&) noexcept = default;
+	~Tracked() { --live; }
+};
+
+}
+
+void ecsTests() {
+	// Generational handles: destroyed handles stay dead when the index is reused
+	{
+		World world;
+		const Entity a = world.create(Health{ 1 });
+		const Entity b = world.create(Health{ 2 });
+		world.destroy(a);
+		const Entity c = world.create(Health{ 3 });
+		CHECK(c.index == a.index && c.generation == a.generation + 1);
+		CHECK(!world.alive(a) && world.alive(b) && world.alive(c) && world.size() == 2);
+		CHECK(world.get<Health>(a) == nullptr && world.get<Health>(c)->value == 3 && world.get<Health>(b)->value == 2);
+		world.destroy(a);
+		CHECK(world.alive(c) && !Entity{}.valid());
+	}
+
+	// Adding and removing components moves entities between archetypes, keeping values
+	{
+		World world;
+		const Entity e = world.create(Transform3Df{ Vec3f{ 1, 2, 3 } }, Health{ 10 });
+		const Entity other = world.create(Transform3Df{ Vec3f{ 4, 5, 6 } }, Health{ 20 });
+		world.add(e, Velocity{ Vec3f{ 0, 1, 0 } });
+		CHECK(world.has<Velocity>(e) && !world.has<Velocity>(other) && world.archetypeCount() == 3);
+		CHECK(world.get<Transform3Df>(e)->position == (Vec3f{ 1, 2, 3 }) && world.get<Health>(e)->value == 10);
+		CHECK(world.get<Transform3Df>(other)->position == (Vec3f{ 4, 5, 6 }));
+		world.add(e, Velocity{ Vec3f{ 0, 2, 0 } });
+		CHECK(world.get<Velocity>(e)->value.y == 2 && world.archetypeCount() == 3);
+		world.remove<Health>(e);
+		CHECK(!world.has<Health>(e) && world.get<Velocity>(e)->value.y == 2 && world.get<Transform3Df>(e)->position.z == 3);
+		world.remove<Health>(e);
+		world.add(e, Tag{});
+		CHECK(world.has<Tag>(e) && world.size() == 2);
+	}
+
+	// Chunks are 16 KB with 64-byte aligned columns and stay dense through swap-removal
+	{
+		World world;
+		std::vector<Entity> entities;
+		for (i32 n = 0; n < 1000; ++n) entities.push_back(world.create(Transform3Df{ Vec3f{ (f32)n, 0, 0 } }, Health{ n }));
+		const Archetype& archetype = world.archetype(1);
+		CHECK(archetype.capacity() * (sizeof(Entity) + sizeof(Transform3Df) + sizeof(Health)) <= Archetype::CHUNK_SIZE);
+		CHECK(archetype.chunkCount() == (1000 + archetype.capacity() - 1) / archetype.capacity());
+		CHECK((uptr)archetype.column<Transform3Df>(0) % 64 == 0 && (uptr)archetype.column<Health>(0) % 64 == 0);
+		for (i32 n = 0; n < 1000; n += 2) world.destroy(entities[n]);
+		CHECK(archetype.size() == 500 && archetype.chunkCount() == (500 + archetype.capacity() - 1) / archetype.capacity());
+		bool intact = true;
+		for (i32 n = 1; n < 1000; n += 2) intact = intact && world.get<Health>(entities[n])->value == n && world.get<Transform3Df>(entities[n])->position.x == n;
+		CHECK(intact);
+	}
+
+	// Non-trivial components are moved and destroyed exactly once
+	{
+		{
+			World world;
+			const Entity a = world.create(Tracked{ "a" }, Health{ 1 });
+			const Entity b = world.create(Tracked{ "b" }, Health{ 2 });
+			world.create(Tracked{ "c" });
+			world.remove<Health>(a);
+			world.add(b, Tag{});
+			world.destroy(a);
+			CHECK(Tracked::live == 2 && world.get<Tracked>(b)->name == "b");
+			// Through add(), both as a new component and assigned over an existing one
+			const Entity d = world.create(Health{ 4 });
+			world.add(d, Tracked{ "d" });
+			CHECK(Tracked::live == 3 && world.get<Tracked>(d)->name == "d");
+			world.add(d, Tracked{ "e" });
+			CHECK(Tracked::live == 3 && world.get<Tracked>(d)->name == "e");
+		}
+		CHECK(Tracked::live == 0);
+	}
+
+	// Cached queries match every archetype with the components, including ones created later
+	{
+		World world;
+		for (i32 n = 0; n < 100; ++n) world.create(Health{ n });
+		auto query = world.query<Health>();
+		auto moving = world.query<const Transform3Df, Velocity>();
+		CHECK(query.size() == 100 && moving.size() == 0);
+		for (i32 n = 0; n < 50; ++n) world.create(Health{ n }, Transform3Df{}, Velocity{ Vec3f{ 1, 0, 0 } });
+		CHECK(query.size() == 150 && moving.size() == 50);
+
+		i64 sum = 0;
+		query.each([&](const Health& health) { sum += health.value; });
+		CHECK(sum == 4950 + 1225);
+		bool handles = true;
+		query.each([&](const Entity entity, Health& health) { handles = handles && world.get<Health>(entity) == &health; });
+		CHECK(handles);
+		usize rows = 0;
+		moving.eachChunk([&](const std::span<const Entity> entities, const std::span<const Transform3Df> transforms, const std::span<Velocity> velocities) {
+			CHECK(entities.size() == transforms.size() && transforms.size() == velocities.size());
+			rows += entities.size();
+		});
+		CHECK(rows == 50);
+	}
+
+	// Parallel iteration covers every entity once
+	{
+		World world;
+		JobSystem jobs{ 3 };
+		for (i32 n = 0; n < 20000; ++n) world.create(Transform3Df{ Vec3f{ (f32)n, 0, 0 } }, Velocity{ Vec3f{ 1, 2, 3 } });
+		for (i32 n = 0; n < 5000; ++n) world.create(Transform3Df{}, Velocity{ Vec3f{ 1, 2, 3 } }, Tag{});
+		auto query = world.query<Transform3Df, const Velocity>();
+		query.parallelEach([](Transform3Df& transform, const Velocity& velocity) { transform.position += velocity.value; }, jobs);
+		bool moved = true;
+		i32 n = 0;
+		query.each([&](const Transform3Df& transform, const Velocity&) {
+			moved = moved && transform.position.y == 2 && transform.position.z == 3;
+			++n;
+		});
+		CHECK(moved && n == 25000);
+	}
+
+	// Command buffers defer structural changes to apply(), skipping stale handles
+	{
+		World world;
+		std::vector<Entity> entities;
+		for (i32 n = 0; n < 10; ++n) entities.push_back(world.create(Health{ n }));
+		CommandBuffer commands;
+		world.query<Health>().each([&](const Entity entity, const Health& health) {
+			if (health.value % 2 == 0) commands.destroy(entity);
+			else commands.add(entity, Velocity{ Vec3f{ (f32)health.value, 0, 0 } });
+		});
+		commands.create(Health{ 100 }, Tracked{ "deferred" });
+		commands.remove<Health>(entities[1]);
+		commands.add(entities[0], Tracked{ "stale" });
+		CHECK(world.size() == 10 && commands.size() == 15);
+		world.apply(commands);
+		CHECK(commands.empty() && world.size() == 6 && Tracked::live == 1);
+		CHECK(!world.alive(entities[0]) && world.has<Velocity>(entities[3]) && !world.has<Health>(entities[1]));
+		const usize deferred = world.query<Health, Tracked>().size();
+		CHECK(deferred == 1 && world.query<Velocity>().size() == 5);
+
+		commands.create(Tracked{ "dropped" });
+		commands.clear();
+		CHECK(Tracked::live == 1);
+	}
+
+	// Streaming a million transforms over many chunks visits each once; ecs_bench times it
+	{
+		constexpr i32 COUNT = 1'000'000;
+		World world;
+		for (i32 n = 0; n < COUNT; ++n) world.create(Transform3Df{ Vec3f{ (f32)n, 0, 0 } });
+		auto query = world.query<const Transform3Df>();
+		f32 sum = 0;
+		for (i32 pass = 0; pass < 5; ++pass) {
+			query.eachChunk([&](std::span<const Entity>, const std::span<const Transform3Df> transforms) {
+				for (const Transform3Df& transform : transforms) sum += transform.scale.x;
+			});
+		}
+		CHECK(sum == 5.0f * COUNT);
+	}
+}
+
+}
@@ -0,0 +1,63 @@
+#include "test.h"
+
+#include <random>
+#include <array>
+
+namespace Test {
+
+void frustumTests() {
+	const Cameraf camera{ { 0, 0, -20 }, Quatf::fromAxisAngle({ 0, 1, 0 }, 0.2f) };
+	const Frustumf frustum = camera.matrices(Cameraf::perspective(0.1f, 100.0f, 16.0f / 9.0f, 0.8f)).frustum();
+
+	CHECK(frustum.containsSphere({ 0, 0, 0 }, 1));
+	CHECK(!frustum.containsSphere({ 0, 0, -30 }, 1));
+	CHECK(frustum.containsSphere({ 0, 0, -30 }, 11));
+	CHECK(!frustum.containsSphere({ 0, 0, 200 }, 1));
+	CHECK(frustum.intersectsBox({ -1, -1, -1 }, { 1, 1, 1 }));
+	CHECK(!frustum.intersectsBox({ -1, -1, -40 }, { 1, 1, -30 }));
+
+	std::mt19937 rng{ 3456 };
+	std::uniform_real_distribution<f32> position{ -150.0f, 150.0f };
+	std::uniform_real_distribution<f32> size{ 0.1f, 5.0f };
+
+	constexpr usize COUNT = 1 << 20;
+	std::vector<f32> x(COUNT), y(COUNT), z(COUNT), radius(COUNT);
+	std::vector<f32> min_x(COUNT), min_y(COUNT), min_z(COUNT), max_x(COUNT), max_y(COUNT), max_z(COUNT);
+	for (usize n = 0; n < COUNT; ++n) {
+		x[n] = position(rng);
+		y[n] = position(rng);
+		z[n] = position(rng);
+		radius[n] = size(rng);
+		min_x[n] = x[n] - size(rng);
+		min_y[n] = y[n] - size(rng);
+		min_z[n] = z[n] - size(rng);
+		max_x[n] = x[n] + size(rng);
+		max_y[n] = y[n] + size(rng);
+		max_z[n] = z[n] + size(rng);
+	}
+	const BoundingBoxes boxes{ min_x, min_y, min_z, max_x, max_y, max_z };
+
+	std::vector<u32> expected_spheres;
+	std::vector<u32> expected_boxes;
+	for (usize n = 0; n < COUNT; ++n) {
+		if (frustum.containsSphere({ x[n], y[n], z[n] }, radius[n])) expected_spheres.push_back((u32)n);
+		if (frustum.intersectsBox({ min_x[n], min_y[n], min_z[n] }, { max_x[n], max_y[n], max_z[n] })) expected_boxes.push_back((u32)n);
+	}
+
+	std::vector<u32> visible(COUNT);
+	// 32769 on 2 threads is just past two chunks of the minimum size, so must not split into a third
+	for (const usize threads : { 1, 2, 4 }) {
+		for (const usize count : std::array<usize, 7>{ 0, 5, 8, 13, 1000, 32769, COUNT }) {
+			const usize found = frustum.cullSpheres({
+				std::span(x).first(count), std::span(y).first(count), std::span(z).first(count), std::span(radius).first(count)
+			}, visible, threads);
+			const usize expected = (usize)(std::lower_bound(expected_spheres.begin(), expected_spheres.end(), (u32)count) - expected_spheres.begin());
+			CHECK(found == expected && std::equal(visible.begin(), visible.begin() + found, expected_spheres.begin()));
+		}
+
+		const usize found = frustum.cullBoxes(boxes, visible, threads);
+		CHECK(found == expected_boxes.size() && std::equal(visible.begin(), visible.begin() + found, expected_boxes.begin()));
+	}
+}
+
+}
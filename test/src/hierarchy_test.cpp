@@ -0,0 +1,113 @@
+#include "test.h"
+
+#include <random>
+
+namespace Test {
+
+namespace {
+
+// World matrix by walking up the parents, the slow path the hierarchy replaces
+Mat4f composed(const Hierarchyf& hierarchy, const u32 id) {
+	const Mat4f local = hierarchy.local(id).matrix();
+	const u32 parent = hierarchy.parent(id);
+	return parent == Hierarchyf::NONE ? local : composed(hierarchy, parent) * local;
+}
+
+bool matchesComposed(const Hierarchyf& hierarchy, const std::vector<u32>& ids) {
+	for (const u32 id : ids) {
+		if (hierarchy.contains(id) && !near(hierarchy.world(id), composed(hierarchy, id), 1e-4f)) return false;
+	}
+	return true;
+}
+
+}
+
+void hierarchyTests() {
+	std::mt19937 rng{ 3456 };
+	std::uniform_real_distribution<f32> dist{ -1.0f, 1.0f };
+	std::uniform_real_distribution<f32> scale{ 0.8f, 1.2f };
+	auto randomTransform = [&]() {
+		return Transform3Df{
+			{ dist(rng) * 4, dist(rng) * 4, dist(rng) * 4 },
+			{ scale(rng), scale(rng), scale(rng) },
+			Quatf::fromAxisAngle(Vec3f{ dist(rng), dist(rng), dist(rng) }.normalized(), dist(rng) * 3),
+		};
+	};
+
+	// A forest with 64 roots and children under random earlier nodes
+	Hierarchyf hierarchy;
+	std::vector<u32> ids;
+	for (i32 n = 0; n < 2000; ++n) {
+		const u32 parent = n < 64 ? Hierarchyf::NONE : ids[std::uniform_int_distribution<usize>{ 0, ids.size() - 1 }(rng)];
+		ids.push_back(hierarchy.add(randomTransform(), parent));
+	}
+	CHECK(hierarchy.update() == 2000);
+	CHECK(matchesComposed(hierarchy, ids));
+	for (usize n = 0; n < hierarchy.size(); ++n) {
+		CHECK(hierarchy.parents()[n] == Hierarchyf::NONE || hierarchy.parents()[n] < n);
+	}
+
+	// Nothing moved, nothing recomputed
+	CHECK(hierarchy.update() == 0);
+
+	// Moving a leaf recomputes only the leaf, moving a root recomputes its subtree
+	u32 leaf = ids.back();
+	hierarchy.setPosition(leaf, { 1, 2, 3 });
+	CHECK(hierarchy.update() == 1);
+	CHECK(near(hierarchy.world(leaf), composed(hierarchy, leaf), 1e-4f));
+
+	usize subtree = 0;
+	for (const u32 id : ids) {
+		for (u32 ancestor = id; ancestor != Hierarchyf::NONE; ancestor = hierarchy.parent(ancestor)) {
+			if (ancestor == ids[0]) ++subtree;
+		}
+	}
+	hierarchy.setRotation(ids[0], Quatf::fromAxisAngle({ 0, 1, 0 }, 0.5f));
+	hierarchy.setScale(ids[0], { 2, 2, 2 });
+	const u32 child = ids[100];
+	hierarchy.setLocal(child, randomTransform());
+	const usize updated = hierarchy.update();
+	CHECK(updated >= subtree && updated <= subtree + hierarchy.size() / 2);
+	CHECK(matchesComposed(hierarchy, ids));
+
+	// Reparenting and removal re-sort the arrays and keep ids stable
+	CHECK(hierarchy.setParent(ids[10], ids[1500]));
+	CHECK(hierarchy.setParent(ids[1999], Hierarchyf::NONE));
+	hierarchy.remove(ids[20]);
+	CHECK(!hierarchy.contains(ids[20]));
+	hierarchy.update();
+	CHECK(hierarchy.parent(ids[10]) == ids[1500] && hierarchy.parent(ids[1999]) == Hierarchyf::NONE);
+	CHECK(matchesComposed(hierarchy, ids));
+	for (const u32 id : ids) {
+		if (!hierarchy.contains(id)) continue;
+		for (u32 ancestor = id; ancestor != Hierarchyf::NONE; ancestor = hierarchy.parent(ancestor)) CHECK(ancestor != ids[20]);
+	}
+	const u32 reused = hierarchy.add(randomTransform(), ids[10]);
+	hierarchy.update();
+	CHECK(hierarchy.parent(reused) == ids[10] && near(hierarchy.world(reused), composed(hierarchy, reused), 1e-4f));
+
+	// Reparenting under itself or a descendant is refused
+	CHECK(!hierarchy.setParent(ids[10], ids[10]) && !hierarchy.setParent(ids[1500], reused));
+	CHECK(hierarchy.parent(ids[10]) == ids[1500] && hierarchy.update() == 0);
+
+	// Threaded updates produce the same matrices
+	for (const u32 id : ids) {
+		if (hierarchy.contains(id) && rng() % 4 == 0) hierarchy.setPosition(id, { dist(rng), dist(rng), dist(rng) });
+	}
+	hierarchy.update(4);
+	CHECK(matchesComposed(hierarchy, ids));
+
+	// 100k nodes in 1000 characters of 100 bones: moving 1% of the characters recomputes only their subtrees
+	Hierarchyf scene;
+	std::vector<u32> roots;
+	for (i32 character = 0; character < 1000; ++character) {
+		std::vector<u32> bones{ scene.add(randomTransform()) };
+		roots.push_back(bones[0]);
+		for (i32 bone = 1; bone < 100; ++bone) bones.push_back(scene.add(randomTransform(), bones[std::uniform_int_distribution<usize>{ 0, bones.size() - 1 }(rng)]));
+	}
+	CHECK(scene.update() == scene.size());
+	for (i32 n = 0; n < 10; ++n) scene.setPosition(roots[rng() % roots.size()], { dist(rng), dist(rng), dist(rng) });
+	CHECK(scene.update() <= 1000);
+}
+
+}
@@ -0,0 +1,112 @@
+#include "test.h"
+
+#include <functional>
+
+namespace Test {
+
+void jobsTests() {
+	// Deque: owner is LIFO, thieves are FIFO
+	{
+		WorkStealingDeque<usize*, 8> deque;
+		usize values[9]{};
+		for (usize n = 0; n < 8; ++n) CHECK(deque.push(&values[n]));
+		CHECK(!deque.push(&values[8]) && deque.size() == 8);
+		CHECK(deque.pop() == &values[7] && deque.steal() == &values[0] && deque.steal() == &values[1]);
+		CHECK(deque.push(&values[8]) && deque.size() == 6);
+		for (usize n = 0; n < 6; ++n) CHECK(deque.pop() != nullptr);
+		CHECK(deque.pop() == nullptr && deque.steal() == nullptr);
+	}
+
+	// Every pushed item is taken exactly once while thieves race the owner
+	{
+		constexpr usize ITEMS = 200000;
+		WorkStealingDeque<usize*> deque;
+		std::vector<usize> items(ITEMS);
+		std::vector<std::atomic<u32>> taken(ITEMS);
+		std::atomic<bool> done{ false };
+		auto take = [&](usize* item) { taken[(usize)(item - items.data())].fetch_add(1, std::memory_order_relaxed); };
+		{
+			std::vector<std::jthread> thieves;
+			for (i32 n = 0; n < 3; ++n) {
+				thieves.emplace_back([&]() {
+					while (!done.load(std::memory_order_acquire)) {
+						if (usize* item = deque.steal()) take(item);
+					}
+				});
+			}
+			for (usize n = 0; n < ITEMS; ++n) {
+				while (!deque.push(&items[n])) {
+					if (usize* item = deque.pop()) take(item);
+				}
+				if (n % 3 == 0) {
+					if (usize* item = deque.pop()) take(item);
+				}
+			}
+			while (usize* item = deque.pop()) take(item);
+			while (deque.size() > 0) std::this_thread::yield();
+			done.store(true, std::memory_order_release);
+		}
+		CHECK(std::ranges::all_of(taken, [](const std::atomic<u32>& count) { return count.load() == 1; }));
+	}
+
+	JobSystem jobs{ 3 };
+	CHECK(jobs.workerCount() == 3 && jobs.threadCount() == 4);
+
+	// parallelFor covers the range exactly once, with 8-aligned interior bounds
+	{
+		constexpr usize COUNT = 1'000'003;
+		std::vector<u8> hits(COUNT, 0);
+		std::atomic<bool> aligned{ true };
+		jobs.parallelFor(COUNT, 64, [&](const usize begin, const usize end) {
+			if (begin % 8 != 0 || (end % 8 != 0 && end != COUNT)) aligned.store(false);
+			for (usize n = begin; n < end; ++n) ++hits[n];
+		});
+		CHECK(std::ranges::all_of(hits, [](const u8 hit) { return hit == 1; }) && aligned.load());
+	}
+
+	// Fork-join with counters, including waits nested inside jobs
+	{
+		std::atomic<u64> sum{ 0 };
+		JobSystem::Counter outer;
+		std::vector<std::function<void()>> parents;
+		for (u64 p = 0; p < 16; ++p) {
+			parents.emplace_back([&jobs, &sum, p]() {
+				jobs.parallelFor(1000, 1, [&](const usize begin, const usize end) {
+					u64 local = 0;
+					for (usize n = begin; n < end; ++n) local += p * 1000 + n;
+					sum.fetch_add(local);
+				});
+			});
+		}
+		for (const std::function<void()>& parent : parents) jobs.run(outer, parent);
+		jobs.wait(outer);
+		CHECK(outer.done() && sum.load() == 16000 * 15999 / 2);
+	}
+
+	// Without workers everything runs on the caller
+	{
+		JobSystem serial{ 0 };
+		const std::thread::id caller = std::this_thread::get_id();
+		bool on_caller = true;
+		serial.parallelFor(10000, 1, [&](usize, usize) { on_caller = on_caller && std::this_thread::get_id() == caller; });
+		JobSystem::Counter counter;
+		auto job = [&]() { on_caller = on_caller && std::this_thread::get_id() == caller; };
+		serial.run(counter, job);
+		serial.wait(counter);
+		CHECK(on_caller && counter.done());
+	}
+
+	// The shared pool behind parallelChunks keeps chunks contiguous
+	{
+		std::vector<usize> chunk_begins(4, ~usize{ 0 });
+		std::vector<usize> chunk_ends(4, 0);
+		const usize chunks = parallelChunks(100000, 4, 1000, [&](const usize chunk, const usize begin, const usize end) {
+			chunk_begins[chunk] = begin;
+			chunk_ends[chunk] = end;
+		});
+		CHECK(chunks == 4 && chunk_begins[0] == 0 && chunk_begins[1] == 25000 && chunk_begins[3] == 75000);
+		CHECK(chunk_ends[0] == chunk_begins[1] && chunk_ends[2] == chunk_begins[3] && chunk_ends[3] == 100000);
+	}
+}
+
+}
@@ -0,0 +1,110 @@
+#include "test.h"
+
+#include <random>
+
+namespace Test {
+
+namespace {
+
+Vec4f referenceMul(const Mat4f& m, const Vec4f& v) {
+	Vec4f result;
+	for (usize row = 0; row < 4; ++row) {
+		for (usize col = 0; col < 4; ++col) result[row] += m(col, row) * v[col];
+	}
+	return result;
+}
+
+Mat4f referenceMul(const Mat4f& a, const Mat4f& b) {
+	Mat4f result;
+	for (usize col = 0; col < 4; ++col) result[col] = referenceMul(a, b[col]);
+	return result;
+}
+
+f32 referenceDeterminant(const Mat4f& m) {
+	f32 det = 0;
+	for (usize col = 0; col < 4; ++col) {
+		Mat3f minor;
+		for (usize c = 0, mc = 0; c < 4; ++c) {
+			if (c == col) continue;
+			for (usize row = 1; row < 4; ++row) minor(mc, row - 1) = m(c, row);
+			++mc;
+		}
+		det += (col % 2 == 0 ? 1.0f : -1.0f) * m(col, 0) * minor.determinant();
+	}
+	return det;
+}
+
+constexpr Mat4f A{
+	{ 1.5f, -2.0f, 0.25f, 3.0f },
+	{ 0.5f, 4.0f, -1.0f, 2.0f },
+	{ -3.0f, 1.0f, 2.5f, 0.75f },
+	{ 2.0f, 0.0f, 1.0f, -1.0f },
+};
+constexpr Mat4f B{
+	{ 0.0f, 1.0f, -2.0f, 0.5f },
+	{ 3.0f, -0.5f, 1.0f, 2.0f },
+	{ 1.0f, 1.0f, 1.0f, 1.0f },
+	{ -4.0f, 2.0f, 0.5f, 1.5f },
+};
+constexpr Vec4f V{ 0.5f, -1.5f, 2.0f, 1.0f };
+
+// Evaluated at compile time, so these always come from the scalar path
+constexpr Mat4f SCALAR_PRODUCT = A * B;
+constexpr Vec4f SCALAR_TRANSFORM = A * V;
+constexpr Mat4f SCALAR_TRANSPOSE = A.transposed();
+constexpr f32 SCALAR_DETERMINANT = A.determinant();
+constexpr f32 SCALAR_DOT = V.dot(A.x);
+constexpr Mat4f SCALAR_INVERSE = A.inverted();
+constexpr Mat4f SCALAR_RIGID_INVERSE = Mat4f{ Quatf{ 0.5f, 0.5f, -0.5f, 0.5f }.matrix() }.rigidInverted();
+
+}
+
+void matrixTests() {
+	CHECK(near(A * B, SCALAR_PRODUCT));
+	CHECK(near(A * V, SCALAR_TRANSFORM));
+	CHECK(near(A.transposed(), SCALAR_TRANSPOSE, 0));
+	CHECK(near(A.determinant(), SCALAR_DETERMINANT));
+	CHECK(near(V.dot(A.x), SCALAR_DOT));
+
+	CHECK(near(SCALAR_PRODUCT, referenceMul(A, B)));
+	CHECK(near(SCALAR_DETERMINANT, referenceDeterminant(A)));
+	CHECK(Mat4f{ 2 }.determinant() == 16);
+
+	CHECK(near(A.inverted(), SCALAR_INVERSE));
+	CHECK(near(A * SCALAR_INVERSE, Mat4f{ 1 }));
+	CHECK(near(Mat4f{ Quatf{ 0.5f, 0.5f, -0.5f, 0.5f }.matrix() }.rigidInverted(), SCALAR_RIGID_INVERSE));
+
+	std::mt19937 rng{ 1234 };
+	std::uniform_real_distribution<f32> dist{ -10.0f, 10.0f };
+	auto random_vec = [&]() { return Vec4f{ dist(rng), dist(rng), dist(rng), dist(rng) }; };
+	for (i32 i = 0; i < 1000; ++i) {
+		const Mat4f a{ random_vec(), random_vec(), random_vec(), random_vec() };
+		const Mat4f b{ random_vec(), random_vec(), random_vec(), random_vec() };
+		const Vec4f v = random_vec();
+
+		CHECK(near(a * b, referenceMul(a, b), 1e-4f));
+		CHECK(near(a * v, referenceMul(a, v), 1e-4f));
+		CHECK(near(a.transposed().transposed(), a, 0));
+		CHECK(a.transposed().row(2) == a.z);
+		CHECK(near(a.determinant(), referenceDeterminant(a), 1e-3f));
+		CHECK(near(a.x.dot(v), a.x.x * v.x + a.x.y * v.y + a.x.z * v.z + a.x.w * v.w, 1e-4f));
+
+		// Diagonally dominant so the inverse is well conditioned
+		const Mat4f d{ a.x + Vec4f{ 50, 0, 0, 0 }, a.y + Vec4f{ 0, 50, 0, 0 }, a.z + Vec4f{ 0, 0, 50, 0 }, a.w + Vec4f{ 0, 0, 0, 50 } };
+		CHECK(near(d * d.inverted(), Mat4f{ 1 }, 1e-4f));
+		CHECK(near(d.inverted() * d, Mat4f{ 1 }, 1e-4f));
+
+		const Quatf q = Quatf::fromAxisAngle(Vec3f{ v.x, v.y, v.z }.normalized(), v.w);
+		const Transform3Df transform{ { v.x, v.y, v.z }, { 1 + std::abs(v.y), 1 + std::abs(v.z), 1 + std::abs(v.x) }, q };
+		const Mat4f m = transform.matrix();
+		CHECK(near(m.affineInverted(), m.inverted(), 1e-4f));
+		CHECK(near(transform.inverseMatrix(), m.inverted(), 1e-4f));
+		CHECK(near(m * transform.inverseMatrix(), Mat4f{ 1 }, 1e-4f));
+
+		const Cameraf camera{ { v.z, v.y, v.x }, q };
+		CHECK(near(camera.view().rigidInverted(), camera.world(), 1e-4f));
+		CHECK(near(camera.view().inverted(), camera.world(), 1e-4f));
+	}
+}
+
+}
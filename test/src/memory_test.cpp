@@ -0,0 +1,166 @@
+#include "test.h"
+
+#include <fstream>
+#include <map>
+#include <sstream>
+
+namespace Test {
+
+void memoryTests() {
+	// Bump allocation honours alignment and rewinds to markers
+	{
+		LinearArena arena{ 1024 };
+		std::byte* a = static_cast<std::byte*>(arena.allocate(3, 1));
+		f64* b = arena.allocate<f64>(4);
+		void* c = arena.allocate(16, 64);
+		CHECK((uptr)b % alignof(f64) == 0 && (uptr)c % 64 == 0 && (std::byte*)b >= a + 3);
+		const LinearArena::Marker marker = arena.mark();
+		void* d = arena.allocate(100);
+		arena.rewind(marker);
+		CHECK(arena.allocate(100) == d && arena.overflowCount() == 0);
+	}
+
+	// Overflow goes to the heap once, then the block grows to the high-water mark
+	{
+		LinearArena arena{ 256 };
+		for (i32 frame = 0; frame < 3; ++frame) {
+			const u64 heap = HeapMonitor::threadAllocations();
+			for (i32 n = 0; n < 10; ++n) CHECK(arena.allocate(100, 16) != nullptr);
+			CHECK(arena.used() >= 1000);
+			if (frame == 0) CHECK(arena.overflowCount() > 0);
+			else CHECK(arena.overflowCount() == 0 && HeapMonitor::threadAllocations() == heap);
+			arena.reset();
+		}
+		CHECK(arena.capacity() >= 1000 && arena.highWater() >= 1000 && arena.used() == 0);
+	}
+
+	// Concurrent allocations never overlap
+	{
+		LinearArena arena{ 64 * 1024 };
+		JobSystem jobs{ 3 };
+		std::vector<u32*> blocks(4096);
+		jobs.parallelFor(blocks.size(), 1, [&](const usize begin, const usize end) {
+			for (usize n = begin; n < end; ++n) {
+				blocks[n] = static_cast<u32*>(arena.allocateConcurrent(sizeof(u32) * 4, alignof(u32)));
+				std::fill_n(blocks[n], 4, (u32)n);
+			}
+		});
+		bool intact = true;
+		for (usize n = 0; n < blocks.size(); ++n) intact = intact && std::all_of(blocks[n], blocks[n] + 4, [n](const u32 value) { return value == n; });
+		CHECK(intact && arena.used() >= 4096 * 16);
+	}
+
+	// Frame memory survives one flip and is recycled by the second
+	{
+		FrameArena frames{ 4096 };
+		i32* first = frames.create<i32>(1);
+		frames.flip();
+		i32* second = frames.create<i32>(2);
+		CHECK(*first == 1 && first != second && frames.previous().used() > 0);
+		frames.flip();
+		CHECK(frames.create<i32>(3) == first && *second == 2 && frames.frame() == 2);
+	}
+
+	// Scratch scopes nest like the stack, per thread
+	{
+		void* outer_begin = nullptr;
+		{
+			ScratchScope outer;
+			outer_begin = outer.allocate<f32>(16);
+			void* inner_begin = nullptr;
+			{
+				ScratchScope inner;
+				inner_begin = inner.allocate<f32>(1000);
+			}
+			ScratchScope again;
+			CHECK(again.allocate<f32>(1000) == inner_begin);
+		}
+		ScratchScope scope;
+		CHECK(scope.allocate<f32>(16) == outer_begin);
+		void* other = nullptr;
+		std::jthread{ [&]() { ScratchScope thread_scope; other = thread_scope.allocate<f32>(16); } }.join();
+		CHECK(other != outer_begin);
+	}
+
+	// Pools recycle blocks in O(1) and construct objects in place
+	{
+		BlockPool pool{ 24, 4 };
+		CHECK(pool.blockSize() == 32);
+		std::array<void*, 6> blocks{};
+		for (void*& block : blocks) block = pool.allocate();
+		CHECK(pool.size() == 6 && pool.capacity() == 8 && (uptr)blocks[0] % 16 == 0);
+		CHECK(static_cast<std::byte*>(blocks[1]) == static_cast<std::byte*>(blocks[0]) + 32);
+		pool.free(blocks[2]);
+		CHECK(pool.allocate() == blocks[2] && pool.capacity() == 8);
+
+		struct Counted {
+			i32* live;
+			explicit Counted(i32* live) : live(live) { ++*live; }
+			~Counted() { --*live; }
+		};
+		i32 live = 0;
+		ObjectPool<Counted> objects;
+		Counted* a = objects.create(&live);
+		Counted* b = objects.create(&live);
+		objects.destroy(a);
+		CHECK(live == 1 && objects.size() == 1 && objects.create(&live) == a);
+		objects.destroy(a);
+		objects.destroy(b);
+		CHECK(live == 0);
+	}
+
+	// Allocator adapters keep std containers off the general heap once warm
+	{
+		LinearArena arena{ 1024 };
+		ArenaVector<i32> values{ arena };
+		for (i32 n = 0; n < 100; ++n) values.push_back(n);
+		CHECK(values.size() == 100 && values[99] == 99 && arena.used() >= 400);
+
+		PoolSet pools;
+		using Map = std::map<i32, f32, std::less<>, PoolAllocator<std::pair<const i32, f32>>>;
+		Map map{ PoolAllocator<std::pair<const i32, f32>>{ pools } };
+		u64 steady_allocations = 0;
+		for (i32 frame = 0; frame < 4; ++frame) {
+			const u64 heap = HeapMonitor::threadAllocations();
+			for (i32 n = 0; n < 200; ++n) map[n] = (f32)n;
+			map.clear();
+			if (frame > 0) steady_allocations += HeapMonitor::threadAllocations() - heap;
+		}
+		usize pooled = 0;
+		for (usize size_class = 0; size_class < PoolSet::CLASSES; ++size_class) pooled += pools.pool(size_class).capacity();
+		CHECK(steady_allocations == 0 && pooled >= 200);
+	}
+
+	// Tagged allocations are charged to their tag and released from any thread
+	if constexpr (MemoryTracker::enabled()) {
+		const u32 tag = MemoryTracker::tag("memory test");
+		CHECK(tag != 0 && MemoryTracker::tag("memory test") == tag && MemoryTracker::current() == 0);
+		MemoryTracker::endFrame();
+		std::vector<u8>* bytes = nullptr;
+		{
+			MIRROR_MEMORY_TAG("memory test");
+			CHECK(MemoryTracker::current() == tag);
+			bytes = new std::vector<u8>(4096);
+		}
+		MemoryTracker::endFrame();
+		MemoryTracker::Snapshot snapshot = MemoryTracker::snapshot();
+		const MemoryTracker::TagSummary& summary = snapshot.tags[tag];
+		CHECK(summary.live_bytes == 4096 + sizeof(std::vector<u8>) && summary.allocations == 2 && summary.frame_allocations == 2);
+		CHECK(std::string_view{ summary.name } == "memory test" && snapshot.live_bytes >= summary.live_bytes);
+
+		std::jthread{ [&]() { delete bytes; } }.join();
+		MemoryTracker::endFrame();
+		snapshot = MemoryTracker::snapshot();
+		CHECK(snapshot.tags[tag].live_bytes == 0 && snapshot.tags[tag].frees == 2 && snapshot.tags[tag].peak_bytes >= 4096);
+		CHECK(snapshot.tags[tag].frame_allocations == 0 && snapshot.peak_bytes >= snapshot.live_bytes);
+
+		const std::string path = "memory_tags.csv";
+		CHECK(MemoryTracker::writeCsv(snapshot, path));
+		std::stringstream csv;
+		csv << std::ifstream{ path }.rdbuf();
+		CHECK(csv.str().find("tag,live_bytes,peak_bytes") != std::string::npos && csv.str().find("\nmemory test,0,") != std::string::npos);
+		std::remove(path.c_str());
+	}
+}
+
+}
@@ -0,0 +1,74 @@
+#include "test.h"
+
+#include "mirror.h"
+
+#include <chrono>
+
+namespace Test {
+
+namespace {
+
+struct Simulation {};
+
+}
+
+void mirrorTests() {
+	// Headless engines run the whole update pipeline without a window
+	{
+		Mirror::Mirror engine{ Mirror::Mirror::Headless{} };
+		CHECK(engine.headless());
+		u64 simulated = 0;
+		engine.systems().add("simulate", [&]() { ++simulated; }).writes<Simulation>();
+		for (i32 frame = 0; frame < 10; ++frame) engine.update();
+		CHECK(engine.frame() == 10 && simulated == 10 && engine.systems().lastReport().frame == 10);
+	}
+
+	// Threaded rendering: every publication is rendered or dropped for a newer one, and flush() catches up
+	{
+		Mirror::Mirror engine{ Mirror::Mirror::Headless{} };
+		engine.renderer().setThreaded(true);
+		CHECK(engine.renderer().threaded());
+		engine.systems().add("sprites", [&engine]() {
+			engine.renderer().sprites().submit(Reflect::DrawKey::make(0, 0, 0), SpriteInstance{});
+		}).writes<Reflect::Renderer>();
+		for (i32 frame = 0; frame < 100; ++frame) engine.update();
+		engine.renderer().flush();
+		const Reflect::Renderer::Latency& latency = engine.renderer().latency();
+		CHECK(latency.published == 100 && latency.rendered >= 1 && latency.rendered + latency.dropped == 100);
+		CHECK(latency.max_ms >= latency.meanMs() && latency.meanMs() > 0);
+		engine.renderer().setThreaded(false);
+		engine.update();
+		CHECK(!engine.renderer().threaded() && engine.renderer().latency().rendered + latency.dropped == 101);
+	}
+
+	// Once warmed up, frames don't touch the general heap: render queues, zone stats and system reports keep their size
+	if constexpr (HeapMonitor::enabled()) {
+		Mirror::Mirror engine{ Mirror::Mirror::Headless{} };
+		engine.systems().add("sprites", [&engine]() {
+			for (u32 n = 0; n < 100; ++n) engine.renderer().sprites().submit(Reflect::DrawKey::make(0, 0, n % 4), SpriteInstance{});
+		}).writes<Reflect::Renderer>();
+		u64 allocations = 0;
+		for (u64 frame = 0; frame < Mirror::Mirror::HEAP_WARMUP_FRAMES + 60; ++frame) {
+			engine.update();
+			if (engine.frame() > Mirror::Mirror::HEAP_WARMUP_FRAMES) allocations += engine.lastFrameAllocations();
+		}
+		CHECK(allocations == 0 && engine.lastFrameAllocations() == 0);
+	}
+
+	// Fixed deltas step the same way on every run, whatever the wall clock does
+	{
+		auto run = []() {
+			FrameScheduler scheduler{ .step_sec = 1.0 / 60.0, .fixed_delta_sec = 1.0 / 144.0 };
+			std::vector<u32> steps;
+			for (i32 frame = 0; frame < 300; ++frame) {
+				steps.push_back(scheduler.beginFrame());
+				if (frame % 50 == 0) std::this_thread::sleep_for(std::chrono::milliseconds(2));
+			}
+			return steps;
+		};
+		const std::vector<u32> first = run();
+		CHECK(first == run() && std::accumulate(first.begin(), first.end(), 0u) == 124);
+	}
+}
+
+}
@@ -0,0 +1,123 @@
+#include "test.h"
+
+#include <random>
+#include <numbers>
+
+namespace Test {
+
+namespace {
+
+[[nodiscard]] bool isNan(const u16 half) {
+	return (half & 0x7C00u) == 0x7C00u && (half & 0x03FFu) != 0;
+}
+
+}
+
+void packingTests() {
+	std::mt19937 rng{ 1234 };
+
+	// Every half survives a round trip through f32, and the batch path agrees with the scalar one
+	std::vector<u16> halfs(65536);
+	std::vector<f32> floats(65536);
+	for (u32 n = 0; n < 65536; ++n) halfs[n] = (u16)n;
+	unpackHalfs(halfs, floats);
+	for (u32 n = 0; n < 65536; ++n) {
+		if (isNan((u16)n)) {
+			CHECK(std::isnan(floats[n]));
+			continue;
+		}
+		CHECK(std::bit_cast<u32>(floats[n]) == std::bit_cast<u32>(unpackHalf((u16)n)));
+		CHECK(packHalf(floats[n]) == n);
+	}
+	CHECK(isNan(packHalf(std::numeric_limits<f32>::quiet_NaN())));
+	CHECK(packHalf(1e6f) == 0x7C00 && packHalf(-1e6f) == 0xFC00 && packHalf(65504.0f) == 0x7BFF);
+	CHECK(packHalf(1e-10f) == 0 && packHalf(-0.0f) == 0x8000);
+
+	// Rounds to the nearest half within the documented bounds
+	std::uniform_real_distribution<f32> exponent{ -27, 15.9f };
+	std::vector<f32> values(100003);
+	for (f32& value : values) value = std::exp2(exponent(rng)) * (rng() & 1 ? -1.0f : 1.0f);
+	std::vector<u16> packed(values.size());
+	packHalfs(values, packed);
+	for (usize n = 0; n < values.size(); ++n) {
+		const u16 half = packHalf(values[n]);
+		CHECK(packed[n] == half);
+		const f32 error = std::abs(unpackHalf(half) - values[n]);
+		CHECK(error <= std::max(std::abs(values[n]) * std::exp2(-11.0f), std::exp2(-25.0f)));
+		CHECK(error <= std::abs(unpackHalf(half + 1) - values[n]));
+		if ((half & 0x7FFF) != 0) CHECK(error <= std::abs(unpackHalf(half - 1) - values[n]));
+	}
+
+	std::uniform_real_distribution<f32> unit{ -1.5f, 1.5f };
+	for (i32 n = 0; n < 10000; ++n) {
+		const f32 v = unit(rng);
+		CHECK(std::abs(unpackSnorm(packSnorm<i16>(v)) - std::clamp(v, -1.0f, 1.0f)) <= 0.5f / 32767 + 1e-7f);
+		CHECK(std::abs(unpackSnorm(packSnorm<i8>(v)) - std::clamp(v, -1.0f, 1.0f)) <= 0.5f / 127 + 1e-7f);
+		CHECK(std::abs(unpackUnorm(packUnorm<u16>(v)) - std::clamp(v, 0.0f, 1.0f)) <= 0.5f / 65535 + 1e-7f);
+		CHECK(std::abs(unpackUnorm(packUnorm<u8>(v)) - std::clamp(v, 0.0f, 1.0f)) <= 0.5f / 255 + 1e-7f);
+	}
+	CHECK(unpackSnorm(std::numeric_limits<i16>::min()) == -1.0f);
+	CHECK(packUnorm4x8({ 1, 0, 0.5f, 1 }) == 0xFF80'00FFu);
+	CHECK(near(unpackSnorm4x8(packSnorm4x8({ -1, 0.5f, 0, 1 })), { -1, 0.5f, 0, 1 }, 0.5f / 127));
+
+	f32 normal_error = 0;
+	f32 component_error = 0;
+	f32 rotation_error = 0;
+	std::normal_distribution<f32> gaussian;
+	for (i32 n = 0; n < 100000; ++n) {
+		const Vec3f normal = Vec3f{ gaussian(rng), gaussian(rng), gaussian(rng) }.normalized();
+		const Vec3f decoded = unpackNormal(packNormal(normal));
+		normal_error = std::max(normal_error, std::atan2(decoded.cross(normal).length(), decoded.dot(normal)));
+
+		Quatf q{ gaussian(rng), gaussian(rng), gaussian(rng), gaussian(rng) };
+		q = q.normalized();
+		const Quatf r = unpackQuaternion(packQuaternion(q));
+		const f32 sign = q.r * r.r + q.i * r.i + q.j * r.j + q.k * r.k < 0 ? -1.0f : 1.0f;
+		for (u32 c = 0; c < 4; ++c) component_error = std::max(component_error, std::abs(q[c] - r[c] * sign));
+		// Angle of the rotation between them, from the vector part of q' * q^-1
+		const Quatf delta = r * q.conjugate();
+		const f32 angle = 2 * std::atan2(Vec3f{ delta.i, delta.j, delta.k }.length(), std::abs(delta.r));
+		rotation_error = std::max(rotation_error, angle * 180 / std::numbers::pi_v<f32>);
+	}
+	CHECK(normal_error <= 1e-4f);
+	CHECK(component_error <= 2.1e-3f);
+	CHECK(rotation_error <= 0.28f);
+	CHECK(unpackNormal(packNormal({ 0, 0, -1 })).z == -1);
+
+	// Affine rows and packed transforms against the full matrices
+	std::uniform_real_distribution<f32> position{ -100.0f, 100.0f };
+	std::uniform_real_distribution<f32> scale{ 0.1f, 4.0f };
+	constexpr usize COUNT = 1001;
+	std::vector<Vec3f> positions(COUNT), scales(COUNT);
+	std::vector<Quatf> rotations(COUNT);
+	for (usize n = 0; n < COUNT; ++n) {
+		positions[n] = { position(rng), position(rng), position(rng) };
+		scales[n] = { scale(rng), scale(rng), scale(rng) };
+		rotations[n] = Quatf{ gaussian(rng), gaussian(rng), gaussian(rng), gaussian(rng) }.normalized();
+	}
+	std::vector<Mat4f> matrices(COUNT);
+	Transform3Df::matrices(positions, scales, rotations, matrices);
+	std::vector<Affine3x4f> affines(COUNT);
+	Affine3x4f::fromMatrices(matrices, affines);
+	std::vector<PackedTransform3D> transforms(COUNT);
+	PackedTransform3D::pack(positions, scales, rotations, transforms);
+	for (usize n = 0; n < COUNT; ++n) {
+		const Affine3x4f expected = Affine3x4f::fromMatrix(matrices[n]);
+		for (i32 r = 0; r < 3; ++r) CHECK(near(affines[n].rows[r], expected.rows[r], 0));
+		CHECK(near(affines[n].matrix(), matrices[n], 0));
+		const Vec3f p{ position(rng), position(rng), position(rng) };
+		const Vec4f full = matrices[n] * Vec4f{ p, 1 };
+		CHECK(near(affines[n] * p, Vec3f{ full.x, full.y, full.z }, 1e-4f));
+
+		const PackedTransform3D single = PackedTransform3D::pack({ positions[n], scales[n], rotations[n] });
+		CHECK(single.rotation == transforms[n].rotation);
+		CHECK(std::equal(single.scale, single.scale + 3, transforms[n].scale));
+		const Transform3Df unpacked = transforms[n].unpack();
+		CHECK(near(unpacked.position, positions[n], 0));
+		CHECK(near(unpacked.scale, scales[n], std::exp2(-11.0f)));
+		// Column error is bounded by the scale times the rotation error plus the scale quantization
+		CHECK(near(unpacked.matrix(), matrices[n], 2e-2f));
+	}
+}
+
+}
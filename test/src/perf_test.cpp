@@ -0,0 +1,71 @@
+#include "test.h"
+
+namespace Test {
+
+namespace {
+
+f32 perfWork(const i32 count) {
+	MIRROR_PERF_ZONE("perfWork");
+	f32 sum = 0;
+	for (i32 n = 0; n < count; ++n) sum += std::sqrt((f32)n);
+	return sum;
+}
+
+const PerfMonitor::ZoneCounters* findZone(const PerfMonitor::Frame& frame, const std::string_view name) {
+	for (const PerfMonitor::ZoneCounters& zone : frame.zones) {
+		if (zone.zone->name == name) return &zone;
+	}
+	return nullptr;
+}
+
+}
+
+void perfTests() {
+	// Whatever is missing reads as zero instead of failing
+	const PerfCounters counters;
+	const PerfCounters::Values begin = counters.read();
+	volatile f32 sink = perfWork(100000);
+	const PerfCounters::Values values = counters.read() - begin;
+	for (u32 n = 0; n < PerfCounters::COUNTER_COUNT; ++n) {
+		if (!counters.available((PerfCounters::Counter)n)) CHECK(values.counts[n] == 0);
+	}
+	if (counters.available(PerfCounters::INSTRUCTIONS)) CHECK(values[PerfCounters::INSTRUCTIONS] > 100000);
+	if (counters.available(PerfCounters::TASK_CLOCK_NS)) CHECK(values[PerfCounters::TASK_CLOCK_NS] > 0);
+
+	// Zones only count while enabled
+	PerfMonitor& monitor = PerfMonitor::instance();
+	monitor.frame();
+	sink = sink + perfWork(1000);
+	CHECK(monitor.frame().zones.empty());
+
+#if !defined(MIRROR_NO_PERF_COUNTERS)
+	monitor.setEnabled(true);
+	monitor.frame();
+	{
+		MIRROR_PERF_ZONE("perfOuter");
+		for (i32 n = 0; n < 10; ++n) sink = sink + perfWork(10000);
+	}
+	{
+		std::jthread worker{ [&sink]() { sink = sink + perfWork(10000); } };
+	}
+	for (i32 n = 0; n < 100; ++n) sink = sink + perfWork(0);
+	const PerfMonitor::Frame& frame = monitor.frame();
+	monitor.setEnabled(false);
+
+	CHECK(frame.available == counters.valid());
+	if (frame.available) {
+		const PerfMonitor::ZoneCounters* outer = findZone(frame, "perfOuter");
+		const PerfMonitor::ZoneCounters* work = findZone(frame, "perfWork");
+		CHECK(outer && outer->count == 1);
+		CHECK(work && work->count == 111);
+		if (outer && work && counters.available(PerfCounters::INSTRUCTIONS)) {
+			CHECK(outer->values[PerfCounters::INSTRUCTIONS] > 10 * 10000);
+			CHECK(frame.values[PerfCounters::INSTRUCTIONS] >= outer->values[PerfCounters::INSTRUCTIONS]);
+		}
+	} else {
+		CHECK(frame.zones.empty());
+	}
+#endif
+}
+
+}
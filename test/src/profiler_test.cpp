@@ -0,0 +1,87 @@
+#include "test.h"
+
+#include <fstream>
+#include <sstream>
+
+namespace Test {
+
+namespace {
+
+void leafWork(f32& sink) {
+	MIRROR_PROFILE_FUNCTION();
+	for (i32 n = 0; n < 100; ++n) sink += std::sqrt((f32)n);
+}
+
+const Profiler::ZoneStats* findZone(const Profiler::Frame& frame, const std::string_view name) {
+	for (const Profiler::ZoneStats& stats : frame.zones) {
+		if (stats.zone->name == name) return &stats;
+	}
+	return nullptr;
+}
+
+}
+
+void profilerTests() {
+#if !defined(MIRROR_NO_PROFILER)
+	Profiler& profiler = Profiler::instance();
+	MIRROR_PROFILE_THREAD("Main");
+	profiler.frame();
+
+	f32 sink = 0;
+	profiler.startCapture();
+	{
+		MIRROR_PROFILE_ZONE("outer");
+		for (i32 n = 0; n < 10; ++n) leafWork(sink);
+	}
+	{
+		std::jthread worker{ [&sink]() {
+			MIRROR_PROFILE_THREAD("Worker \"1\" \\ 2");
+			MIRROR_PROFILE_ZONE("worker");
+			f32 local = 0;
+			leafWork(local);
+			sink += local;
+		} };
+	}
+	const Profiler::Frame& frame = profiler.frame();
+	profiler.stopCapture();
+
+	const Profiler::ZoneStats* outer = findZone(frame, "outer");
+	const Profiler::ZoneStats* leaf = findZone(frame, "leafWork");
+	const Profiler::ZoneStats* worker = findZone(frame, "worker");
+	CHECK(outer && outer->count == 1 && outer->max_depth == 0);
+	CHECK(leaf && leaf->count == 11 && leaf->max_depth == 1);
+	CHECK(worker && worker->count == 1);
+	CHECK(outer && leaf && outer->total_ms >= leaf->total_ms - leaf->max_ms);
+	CHECK(frame.dropped == 0 && frame.duration_ms > 0);
+	CHECK(profiler.captured().size() == 13);
+
+	// Nothing recorded, nothing reported
+	CHECK(profiler.frame().zones.empty());
+
+	const std::string path = "profiler_trace.json";
+	CHECK(profiler.writeChromeTrace(path));
+	std::stringstream trace;
+	trace << std::ifstream{ path }.rdbuf();
+	CHECK(trace.str().starts_with("{\"displayTimeUnit\""));
+	CHECK(trace.str().find("\"name\":\"leafWork\",\"cat\":\"zone\",\"ph\":\"X\"") != std::string::npos);
+	CHECK(trace.str().find("\"args\":{\"name\":\"Worker \\\"1\\\" \\\\ 2\"}") != std::string::npos);
+	std::remove(path.c_str());
+
+	// A full buffer drops and counts instead of blocking
+	for (usize n = 0; n < Profiler::BUFFER_CAPACITY + 100; ++n) {
+		MIRROR_PROFILE_ZONE("flood");
+	}
+	CHECK(profiler.frame().dropped == 100);
+
+	// An exited thread's buffer goes to the next new thread, and its last events are still collected
+	const usize buffers = profiler.bufferCount();
+	for (i32 n = 0; n < 3; ++n) {
+		std::jthread{ []() { MIRROR_PROFILE_ZONE("short-lived"); } }.join();
+	}
+	const Profiler::ZoneStats* short_lived = findZone(profiler.frame(), "short-lived");
+	CHECK(profiler.bufferCount() == buffers && short_lived && short_lived->count == 3);
+	CHECK(sink > 0);
+#endif
+}
+
+}
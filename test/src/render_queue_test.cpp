@@ -0,0 +1,94 @@
+#include "test.h"
+
+#include "reflect/render_queue.h"
+
+#include <random>
+
+namespace Test {
+
+using namespace Mirror::Reflect;
+
+void renderQueueTests() {
+	// Key fields round trip and sort by layer, then pipeline, then material, then depth
+	{
+		const DrawKey key = DrawKey::make(3, 4000, 1 << 19, 2.5f);
+		CHECK(key.layer() == 3 && key.pipeline() == 4000 && key.material() == 1 << 19);
+		CHECK(key.state() == DrawKey::make(3, 4000, 1 << 19, 100.0f).state());
+		CHECK(DrawKey::make(0, 4095, 1048575, 1e30f) < DrawKey::make(1, 0, 0, 0));
+		CHECK(DrawKey::make(1, 0, 1048575, 1e30f) < DrawKey::make(1, 1, 0, 0));
+		CHECK(DrawKey::make(1, 1, 7, 1e30f) < DrawKey::make(1, 1, 8, 0));
+	}
+
+	// Depth order at any scale, reversed for blended draws; negative depth clamps to the nearest
+	{
+		constexpr DrawKey::Order BACK = DrawKey::Order::BACK_TO_FRONT;
+		CHECK(DrawKey::make(0, 0, 0, 0.001f) < DrawKey::make(0, 0, 0, 0.0011f));
+		CHECK(DrawKey::make(0, 0, 0, 1000.0f) < DrawKey::make(0, 0, 0, 1001.0f));
+		CHECK(DrawKey::make(0, 0, 0, 1000.0f, BACK) > DrawKey::make(0, 0, 0, 1001.0f, BACK));
+		CHECK(DrawKey::make(0, 0, 0, -5.0f) == DrawKey::make(0, 0, 0, 0.0f));
+		CHECK(DrawKey::make(2, 1, 1, 0.0f, BACK).state() == DrawKey::make(2, 1, 1, 0.0f).state());
+	}
+
+	// Radix sort against std::stable_sort on random keys, equal keys keeping submission order
+	{
+		std::mt19937_64 rng{ 7 };
+		RenderQueue queue{ sizeof(u32) };
+		std::vector<std::pair<u64, u32>> expected;
+		for (u32 n = 0; n < 5000; ++n) {
+			// Few distinct high fields, as in real frames, and some exact duplicates
+			const u64 key = n % 7 == 0 ? 42 : (rng() & 0x0300'0fff'ffff'ffffull);
+			queue.submit(DrawKey{ key }, n);
+			expected.emplace_back(key, n);
+		}
+		std::ranges::stable_sort(expected, {}, &std::pair<u64, u32>::first);
+		queue.sort();
+		bool sorted = true;
+		for (usize n = 0; n < expected.size(); ++n) sorted &= queue.key(n).value == expected[n].first;
+		CHECK(sorted);
+
+		std::vector<u32> instances(queue.size());
+		queue.batch(reinterpret_cast<std::byte*>(instances.data()));
+		bool stable = true;
+		for (usize n = 0; n < expected.size(); ++n) stable &= instances[n] == expected[n].second;
+		CHECK(stable);
+	}
+
+	// Runs of equal state become one batch each whatever the depths, and instance data follows the sorted order
+	{
+		RenderQueue queue{ sizeof(SpriteInstance), 4 };
+		constexpr u32 MATERIALS = 8;
+		constexpr u32 SPRITES = 3000; // past the initial capacity, so the queue grows
+		for (u32 n = 0; n < SPRITES; ++n) {
+			const u32 material = n % MATERIALS;
+			SpriteInstance sprite{};
+			sprite.position[0] = (f32)n;
+			sprite.position[1] = (f32)material;
+			queue.submit(DrawKey::make(n % 2, 0, material, (f32)(SPRITES - n)), sprite);
+		}
+		queue.sort();
+		std::vector<SpriteInstance> instances(queue.size());
+		const std::span<const RenderQueue::Batch> batches = queue.batch(reinterpret_cast<std::byte*>(instances.data()));
+		// Even sprites have even materials on layer 0, odd ones odd materials on layer 1
+		CHECK(batches.size() == MATERIALS);
+		u32 total = 0;
+		bool consistent = true;
+		for (const RenderQueue::Batch& batch : batches) {
+			consistent &= batch.first_instance == total;
+			total += batch.instance_count;
+			for (u32 n = batch.first_instance; n < batch.first_instance + batch.instance_count; ++n) {
+				consistent &= instances[n].position[1] == (f32)batch.key.material();
+				// Front to back: later sprites were submitted nearer
+				if (n > batch.first_instance) consistent &= instances[n].position[0] < instances[n - 1].position[0];
+			}
+		}
+		CHECK(total == SPRITES && consistent);
+		CHECK(batches[0].key.layer() == 0 && batches.back().key.layer() == 1);
+
+		queue.clear();
+		CHECK(queue.empty() && queue.batches().size() == MATERIALS);
+		queue.sort();
+		CHECK(queue.batch(nullptr).empty());
+	}
+}
+
+}
@@ -0,0 +1,95 @@
+#include "test.h"
+
+#include <random>
+
+namespace Test {
+
+namespace {
+
+// Reference forms the closed-form paths replaced, kept here to measure them against
+Vec3f sandwich(const Quatf& q, const Vec3f& v) {
+	const Quatf result = q * Quatf{ 0, v.x, v.y, v.z } * q.conjugate();
+	return { result.i, result.j, result.k };
+}
+
+Vec2f complexProduct(const Complexf& c, const Vec2f& v) {
+	const Complexf result = c * Complexf{ v.x, v.y };
+	return { result.r, result.i };
+}
+
+}
+
+void rotationTests() {
+	std::mt19937 rng{ 9012 };
+	std::uniform_real_distribution<f32> dist{ -10.0f, 10.0f };
+	std::uniform_real_distribution<f32> angle{ -6.3f, 6.3f };
+
+	f32 vector_ulps = 0;
+	f32 matrix_ulps = 0;
+	f32 transform_ulps = 0;
+	f32 complex_ulps = 0;
+	f32 sprite_ulps = 0;
+	for (i32 n = 0; n < 10000; ++n) {
+		const Quatf q = Quatf::fromAxisAngle(Vec3f{ dist(rng), dist(rng), dist(rng) }.normalized(), angle(rng));
+		const Vec3f v{ dist(rng), dist(rng), dist(rng) };
+
+		vector_ulps = std::max(vector_ulps, ulpsApart(q * v, sandwich(q, v)));
+
+		const Mat3f m = q.matrix();
+		matrix_ulps = std::max({
+			matrix_ulps,
+			ulpsApart(m.x, sandwich(q, { 1, 0, 0 })),
+			ulpsApart(m.y, sandwich(q, { 0, 1, 0 })),
+			ulpsApart(m.z, sandwich(q, { 0, 0, 1 })),
+		});
+		vector_ulps = std::max(vector_ulps, ulpsApart(m * v, sandwich(q, v)));
+
+		const Transform3Df transform{ v, { dist(rng), dist(rng), dist(rng) }, q };
+		const Mat4f tm = transform.matrix();
+		transform_ulps = std::max({
+			transform_ulps,
+			ulpsApart({ tm.x.x, tm.x.y, tm.x.z }, sandwich(q, { transform.scale.x, 0, 0 })),
+			ulpsApart({ tm.y.x, tm.y.y, tm.y.z }, sandwich(q, { 0, transform.scale.y, 0 })),
+			ulpsApart({ tm.z.x, tm.z.y, tm.z.z }, sandwich(q, { 0, 0, transform.scale.z })),
+		});
+		CHECK(tm.w.x == v.x && tm.w.y == v.y && tm.w.z == v.z && tm.w.w == 1);
+
+		const f32 radians = angle(rng);
+		const Complexf c = Complexf::fromAngle(radians);
+		const Vec2f u{ dist(rng), dist(rng) };
+		const Mat2f cm = c.matrix();
+		complex_ulps = std::max({
+			complex_ulps,
+			ulpsApart(c * u, complexProduct(c, u)),
+			ulpsApart(cm * u, complexProduct(c, u)),
+			ulpsApart(cm.x, { std::cos(radians), std::sin(radians) }),
+			ulpsApart(cm.y, { -std::sin(radians), std::cos(radians) }),
+		});
+
+		const Transform2Df sprite{ v, { u.x, u.y }, c };
+		const Mat4f sm = sprite.matrix();
+		sprite_ulps = std::max({
+			sprite_ulps,
+			ulpsApart({ sm.x.x, sm.x.y }, Vec2f{ std::cos(radians), std::sin(radians) } * u.x),
+			ulpsApart({ sm.y.x, sm.y.y }, Vec2f{ -std::sin(radians), std::cos(radians) } * u.y),
+		});
+		CHECK(sm.z.z == 1 && sm.w.x == v.x && sm.w.y == v.y && sm.w.z == v.z && sm.w.w == 1);
+	}
+
+	CHECK(vector_ulps <= 8);
+	CHECK(matrix_ulps <= 8);
+	CHECK(transform_ulps <= 8);
+	CHECK(complex_ulps <= 2);
+	CHECK(sprite_ulps <= 2);
+
+	// Rotation needs unit quaternions; scaled ones would stretch, so they are caught in debug builds instead
+	CHECK(Quatf::fromAxisAngle({ 0, 0, 1 }, 1.0f).unit() && !(Quatf{ 2, 0, 0, 0 }).unit());
+
+	constexpr Quatf QUARTER_TURN{ 0.70710678f, 0, 0, 0.70710678f };
+	constexpr Vec3f ROTATED = QUARTER_TURN * Vec3f{ 1, 0, 0 };
+	CHECK(near(ROTATED.x, 0, 1e-6f) && near(ROTATED.y, 1, 1e-6f) && near(ROTATED.z, 0, 1e-6f));
+	constexpr Mat2f HALF_TURN = Complexf{ -1, 0 }.matrix();
+	CHECK(HALF_TURN.x == Vec2f(-1, 0) && HALF_TURN.y == Vec2f(0, -1));
+}
+
+}
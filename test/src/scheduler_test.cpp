@@ -0,0 +1,77 @@
+#include "test.h"
+
+#include <chrono>
+
+namespace Test {
+
+namespace {
+
+struct SimulatedClock {
+	static inline std::chrono::steady_clock::time_point time{};
+	static inline u64 reads = 0;
+	static inline u64 sleeps = 0;
+
+	static std::chrono::steady_clock::time_point now() noexcept {
+		++reads;
+		time += std::chrono::microseconds(1);
+		return time;
+	}
+	static void sleep() noexcept {
+		++sleeps;
+		time += std::chrono::microseconds(1300);
+	}
+};
+
+}
+
+void schedulerTests() {
+	// Accumulator: steps follow simulated time regardless of frame rate
+	FrameScheduler scheduler{ .step_sec = 0.01 };
+	u32 steps = 0;
+	for (i32 frame = 0; frame < 1000; ++frame) steps += scheduler.advance(frame % 3 == 0 ? 0.0233 : 0.0042);
+	const f64 simulated = 334 * 0.0233 + 666 * 0.0042;
+	CHECK(std::abs(steps * 0.01 + scheduler.accumulator_sec - simulated) < 1e-9);
+	CHECK(scheduler.alpha() >= 0 && scheduler.alpha() < 1);
+
+	FrameScheduler fixed{ .step_sec = 0.01 };
+	CHECK(fixed.advance(0.004) == 0 && near((f32)fixed.alpha(), 0.4f));
+	CHECK(fixed.advance(0.0075) == 1 && near((f32)fixed.alpha(), 0.15f, 1e-4f));
+
+	// Spiral of death: a 2 second hitch runs at most max_steps and drops the rest
+	FrameScheduler clamped{ .step_sec = 0.01, .max_steps = 5 };
+	CHECK(clamped.advance(2.0) == 5);
+	CHECK(clamped.accumulator_sec < 0.01 && near((f32)clamped.dropped_sec, 1.95f, 1e-4f));
+	CHECK(clamped.advance(0.0105) == 1);
+
+	// Limiter on a simulated clock where every 1 ms sleep overshoots by 0.3 ms and every clock read takes 1 us:
+	// frames end within a read of the deadline, sleeping for most of it
+	{
+		FrameScheduler limited{ .target_frame_sec = 0.004 };
+		limited.limiter.clock_now = &SimulatedClock::now;
+		limited.limiter.sleep_1ms = &SimulatedClock::sleep;
+		limited.deadline = SimulatedClock::now();
+		bool on_time = true;
+		u64 spin_reads = 0;
+		for (i32 frame = 0; frame < 50; ++frame) {
+			const auto deadline = limited.deadline + std::chrono::microseconds(4000);
+			const u64 reads = SimulatedClock::reads;
+			const u64 sleeps = SimulatedClock::sleeps;
+			limited.endFrame();
+			const auto end = SimulatedClock::time;
+			on_time &= end >= deadline && end - deadline <= std::chrono::microseconds(1);
+			// Each sleep costs three reads: the remaining time and both ends of the sleep
+			if (frame > 0) spin_reads = std::max(spin_reads, SimulatedClock::reads - reads - 3 * (SimulatedClock::sleeps - sleeps));
+		}
+		CHECK(on_time);
+		// The estimate settles just above the 1.3 ms sleeps, and after the first frame the spin never comes near the
+		// whole 4000 us
+		CHECK(limited.limiter.estimate_sec > 0.0013 && limited.limiter.estimate_sec < 0.0015 && spin_reads < 1500);
+
+		// A late frame resets the deadline instead of rushing the next ones
+		SimulatedClock::time += std::chrono::milliseconds(10);
+		limited.endFrame();
+		CHECK(limited.deadline == SimulatedClock::time);
+	}
+}
+
+}
@@ -0,0 +1,77 @@
+#include "test.h"
+
+#include <chrono>
+#include <random>
+
+namespace Test {
+
+void statsTests() {
+	using namespace std::chrono_literals;
+
+	// Buckets cover every value with 1/64 relative precision
+	u64 previous_low = 0;
+	for (usize n = 1; n < DurationHistogram::BUCKET_COUNT; ++n) {
+		const u64 low = DurationHistogram::bucketLow(n);
+		CHECK(low == previous_low + DurationHistogram::bucketWidth(n - 1));
+		CHECK(DurationHistogram::bucket(low) == n && DurationHistogram::bucket(low - 1) == n - 1);
+		CHECK(DurationHistogram::bucketWidth(n) * 64 <= std::max<u64>(low, 64));
+		previous_low = low;
+	}
+	CHECK(DurationHistogram::bucket(~u64{ 0 }) == DurationHistogram::BUCKET_COUNT - 1);
+
+	// Percentiles of a known distribution
+	DurationHistogram histogram;
+	for (u64 us = 1; us <= 1000; ++us) histogram.add(us * 1000);
+	std::array<u64, 4> values;
+	histogram.percentiles(std::array{ 0.0, 0.5, 0.99, 1.0 }, values);
+	CHECK(near((f32)values[0], 1000, 0.016f) && near((f32)values[1], 500'000, 0.016f));
+	CHECK(near((f32)values[2], 990'000, 0.016f) && near((f32)values[3], 1'000'000, 0.016f));
+	histogram.remove(1'000'000);
+	CHECK(histogram.count() == 999);
+
+	// Rolling window forgets old frames, the total doesn't
+	FrameStats stats{ { .window_frames = 100, .hitch_ms = 20 } };
+	for (i32 n = 0; n < 100; ++n) stats.record(10ms);
+	stats.record(50ms);
+	for (i32 n = 0; n < 99; ++n) stats.record(4ms);
+	FrameStats::Snapshot snapshot = stats.snapshot();
+	CHECK(snapshot.frames == 200 && snapshot.window.count == 100 && snapshot.total.count == 200);
+	CHECK(near((f32)snapshot.window.p50_ms, 4, 0.016f) && near((f32)snapshot.window.p99_ms, 4, 0.016f));
+	CHECK(snapshot.window.max_ms == 50 && snapshot.total.max_ms == 50);
+	CHECK(near((f32)snapshot.window.mean_ms, (99 * 4 + 50) / 100.0f));
+	CHECK(near((f32)snapshot.total.p50_ms, 10, 0.016f) && near((f32)snapshot.total.p99_ms, 10, 0.016f));
+	CHECK(snapshot.window.hitches == 1 && snapshot.total.hitches == 1);
+	stats.record(4ms);
+	snapshot = stats.snapshot();
+	CHECK(snapshot.window.hitches == 0 && snapshot.window.max_ms == 4 && snapshot.total.hitches == 1);
+
+	// Zones come from profiler frames, keyed by zone id
+	Profiler::Zone zone{ "test zone", __FILE__, __LINE__, 3 };
+	Profiler::Frame frame;
+	frame.zones.push_back({ &zone, 2, 0, 1.5, 1.0 });
+	for (i32 n = 0; n < 10; ++n) stats.recordZones(frame);
+	snapshot = stats.snapshot();
+	CHECK(snapshot.zone_count == 1 && std::string_view{ snapshot.zones[0].name } == "test zone");
+	CHECK(snapshot.zones[0].window.count == 10 && snapshot.zones[0].total.max_ms == 1.5);
+
+	stats.reset();
+	snapshot = stats.snapshot();
+	CHECK(snapshot.frames == 0 && snapshot.window.count == 0 && snapshot.window.max_ms == 0 && snapshot.zone_count == 0);
+
+	// Clock feeds frame times
+	Clock clock;
+	clock.stats = &stats;
+	clock.update();
+	clock.update();
+	CHECK(stats.snapshot().frames == 2);
+
+	// The window keeps the latest 100 frames however many were recorded
+	std::mt19937 rng{ 7 };
+	constexpr i32 RECORDS = 1 << 16;
+	for (i32 n = 0; n < RECORDS; ++n) stats.record(std::chrono::nanoseconds{ std::uniform_int_distribution<i64>{ 1'000'000, 40'000'000 }(rng) });
+	snapshot = stats.snapshot();
+	CHECK(snapshot.window.count == 100 && snapshot.total.count == RECORDS + 2);
+	CHECK(snapshot.window.p50_ms >= 1 && snapshot.window.p99_ms <= 40 * (1 + 1.0 / 64));
+}
+
+}
@@ -0,0 +1,113 @@
+#include "test.h"
+
+#include <chrono>
+
+namespace Test {
+
+namespace {
+
+struct Input {};
+struct Physics {};
+struct Audio {};
+struct Render {};
+
+}
+
+void systemsTests() {
+	using namespace std::chrono_literals;
+	JobSystem jobs{ 3 };
+
+	// Conflicting systems keep registration order, the rest only wait for what they touch
+	{
+		SystemScheduler systems;
+		std::atomic<u32> clock{ 0 };
+		std::array<u32, 6> begin{};
+		std::array<u32, 6> end{};
+		auto timed = [&](const u32 id) {
+			return [&, id]() {
+				begin[id] = clock.fetch_add(1);
+				std::this_thread::sleep_for(1ms);
+				end[id] = clock.fetch_add(1);
+			};
+		};
+		const u32 input = systems.add("input", timed(0)).writes<Input>().id();
+		const u32 physics = systems.add("physics", timed(1)).reads<Input>().writes<Physics>().id();
+		const u32 ai = systems.add("ai", timed(2)).reads<Input, Physics>().id();
+		const u32 audio = systems.add("audio", timed(3)).writes<Audio>().id();
+		const u32 render = systems.add("render", timed(4)).reads<Physics, Audio>().writes<Render>().onMainThread().id();
+		const u32 late = systems.add("late physics", timed(5)).writes<Physics>().id();
+
+		systems.run(jobs);
+		CHECK(systems.dependencies(input).empty() && systems.dependencies(audio).empty());
+		CHECK(std::ranges::equal(systems.dependencies(physics), std::array{ input }));
+		CHECK(std::ranges::equal(systems.dependencies(ai), std::array{ input, physics }));
+		CHECK(std::ranges::equal(systems.dependencies(render), std::array{ physics, audio }));
+		CHECK(std::ranges::equal(systems.dependencies(late), std::array{ ai, render }));
+
+		for (i32 frame = 0; frame < 20; ++frame) {
+			clock = 0;
+			systems.run(jobs);
+			for (u32 id = 0; id < systems.size(); ++id) {
+				for (const u32 dependency : systems.dependencies(id)) CHECK(end[dependency] < begin[id]);
+			}
+		}
+	}
+
+	// Main-thread systems stay on the caller, others may not
+	{
+		SystemScheduler systems;
+		const std::thread::id caller = std::this_thread::get_id();
+		bool on_caller = true;
+		systems.add("a", []() {}).writes<Input>();
+		systems.add("main", [&]() { on_caller = std::this_thread::get_id() == caller; }).reads<Input>().onMainThread();
+		systems.add("b", []() {}).reads<Input>();
+		for (i32 frame = 0; frame < 10; ++frame) systems.run(jobs);
+		CHECK(on_caller);
+	}
+
+	// Dependents start after what they depend on, and the critical path follows the longest chain
+	{
+		SystemScheduler systems;
+		auto sleep = [](const std::chrono::milliseconds duration) { return [duration]() { std::this_thread::sleep_for(duration); }; };
+		std::atomic<bool> first_done{ false };
+		bool in_order = false;
+		const u32 first = systems.add("chain 1", [&]() { sleep(10ms)(); first_done = true; }).writes<Physics>().id();
+		const u32 second = systems.add("chain 2", [&]() { in_order = first_done; sleep(10ms)(); }).reads<Physics>().id();
+		systems.add("side 1", sleep(5ms)).writes<Audio>();
+		systems.add("side 2", sleep(5ms)).writes<Input>();
+		systems.add("side 3", sleep(5ms)).writes<Render>();
+		systems.run(jobs);
+
+		const SystemScheduler::Report& report = systems.lastReport();
+		CHECK(in_order && std::ranges::equal(report.critical_path, std::array{ first, second }));
+		CHECK(report.critical_path_ms >= 20 && report.work_ms >= 35);
+	}
+
+#if !defined(MIRROR_NO_PROFILER)
+	// Profiler zones are owned by the profiler, so they outlive the scheduler whose systems named them
+	{
+		{
+			SystemScheduler systems;
+			systems.add("short-lived system", []() {});
+			systems.run(jobs);
+		}
+		const Profiler::Frame& frame = Profiler::instance().frame();
+		CHECK(std::ranges::any_of(frame.zones, [](const Profiler::ZoneStats& stats) { return std::string_view{ stats.zone->name } == "short-lived system"; }));
+	}
+#endif
+
+	// Systems added later join the cached graph
+	{
+		SystemScheduler systems;
+		i32 order = 0;
+		i32 first = -1;
+		i32 second = -1;
+		systems.add("first", [&]() { first = order++; }).writes<Render>();
+		systems.run(jobs);
+		systems.add("second", [&]() { second = order++; }).reads<Render>();
+		systems.run(jobs);
+		CHECK(first == 1 && second == 2 && systems.lastReport().frame == 2);
+	}
+}
+
+}
@@ -1,7 +1,31 @@
-#include <print>
-
-#include "mirror.h"
+#include "test.h"
 
 int main() {
+	Test::matrixTests();
+	Test::transformTests();
+	Test::rotationTests();
+	Test::cameraTests();
+	Test::frustumTests();
+	Test::bvhTests();
+	Test::packingTests();
+	Test::hierarchyTests();
+	Test::profilerTests();
+	Test::schedulerTests();
+	Test::statsTests();
+	Test::perfTests();
+	Test::jobsTests();
+	Test::systemsTests();
+	Test::ecsTests();
+	Test::memoryTests();
+	Test::tripleBufferTests();
+	Test::renderQueueTests();
+	Test::vkTests();
+	Test::vkMemoryTests();
+	Test::mirrorTests();
 
+	if (Test::failures > 0) {
+		std::println("{} checks failed", Test::failures);
+		return 1;
+	}
+	std::println("All checks passed");
 }
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <print>
+#include <limits>
+
+#include "frame/frame.h"
+
+namespace Test {
+
+using namespace Mirror;
+
+inline i32 failures = 0;
+
+inline void check(const bool condition, const char* expression, const char* file, const i32 line) {
+	if (condition) return;
+	++failures;
+	std::println("{}:{}: check failed: {}", file, line, expression);
+}
+
+[[nodiscard]] inline bool near(const f32 a, const f32 b, const f32 tolerance = 1e-5f) {
+	return std::abs(a - b) <= tolerance * std::max({ 1.0f, std::abs(a), std::abs(b) });
+}
+// Error measured in ulps of magnitude, so components near zero are judged against the scale of the whole value
+[[nodiscard]] inline f32 ulpsApart(const f32 a, const f32 b, const f32 magnitude) {
+	const f32 m = std::max(std::abs(magnitude), std::numeric_limits<f32>::min());
+	return std::abs(a - b) / (std::nextafter(m, std::numeric_limits<f32>::infinity()) - m);
+}
+[[nodiscard]] inline f32 ulpsApart(const Vec2f& a, const Vec2f& b) {
+	const f32 m = std::max(a.length(), b.length());
+	return std::max(ulpsApart(a.x, b.x, m), ulpsApart(a.y, b.y, m));
+}
+[[nodiscard]] inline f32 ulpsApart(const Vec3f& a, const Vec3f& b) {
+	const f32 m = std::max(a.length(), b.length());
+	return std::max({ ulpsApart(a.x, b.x, m), ulpsApart(a.y, b.y, m), ulpsApart(a.z, b.z, m) });
+}
+
+[[nodiscard]] inline bool near(const Vec4f& a, const Vec4f& b, const f32 tolerance = 1e-5f) {
+	return near(a.x, b.x, tolerance) && near(a.y, b.y, tolerance) && near(a.z, b.z, tolerance) && near(a.w, b.w, tolerance);
+}
+[[nodiscard]] inline bool near(const Mat4f& a, const Mat4f& b, const f32 tolerance = 1e-5f) {
+	return near(a.x, b.x, tolerance) && near(a.y, b.y, tolerance) && near(a.z, b.z, tolerance) && near(a.w, b.w, tolerance);
+}
+
+void matrixTests();
+void transformTests();
+void rotationTests();
+void cameraTests();
+void frustumTests();
+void bvhTests();
+void packingTests();
+void hierarchyTests();
+void profilerTests();
+void schedulerTests();
+void statsTests();
+void perfTests();
+void jobsTests();
+void systemsTests();
+void ecsTests();
+void memoryTests();
+void tripleBufferTests();
+void renderQueueTests();
+void vkTests();
+void vkMemoryTests();
+void mirrorTests();
+
+}
+
+#define CHECK(condition) ::Test::check((condition), #condition, __FILE__, __LINE__)
@@ -0,0 +1,80 @@
+#include "test.h"
+
+#include <random>
+
+namespace Test {
+
+void transformTests() {
+	std::mt19937 rng{ 5678 };
+	std::uniform_real_distribution<f32> dist{ -10.0f, 10.0f };
+
+	for (const usize count : { 0, 1, 7, 8, 9, 31, 1000, 20000 }) {
+		std::vector<Vec3f> positions(count);
+		std::vector<Vec3f> scales(count);
+		std::vector<Quatf> rotations(count);
+		for (usize n = 0; n < count; ++n) {
+			positions[n] = { dist(rng), dist(rng), dist(rng) };
+			scales[n] = { dist(rng), dist(rng), dist(rng) };
+			rotations[n] = Quatf::fromAxisAngle(Vec3f{ dist(rng), dist(rng), dist(rng) }.normalized(), dist(rng));
+		}
+
+		for (const usize threads : { 1, 4 }) {
+			std::vector<Mat4f> out(count);
+			Transform3Df::matrices(positions, scales, rotations, out, threads);
+
+			bool matches = true;
+			for (usize n = 0; n < count; ++n) {
+				const Transform3Df transform{ positions[n], scales[n], rotations[n] };
+				matches = matches && near(out[n], transform.matrix(), 1e-4f);
+			}
+			CHECK(matches);
+		}
+	}
+
+	for (const usize count : { 0, 1, 7, 8, 9, 1000, 20000 }) {
+		std::vector<Vec3f> positions(count);
+		std::vector<Vec2f> scales(count);
+		std::vector<Complexf> rotations(count);
+		std::vector<u32> colors(count);
+		for (usize n = 0; n < count; ++n) {
+			positions[n] = { dist(rng), dist(rng), dist(rng) };
+			scales[n] = { dist(rng), dist(rng) };
+			rotations[n] = Complexf::fromAngle(dist(rng));
+			colors[n] = (u32)rng();
+		}
+
+		for (const bool with_colors : { false, true }) {
+			std::vector<SpriteInstance> out(count);
+			Transform2Df::instances(positions, scales, rotations, with_colors ? std::span<const u32>{ colors } : std::span<const u32>{}, out, 4);
+
+			bool matches = true;
+			for (usize n = 0; n < count; ++n) {
+				const Mat4f m = Transform2Df{ positions[n], scales[n], rotations[n] }.matrix();
+				const SpriteInstance& s = out[n];
+				matches = matches && near(Vec4f{ s.basis_x[0], s.basis_x[1], s.basis_y[0], s.basis_y[1] }, { m.x.x, m.x.y, m.y.x, m.y.y }, 1e-6f);
+				matches = matches && s.position[0] == m.w.x && s.position[1] == m.w.y && s.position[2] == m.w.z;
+				matches = matches && s.color == (with_colors ? colors[n] : 0xFFFFFFFFu);
+			}
+			CHECK(matches);
+		}
+	}
+
+	// Affine composition and inverse agree with the 4x4 path
+	const Transform2Df parent{ { 3, -2, 0.5f }, { 2, 0.5f }, Complexf::fromAngle(0.7f) };
+	const Transform2Df child{ { -1, 4, 0 }, { 1.5f, 3 }, Complexf::fromAngle(-2.1f) };
+	const Affine2Df composed = parent.affine() * child.affine();
+	const Mat4f expected = parent.matrix() * child.matrix();
+	CHECK(near(composed.x, Vec2f{ expected.x.x, expected.x.y }, 1e-5f) && near(composed.y, Vec2f{ expected.y.x, expected.y.y }, 1e-5f));
+	CHECK(near(composed.w, Vec2f{ expected.w.x, expected.w.y }, 1e-5f));
+	const Affine2Df identity = composed * composed.inverted();
+	CHECK(near(identity.x, Vec2f{ 1, 0 }, 1e-5f) && near(identity.y, Vec2f{ 0, 1 }, 1e-5f) && near(identity.w, Vec2f{ 0, 0 }, 1e-5f));
+
+	// Rotating by a rotor repeatedly keeps it unit length
+	Transform2Df spinning;
+	const Complexf step = Complexf::fromAngle(0.01f);
+	for (i32 n = 0; n < 10000; ++n) spinning.rotate(step);
+	CHECK(near(spinning.rotation.abs(), 1, 1e-6f));
+	CHECK(near(std::remainder(spinning.angle() - 100.0f, 2 * 3.14159265f), 0, 1e-3f));
+}
+
+}
@@ -0,0 +1,67 @@
+#include "test.h"
+
+namespace Test {
+
+namespace {
+
+struct Pair {
+	u64 value = 0;
+	u64 twice = 0;
+};
+
+}
+
+void tripleBufferTests() {
+	// Nothing to acquire until a publish, then only the latest of several
+	{
+		TripleBuffer<u64> buffer;
+		CHECK(!buffer.acquire());
+		buffer.back() = 1;
+		CHECK(!buffer.publish());
+		buffer.back() = 2;
+		CHECK(buffer.publish()); // 1 was never acquired
+		CHECK(buffer.acquire() && buffer.front() == 2);
+		CHECK(!buffer.acquire() && buffer.front() == 2);
+		buffer.back() = 3;
+		CHECK(!buffer.publish());
+		CHECK(buffer.acquire() && buffer.front() == 3);
+	}
+
+	// One writer and one reader running flat out: the reader only sees whole values, in publication order, and every
+	// publication is either acquired or reported as dropped
+	{
+		constexpr u64 COUNT = 200'000;
+		TripleBuffer<Pair> buffer;
+		std::atomic<bool> done{ false };
+		u64 dropped = 0;
+		std::thread writer{ [&]() {
+			for (u64 n = 1; n <= COUNT; ++n) {
+				buffer.back() = { n, 2 * n };
+				dropped += buffer.publish();
+			}
+			done.store(true, std::memory_order_release);
+		} };
+
+		u64 acquired = 0;
+		u64 last = 0;
+		bool whole = true;
+		bool ordered = true;
+		for (;;) {
+			const bool finished = done.load(std::memory_order_acquire);
+			if (buffer.acquire()) {
+				const Pair& pair = buffer.front();
+				whole &= pair.twice == 2 * pair.value;
+				ordered &= pair.value > last;
+				last = pair.value;
+				++acquired;
+			} else if (finished) {
+				break;
+			}
+		}
+		writer.join();
+		CHECK(whole && ordered);
+		CHECK(last == COUNT && acquired + dropped == COUNT);
+	}
+}
+
+}
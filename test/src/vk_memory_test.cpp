@@ -0,0 +1,263 @@
+#include "test.h"
+
+#include "reflect/vk/vk_memory.h"
+
+#include <map>
+#include <random>
+
+namespace Test {
+
+using namespace Mirror::Reflect;
+
+namespace {
+
+constexpr VkDeviceSize MB = 1 << 20;
+
+// Discrete GPU layout: device-local VRAM, system memory in two flavours and a small device-local BAR window.
+// Memory is only backed by host storage once mapped.
+class MockBackend final : public Vk::MemoryBackend {
+public:
+	u32 allocations = 0; // live
+	u32 fail_heap = Vk::MemoryAllocator::NONE; // allocateMemory() reports out of memory for this heap
+
+	MockBackend() {
+		properties_.memoryHeapCount = 3;
+		properties_.memoryHeaps[0] = { 16 * MB, VK_MEMORY_HEAP_DEVICE_LOCAL_BIT };
+		properties_.memoryHeaps[1] = { 64 * MB, 0 };
+		properties_.memoryHeaps[2] = { 16 * MB, VK_MEMORY_HEAP_DEVICE_LOCAL_BIT };
+		properties_.memoryTypeCount = 4;
+		properties_.memoryTypes[0] = { VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0 };
+		properties_.memoryTypes[1] = { VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 1 };
+		properties_.memoryTypes[2] = { VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT, 1 };
+		properties_.memoryTypes[3] = { VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 2 };
+	}
+
+	[[nodiscard]] const VkPhysicalDeviceMemoryProperties& memoryProperties() const noexcept override { return properties_; }
+	[[nodiscard]] VkDeviceMemory allocateMemory(const u32 memory_type, const VkDeviceSize size) override {
+		if (properties_.memoryTypes[memory_type].heapIndex == fail_heap) return VK_NULL_HANDLE;
+		const VkDeviceMemory memory = reinterpret_cast<VkDeviceMemory>(next_++);
+		sizes_[memory] = size;
+		++allocations;
+		return memory;
+	}
+	void freeMemory(const VkDeviceMemory memory) noexcept override {
+		CHECK(sizes_.erase(memory) == 1);
+		storage_.erase(memory);
+		--allocations;
+	}
+	[[nodiscard]] std::byte* mapMemory(const VkDeviceMemory memory) override {
+		std::vector<std::byte>& storage = storage_[memory];
+		storage.resize(sizes_.at(memory));
+		return storage.data();
+	}
+	[[nodiscard]] VkDeviceSize size(const VkDeviceMemory memory) const { return sizes_.at(memory); }
+
+private:
+	VkPhysicalDeviceMemoryProperties properties_{};
+	uptr next_ = 0x1000;
+	std::map<VkDeviceMemory, VkDeviceSize> sizes_;
+	std::map<VkDeviceMemory, std::vector<std::byte>> storage_;
+};
+
+[[nodiscard]] bool disjoint(std::vector<Vk::Tlsf::Allocation> allocations) {
+	std::ranges::sort(allocations, {}, &Vk::Tlsf::Allocation::offset);
+	for (usize n = 1; n < allocations.size(); ++n) {
+		if (allocations[n - 1].offset + allocations[n - 1].size > allocations[n].offset) return false;
+	}
+	return true;
+}
+
+}
+
+void vkMemoryTests() {
+	// TLSF: aligned placement, coalescing back into a single range, exhaustion
+	{
+		Vk::Tlsf tlsf{ 1024 };
+		const Vk::Tlsf::Allocation a = tlsf.allocate(100);
+		const Vk::Tlsf::Allocation b = tlsf.allocate(100, 256);
+		const Vk::Tlsf::Allocation c = tlsf.allocate(200, 64);
+		CHECK(a && b && c && b.offset % 256 == 0 && c.offset % 64 == 0);
+		CHECK(disjoint({ a, b, c }) && tlsf.used() == 400 && tlsf.allocationCount() == 3);
+		CHECK(!tlsf.allocate(1024));
+		tlsf.free(b.node);
+		CHECK(tlsf.fragmentation() > 0);
+		tlsf.free(a.node);
+		tlsf.free(c.node);
+		CHECK(tlsf.empty() && tlsf.freeRangeCount() == 1 && tlsf.largestFree() == 1024 && tlsf.fragmentation() == 0);
+		CHECK(tlsf.allocate(1024).offset == 0 && !tlsf.allocate(1));
+	}
+
+	// TLSF under random churn: live allocations never overlap, and everything coalesces once freed
+	{
+		Vk::Tlsf tlsf{ 4 * MB };
+		std::mt19937 random{ 7 };
+		std::vector<Vk::Tlsf::Allocation> live;
+		u32 failures = 0;
+		bool overlaps = false;
+		for (i32 n = 0; n < 20000; ++n) {
+			if (live.empty() || (tlsf.used() < 3 * MB && random() % 2 == 0)) {
+				const VkDeviceSize size = 1 + random() % (random() % 8 == 0 ? 256 * 1024 : 4096);
+				const Vk::Tlsf::Allocation allocation = tlsf.allocate(size, VkDeviceSize{ 1 } << (random() % 9));
+				if (allocation) live.push_back(allocation);
+				else ++failures;
+			} else {
+				const usize index = random() % live.size();
+				tlsf.free(live[index].node);
+				live[index] = live.back();
+				live.pop_back();
+			}
+			if (n % 1000 == 0) overlaps |= !disjoint(live);
+		}
+		CHECK(!overlaps && disjoint(live) && failures < 1000);
+		VkDeviceSize used = 0;
+		for (const Vk::Tlsf::Allocation& allocation : live) used += allocation.size;
+		CHECK(tlsf.used() == used && tlsf.allocationCount() == live.size());
+		for (const Vk::Tlsf::Allocation& allocation : live) tlsf.free(allocation.node);
+		CHECK(tlsf.empty() && tlsf.freeRangeCount() == 1 && tlsf.largestFree() == 4 * MB);
+	}
+
+	// Memory types follow usage: VRAM for GPU data, the BAR window for uploads, cached system memory for readback
+	{
+		MockBackend backend;
+		const Vk::MemoryAllocator allocator{ backend };
+		CHECK(allocator.memoryType(~0u, Vk::MemoryUsage::DEVICE) == 0);
+		CHECK(allocator.memoryType(~0u, Vk::MemoryUsage::UPLOAD) == 3);
+		CHECK(allocator.memoryType(~0u, Vk::MemoryUsage::READBACK) == 2);
+		CHECK(allocator.memoryType(0b0110, Vk::MemoryUsage::UPLOAD) == 1);
+		CHECK(allocator.memoryType(0b0010, Vk::MemoryUsage::DEVICE) == 1);
+		CHECK(allocator.memoryType(0b0001, Vk::MemoryUsage::READBACK) == Vk::MemoryAllocator::NONE);
+	}
+
+	// Small resources share blocks, large ones get their own allocation, and blocks go back once empty
+	{
+		MockBackend backend;
+		Vk::MemoryAllocator allocator{ backend, { .block_size = 1 * MB } };
+		std::vector<Vk::MemoryAllocator::Allocation> small;
+		for (i32 n = 0; n < 100; ++n) small.push_back(allocator.allocate({ 12 * 1024, 256, ~0u }, Vk::MemoryUsage::DEVICE));
+		CHECK(backend.allocations == 2);
+		const Vk::MemoryAllocator::Info first = allocator.info(small[0]);
+		CHECK(first.memory_type == 0 && !first.dedicated && first.mapped == nullptr && backend.size(first.memory) == 1 * MB);
+
+		const Vk::MemoryAllocator::Allocation large = allocator.allocate({ 3 * MB, 256, ~0u }, Vk::MemoryUsage::DEVICE);
+		const Vk::MemoryAllocator::Info large_info = allocator.info(large);
+		CHECK(large_info.dedicated && large_info.offset == 0 && backend.allocations == 3);
+
+		const Vk::MemoryAllocator::Allocation upload = allocator.allocate({ 1000, 16, ~0u }, Vk::MemoryUsage::UPLOAD);
+		const Vk::MemoryAllocator::Info upload_info = allocator.info(upload);
+		CHECK(upload_info.memory_type == 3 && upload_info.mapped != nullptr);
+		std::memset(upload_info.mapped, 0xab, 1000);
+
+		Vk::MemoryAllocator::Stats stats = allocator.stats();
+		CHECK(stats.allocations == 102 && stats.device_allocations == 4 && stats.heaps[0].blocks == 2 && stats.heaps[0].dedicated == 1);
+		CHECK(stats.heaps[0].used == 100 * 12 * 1024 + 3 * MB && stats.heaps[0].reserved == 5 * MB && stats.heaps[2].budget == 16 * MB * 8 / 10);
+
+		for (const Vk::MemoryAllocator::Allocation allocation : small) allocator.free(allocation);
+		allocator.free(large);
+		allocator.free(upload);
+		// One empty block per memory type is kept
+		stats = allocator.stats();
+		CHECK(backend.allocations == 2 && stats.allocations == 0 && stats.used == 0 && stats.reserved == 2 * MB);
+	}
+
+	// Alignments beyond the block size are met at offset 0 of fresh memory, without leaving an empty block behind
+	{
+		MockBackend backend;
+		Vk::MemoryAllocator allocator{ backend, { .block_size = 1 * MB } };
+		const Vk::MemoryAllocator::Allocation small = allocator.allocate({ 4096, 256, ~0u }, Vk::MemoryUsage::DEVICE);
+		const Vk::MemoryAllocator::Allocation aligned = allocator.allocate({ 4096, 4 * MB, ~0u }, Vk::MemoryUsage::DEVICE);
+		const Vk::MemoryAllocator::Info info = allocator.info(aligned);
+		CHECK(info.offset == 0 && info.memory != allocator.info(small).memory);
+		const Vk::MemoryAllocator::Stats stats = allocator.stats();
+		CHECK(backend.allocations == 2 && stats.allocations == 2 && stats.heaps[0].blocks + stats.heaps[0].dedicated == 2);
+		allocator.free(aligned);
+		allocator.free(small);
+		CHECK(backend.allocations == 1 && allocator.stats().allocations == 0);
+	}
+
+	// Over budget, or out of memory, GPU data spills into the BAR window, then system memory; uploads have nowhere to go
+	{
+		MockBackend backend;
+		Vk::MemoryAllocator allocator{ backend, { .block_size = 1 * MB } };
+		std::vector<Vk::MemoryAllocator::Allocation> allocations;
+		for (i32 n = 0; n < 60; ++n) allocations.push_back(allocator.allocate({ MB / 2, 256, ~0u }, Vk::MemoryUsage::DEVICE));
+		const Vk::MemoryAllocator::Stats stats = allocator.stats();
+		CHECK(stats.heaps[0].reserved <= stats.heaps[0].budget && stats.heaps[2].reserved <= stats.heaps[2].budget && stats.heaps[1].reserved > 0);
+		CHECK(allocator.info(allocations[0]).memory_type == 0 && allocator.info(allocations[30]).memory_type == 3 && allocator.info(allocations.back()).memory_type == 1);
+
+		backend.fail_heap = 0;
+		allocations.push_back(allocator.allocate({ 6 * MB, 256, 0b0001 | 0b0010 }, Vk::MemoryUsage::DEVICE));
+		CHECK(allocator.info(allocations.back()).memory_type == 1);
+
+		bool threw = false;
+		try {
+			allocations.push_back(allocator.allocate({ 32 * MB, 256, 0b1000 }, Vk::MemoryUsage::UPLOAD));
+		} catch (const ::Mirror::Error error) {
+			threw = error == ::Mirror::Error::VULKAN;
+		}
+		CHECK(threw);
+		for (const Vk::MemoryAllocator::Allocation allocation : allocations) allocator.free(allocation);
+	}
+
+	// Defragmentation empties sparse blocks into fuller ones; handles and contents survive the move
+	{
+		MockBackend backend;
+		Vk::MemoryAllocator allocator{ backend, { .block_size = 1 * MB } };
+		std::vector<Vk::MemoryAllocator::Allocation> allocations;
+		for (u32 n = 0; n < 48; ++n) {
+			allocations.push_back(allocator.allocate({ 64 * 1024, 256, 0b0010 }, Vk::MemoryUsage::UPLOAD, true));
+			std::memset(allocator.info(allocations.back()).mapped, (i32)n, 64 * 1024);
+		}
+		const Vk::MemoryAllocator::Allocation pinned = allocator.allocate({ 64 * 1024, 256, 0b0010 }, Vk::MemoryUsage::UPLOAD);
+		CHECK(backend.allocations == 4);
+		// Thin out the first three blocks, leaving the pinned allocation's block alone
+		for (u32 n = 0; n < 48; ++n) {
+			if (n % 4 != 0) {
+				allocator.free(allocations[n]);
+				allocations[n] = {};
+			}
+		}
+		const f64 fragmentation = allocator.stats().fragmentation;
+
+		const std::vector<Vk::MemoryAllocator::Move> moves = allocator.beginDefragmentation();
+		CHECK(!moves.empty());
+		for (const Vk::MemoryAllocator::Move& move : moves) {
+			CHECK(move.from.memory != move.to.memory && move.from.size == move.to.size);
+			std::memcpy(move.to.mapped, move.from.mapped, move.from.size);
+		}
+		allocator.endDefragmentation(moves);
+		const Vk::MemoryAllocator::Stats stats = allocator.stats();
+		CHECK(backend.allocations == 2 && stats.allocations == 13 && stats.fragmentation <= fragmentation);
+
+		bool intact = true;
+		for (u32 n = 0; n < 48; ++n) {
+			if (!allocations[n]) continue;
+			const Vk::MemoryAllocator::Info info = allocator.info(allocations[n]);
+			intact &= info.mapped[0] == (std::byte)n && info.mapped[64 * 1024 - 1] == (std::byte)n;
+			allocator.free(allocations[n]);
+		}
+		CHECK(intact);
+		allocator.free(pinned);
+		CHECK(allocator.beginDefragmentation().empty());
+	}
+
+	// Linear pools: bump allocation inside the current frame's region, regions recycled in turn
+	{
+		MockBackend backend;
+		Vk::MemoryAllocator allocator{ backend };
+		Vk::LinearPool pool{ allocator, Vk::MemoryUsage::UPLOAD, 4096, 3 };
+		const Vk::MemoryAllocator::Info a = pool.allocate(100, 16);
+		const Vk::MemoryAllocator::Info b = pool.allocate(100, 256);
+		CHECK(a.memory && b.memory == a.memory && b.offset % 256 == 0 && b.offset >= a.offset + 100 && b.mapped == a.mapped + (b.offset - a.offset));
+		CHECK(!pool.allocate(4096, 16).memory && pool.failures() == 1);
+
+		pool.nextFrame();
+		const Vk::MemoryAllocator::Info c = pool.allocate(4096, 16);
+		CHECK(c.memory && c.offset == a.offset + 4096 && pool.frame() == 1);
+		pool.nextFrame();
+		pool.nextFrame();
+		CHECK(pool.frame() == 0 && pool.used() == 0 && pool.allocate(100, 16).offset == a.offset && pool.peak() == 4096);
+		CHECK(allocator.stats().allocations == 1);
+	}
+}
+
+}
@@ -0,0 +1,165 @@
+#include "test.h"
+
+#include "mirror.h"
+
+#include <mutex>
+
+namespace Test {
+
+using namespace Mirror::Reflect;
+
+namespace {
+
+// Frames in flight against a real driver: every frame uploads through a small ring that wraps many times and copies
+// into its own readback slot, so data overwritten while the GPU still needed it would show up in the results
+void gpuTests(const Vk::Context& context) {
+	constexpr u32 FRAMES = 96;
+	constexpr VkDeviceSize SLOT = sizeof(u64);
+
+	Vk::UploadRing upload{ context, 4096 };
+	Vk::Buffer readback{ context, FRAMES * SLOT, VK_BUFFER_USAGE_TRANSFER_DST_BIT, Vk::MemoryUsage::READBACK };
+	CHECK(readback.mapped() != nullptr);
+	const Vk::MemoryAllocator::Stats memory = context.memory().stats();
+	CHECK(memory.allocations == 2 && memory.device_allocations <= 2 && memory.used >= 4096 + FRAMES * SLOT);
+	{
+		Vk::FramesInFlight frames{ context, &upload, 3 };
+		CHECK(frames.count() == 3);
+		for (u64 frame = 0; frame < FRAMES; ++frame) {
+			const VkCommandBuffer commands = frames.begin();
+			CHECK(upload.ring().used() <= 3 * 3 * Vk::UploadRing::ALIGNMENT);
+			Vk::UploadRing::Allocation value;
+			for (u64 n = 0; n < 3; ++n) {
+				const u64 data = frame * 3 + n;
+				value = upload.upload(std::span{ &data, 1 });
+			}
+			CHECK((bool)value);
+			const VkBufferCopy copy{ value.offset, frame * SLOT, SLOT };
+			vkCmdCopyBuffer(commands, upload.buffer(), readback.buffer(), 1, &copy);
+			frames.end();
+		}
+		frames.waitIdle();
+		CHECK(frames.frame() == FRAMES && upload.ring().used() == 0 && upload.ring().failures() == 0);
+
+		bool copied = true;
+		for (u64 frame = 0; frame < FRAMES; ++frame) {
+			u64 value;
+			std::memcpy(&value, readback.mapped() + frame * SLOT, sizeof(value));
+			copied &= value == frame * 3 + 2;
+		}
+		CHECK(copied);
+
+		// A frame abandoned before end(), as by an exception, is recorded over by the next begin()
+		const VkCommandBuffer abandoned = frames.begin();
+		CHECK(frames.begin() == abandoned);
+		frames.end();
+		frames.waitIdle();
+		CHECK(frames.frame() == FRAMES + 1);
+
+		const Vk::FramesInFlight::Timings& timings = frames.timings();
+		CHECK(timings.total_submit_ms > 0 && timings.meanSubmitMs() >= 0 && timings.meanWaitMs() >= 0);
+	}
+
+	// Parallel recording: each frame has its own region and each item its own slot in it, so no two fills overlap and
+	// need a barrier. Every item must land exactly once, and the chunks must tile the items. Three frames reuse the
+	// pools of both slots.
+	{
+		constexpr u32 ITEMS = 4096;
+		constexpr u32 FRAMES = 3;
+		Vk::Buffer target{ context, FRAMES * ITEMS * sizeof(u32), VK_BUFFER_USAGE_TRANSFER_DST_BIT, Vk::MemoryUsage::READBACK };
+		Vk::FramesInFlight frames{ context };
+		Vk::ParallelRecorder recorder{ context, 4, frames.count() };
+		bool tiled = true;
+		for (u32 frame = 0; frame < FRAMES; ++frame) {
+			const VkCommandBuffer commands = frames.begin();
+			std::mutex mutex;
+			std::vector<std::pair<usize, usize>> ranges;
+			const u32 chunks = recorder.record(commands, frames.index(), ITEMS, 16, [&](const VkCommandBuffer secondary, const usize begin, const usize end) {
+				for (usize n = begin; n < end; ++n) vkCmdFillBuffer(secondary, target.buffer(), (frame * ITEMS + n) * sizeof(u32), sizeof(u32), frame * ITEMS + (u32)n);
+				const std::scoped_lock lock{ mutex };
+				ranges.emplace_back(begin, end);
+			});
+			frames.end();
+			std::ranges::sort(ranges);
+			tiled &= chunks == 4 && ranges.size() == chunks && ranges.front().first == 0 && ranges.back().second == ITEMS;
+			for (usize n = 1; n < ranges.size(); ++n) tiled &= ranges[n].first == ranges[n - 1].second;
+		}
+		frames.waitIdle();
+		CHECK(tiled);
+		bool written = true;
+		for (u32 n = 0; n < FRAMES * ITEMS; ++n) {
+			u32 value;
+			std::memcpy(&value, target.mapped() + n * sizeof(u32), sizeof(value));
+			written &= value == n;
+		}
+		CHECK(written);
+		CHECK(recorder.record(VK_NULL_HANDLE, 0, 0, 16, [](VkCommandBuffer, usize, usize) {}) == 0);
+	}
+
+	// Offscreen Vulkan through the engine
+	{
+		::Mirror::Mirror engine{ ::Mirror::Mirror::Headless{ .vulkan = true } };
+		// 1000 sprites over 2 layers and 4 textures each frame, uploaded as 8 instanced draws
+		engine.systems().add("sprites", [&engine]() {
+			for (u32 n = 0; n < 1000; ++n) engine.renderer().sprites().submit(DrawKey::make(n % 2, 0, n % 8, (f32)n), SpriteInstance{});
+		}).writes<Renderer>();
+		for (i32 frame = 0; frame < 10; ++frame) engine.update();
+		CHECK(engine.renderer().vulkan() && engine.renderer().gpuTimings()->frames == 10);
+		CHECK(engine.renderer().lastDraws().instances == 1000 && engine.renderer().lastDraws().batches == 8);
+		CHECK(engine.renderer().lastDraws().chunks == 1);
+
+		// The same frames from a render thread
+		engine.renderer().setThreaded(true);
+		for (i32 frame = 0; frame < 10; ++frame) engine.update();
+		engine.renderer().flush();
+		const Renderer::Latency& latency = engine.renderer().latency();
+		CHECK(engine.renderer().gpuTimings()->frames == latency.rendered && latency.rendered + latency.dropped == 20);
+		CHECK(engine.renderer().lastDraws().batches == 8);
+		CHECK(latency.published == 20 && latency.max_ms >= latency.meanMs() && latency.meanMs() > 0);
+	}
+}
+
+}
+
+void vkTests() {
+	// Ring arithmetic: in-order allocation, alignment, skipping the end and bulk release
+	{
+		Vk::RingAllocator ring{ 1024 };
+		CHECK(ring.allocate(100, 16) == 0);
+		CHECK(ring.allocate(100, 256) == 256);
+		const VkDeviceSize frame = ring.head();
+		CHECK(ring.allocate(500, 256) == 512);
+		CHECK(ring.allocate(100, 16) == Vk::RingAllocator::NONE && ring.failures() == 1);
+		ring.release(frame);
+		CHECK(ring.used() == 1012 - 356);
+		// Doesn't fit at the end, so it starts over at 0, past the released range
+		CHECK(ring.allocate(300, 16) == 0 && ring.used() == 1024 + 300 - 356);
+		CHECK(ring.allocate(300, 16) == Vk::RingAllocator::NONE);
+		ring.release(ring.head());
+		CHECK(ring.used() == 0 && ring.allocate(1024, 256) == 0);
+		CHECK(ring.allocate(2048, 256) == Vk::RingAllocator::NONE);
+
+		// A failed allocation leaves an empty ring as it was
+		Vk::RingAllocator empty{ 1024 };
+		CHECK(empty.allocate(100, 16) == 0);
+		empty.release(empty.head());
+		CHECK(empty.allocate(2048, 256) == Vk::RingAllocator::NONE && empty.used() == 0 && empty.head() == 100);
+		CHECK(empty.allocate(1024, 256) == 0 && empty.used() == 1024);
+	}
+
+	// Null backend: no device at all
+	{
+		const Renderer renderer{ Renderer::Headless{} };
+		CHECK(!renderer.vulkan() && renderer.gpuTimings() == nullptr);
+	}
+
+	// CI machines without a GPU need a software driver such as lavapipe for the rest
+	std::optional<Vk::Context> context;
+	try {
+		context.emplace();
+	} catch (const ::Mirror::Error) {
+		return;
+	}
+	gpuTests(*context);
+}
+
+}